@@ -0,0 +1,37 @@
+# Images for the OLED, converted to SSD1306 page format (RLE) at build time by
+# tools/img2pages.py: assets/<name>.pbm becomes <name>.h, and a directory
+# assets/<name>/ of PBM frames becomes a multi-frame <name>.h.
+set(OPENHEART_ASSETS_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+function(openheart_generate_assets out_dir headers_var)
+    find_package(Python3 REQUIRED COMPONENTS Interpreter)
+    set(tool ${OPENHEART_ASSETS_DIR}/../tools/img2pages.py)
+    set(headers)
+
+    file(GLOB entries ${OPENHEART_ASSETS_DIR}/*)
+    foreach(entry ${entries})
+        get_filename_component(name ${entry} NAME_WE)
+        if(IS_DIRECTORY ${entry})
+            file(GLOB frames ${entry}/*.pbm)
+            list(SORT frames)
+        elseif(entry MATCHES "\\.pbm$")
+            set(frames ${entry})
+        else()
+            continue()
+        endif()
+        if(NOT frames)
+            continue()
+        endif()
+
+        set(header ${out_dir}/${name}.h)
+        add_custom_command(
+            OUTPUT ${header}
+            COMMAND Python3::Interpreter ${tool} --name ${name} -o ${header} ${frames}
+            DEPENDS ${frames} ${tool}
+            COMMENT "Converting image ${name}"
+        )
+        list(APPEND headers ${header})
+    endforeach()
+
+    set(${headers_var} ${headers} PARENT_SCOPE)
+endfunction()
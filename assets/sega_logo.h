@@ -1,71 +0,0 @@
-#ifndef SEGA_LOGO_H
-#define SEGA_LOGO_H
-
-// 'SEGA_logo', 128x64px
-const uint8_t sega_logo_bitmap[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7c, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x7f, 0xff, 0xe0, 0x3f, 0xff, 0xf8, 0x1f, 0xff, 0xf8, 0x00, 0xff, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0xff, 0xff, 0xe0, 0x7f, 0xff, 0xf8, 0x3f, 0xff, 0xf8, 0x01, 0xff, 0x80, 0x00, 0x00,
-    0x00, 0x01, 0xff, 0xff, 0xe0, 0xff, 0xff, 0xf8, 0x7f, 0xff, 0xf8, 0x03, 0xe7, 0xc0, 0x00, 0x00,
-    0x00, 0x03, 0xf0, 0x00, 0x01, 0xf8, 0x00, 0x00, 0xfc, 0x00, 0x00, 0x07, 0xc3, 0xc0, 0x00, 0x00,
-    0x00, 0x07, 0xc0, 0x00, 0x03, 0xe0, 0x00, 0x01, 0xf0, 0x00, 0x00, 0x07, 0x9b, 0xc0, 0x00, 0x00,
-    0x00, 0x07, 0x9f, 0xff, 0xe3, 0xcf, 0xff, 0xf9, 0xe7, 0xff, 0xf8, 0x07, 0xb9, 0xe0, 0x00, 0x00,
-    0x00, 0x0f, 0xbf, 0xff, 0xe3, 0xdf, 0xff, 0xf9, 0xef, 0xff, 0xf8, 0x0f, 0x3d, 0xe0, 0x00, 0x00,
-    0x00, 0x0f, 0x3f, 0xff, 0xe3, 0xdf, 0xff, 0xf9, 0xef, 0xff, 0xf8, 0x0f, 0x3d, 0xf0, 0x00, 0x00,
-    0x00, 0x0f, 0x7f, 0xff, 0xe3, 0xdf, 0xff, 0xf1, 0xcf, 0x80, 0x00, 0x0f, 0x7c, 0xf0, 0x00, 0x00,
-    0x00, 0x0f, 0x78, 0x00, 0x03, 0xde, 0x00, 0x01, 0xcf, 0x00, 0x00, 0x1e, 0x7e, 0xf0, 0x00, 0x00,
-    0x00, 0x0f, 0x3f, 0xf0, 0x03, 0xdf, 0xff, 0x81, 0xcf, 0x7f, 0xf8, 0x1e, 0x7e, 0x78, 0x00, 0x00,
-    0x00, 0x0f, 0x3f, 0xfe, 0x03, 0xdf, 0xff, 0x81, 0xcf, 0x7f, 0xf8, 0x1e, 0xfe, 0x78, 0x00, 0x00,
-    0x00, 0x0f, 0x9f, 0xff, 0x03, 0xdf, 0xff, 0x81, 0xcf, 0x7f, 0xf8, 0x3c, 0xff, 0x78, 0x00, 0x00,
-    0x00, 0x07, 0xc7, 0xff, 0x83, 0xdf, 0xff, 0x81, 0xcf, 0x7f, 0xf8, 0x3c, 0xff, 0x3c, 0x00, 0x00,
-    0x00, 0x07, 0xe0, 0x0f, 0xc3, 0xc0, 0x00, 0x01, 0xcf, 0x00, 0x78, 0x3d, 0xff, 0x3c, 0x00, 0x00,
-    0x00, 0x03, 0xff, 0xe3, 0xc3, 0xdf, 0xff, 0x81, 0xcf, 0x7f, 0x78, 0x79, 0xff, 0xbc, 0x00, 0x00,
-    0x00, 0x01, 0xff, 0xfb, 0xe3, 0xdf, 0xff, 0x81, 0xcf, 0x7f, 0x78, 0x79, 0xef, 0x9e, 0x00, 0x00,
-    0x00, 0x00, 0x7f, 0xf9, 0xe3, 0xdf, 0xff, 0x81, 0xcf, 0x7f, 0x78, 0x7b, 0xe7, 0x9e, 0x00, 0x00,
-    0x00, 0x00, 0x1f, 0xfd, 0xe3, 0xdf, 0xff, 0x81, 0xcf, 0x7f, 0x78, 0xf3, 0xc7, 0xde, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x3d, 0xe3, 0xde, 0x00, 0x01, 0xcf, 0x0f, 0x78, 0xf3, 0xc7, 0xcf, 0x00, 0x00,
-    0x00, 0x0f, 0xff, 0xfd, 0xe3, 0xdf, 0xff, 0xf1, 0xcf, 0xff, 0x78, 0xf7, 0xff, 0xcf, 0x00, 0x00,
-    0x00, 0x0f, 0xff, 0xfd, 0xe3, 0xdf, 0xff, 0xf1, 0xef, 0xff, 0x79, 0xe7, 0xbf, 0xef, 0x00, 0x00,
-    0x00, 0x0f, 0xff, 0xf9, 0xf3, 0xdf, 0xff, 0xf1, 0xef, 0xff, 0x79, 0xe7, 0xbf, 0xe7, 0x80, 0x00,
-    0x00, 0x0f, 0xff, 0xf3, 0xe7, 0xcf, 0xff, 0xf1, 0xe7, 0xff, 0x79, 0xef, 0xbf, 0xe7, 0x80, 0x00,
-    0x00, 0x00, 0x00, 0x07, 0xe3, 0xe0, 0x00, 0x01, 0xf0, 0x00, 0x7b, 0xcf, 0x00, 0x07, 0x80, 0x00,
-    0x00, 0x00, 0x00, 0x1f, 0xc3, 0xf8, 0x00, 0x01, 0xfc, 0x00, 0x7b, 0xdf, 0x00, 0x07, 0xc0, 0x00,
-    0x00, 0x1f, 0xff, 0xff, 0xc1, 0xff, 0xff, 0xf9, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe0, 0x00,
-    0x00, 0x1f, 0xff, 0xff, 0x81, 0xff, 0xff, 0xf8, 0xff, 0xff, 0xff, 0xff, 0x7f, 0xff, 0xe0, 0x00,
-    0x00, 0x1f, 0xff, 0xfe, 0x00, 0x7f, 0xff, 0xf8, 0x7f, 0xff, 0xff, 0xff, 0x7f, 0xff, 0xf0, 0x00,
-    0x00, 0x1f, 0xff, 0xf8, 0x00, 0x3f, 0xff, 0xf8, 0x1f, 0xff, 0xff, 0xff, 0x7f, 0xff, 0xf0, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-
-#endif
@@ -1,6 +1,7 @@
 #ifndef CLOCK_CONTROL_H
 #define CLOCK_CONTROL_H
 
+#include <stdint.h>
 #include "enums.h"
 
 /**
@@ -10,18 +11,65 @@
  */
 void init_clock_output(region_t initial_region);
 
+/**
+ * @brief Select how MCLK is produced. Takes effect on the next init_clock_output().
+ * @param mode The clocking mode.
+ */
+void set_clock_mode(clock_mode_t mode);
+
 /**
  * @brief Change the clock region at runtime.
- *        Updates PLL and output clock for the specified region.
+ *        Re-locks PLL_SYS, or in CLOCK_MODE_PRELOCKED only switches the MCLK output
+ *        between the two already locked PLLs, or in CLOCK_MODE_DECOUPLED re-locks
+ *        PLL_USB while clk_sys keeps running at a fixed frequency.
  * @param region The region to configure.
  */
 void set_clock_region(region_t region);
 
 /**
  * @brief Configure VCLK PWM divider (for CPU clock output).
- *        Sets the divider for the VCLK PWM output.
- * @param div Divider value for the PWM clock.
+ *        Sets the divider for the VCLK PWM output so that VCLK = MCLK * 16 / div16.
+ *        With a fractional divider the high and low phases differ by at most one clk_sys cycle.
+ * @param div16 Divider relative to MCLK, in 1/16ths.
+ */
+void setup_vclk_pwm_div(uint32_t div16);
+
+/**
+ * @brief Stage a new divider for the running VCLK PWM; it takes effect on the next VCLK edge.
+ *        RAM-resident, inline SDK calls only, for use from the console executor;
+ *        setup_vclk_pwm_div() must have run since the last clock plan change.
+ *        A DMA channel paced by the slice's wrap DREQ writes the DIV register a few
+ *        clk_sys cycles after the counter wraps (the rising edge), inside the first
+ *        counter step of the new period. The CPU never writes DIV mid-phase, so
+ *        there is no runt or stretched phase beyond the one that starts the new rate.
+ * @param div16 Divider relative to MCLK, in 1/16ths.
+ */
+void stage_vclk_div(uint32_t div16);
+
+/**
+ * @brief Whether the divider passed to stage_vclk_div() is in place. RAM-resident.
+ * @return true once the swap has happened.
+ */
+bool vclk_div_swapped(void);
+
+/**
+ * @brief Put the divider passed to stage_vclk_div() in place now, if the staged
+ *        write has not landed: cancels the DMA transfer and writes DIV directly.
+ *        RAM-resident; only call with the 68000 halted, as the write may land mid-phase.
+ */
+void force_vclk_div(void);
+
+/**
+ * @brief VCLK as currently generated, fraction included.
+ * @return Frequency in Hz, 0 before VCLK is set up.
+ */
+uint32_t clock_get_vclk_hz(void);
+
+/**
+ * @brief Whether clk_usb runs at the 48 MHz USB needs. Not in CLOCK_MODE_PRELOCKED,
+ *        where PLL_USB holds the PAL plan and clk_usb is stopped.
+ * @return true if USB stdio can be brought up.
  */
-void setup_vclk_pwm_div(uint32_t div);
+bool clock_usb_running(void);
 
 #endif // CLOCK_CONTROL_H
@@ -1,5 +1,59 @@
 #ifndef CONFIG_STORE_H
 #define CONFIG_STORE_H
-void load_config();
-void save_config();
-#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "structs.h"
+
+#define CONFIG_MAGIC          0x4E43484Fu ///< "OHCN", identifies a config record
+#define CONFIG_STORE_SECTORS  4           ///< Flash sectors the record log rotates through
+
+/**
+ * @brief Load the most recent valid configuration from flash.
+ *        Picks the newest record by its magic and sequence number and checks
+ *        only its CRC; if that one was torn by a power loss, the log is scanned
+ *        again for the newest valid record. Remembers where the next save goes.
+ * @param cfg Filled with the newest valid record; untouched if none is found.
+ * @return true if a valid record was found.
+ */
+bool load_config(config_t *cfg);
+
+/**
+ * @brief The persistent part of a system status.
+ * @param status Status to take the settings from.
+ * @return Configuration to save.
+ */
+static inline config_t config_from_status(const system_status_t *status)
+{
+    return (config_t){CONFIG_MAGIC, status->region, status->overclocked, status->oc_step};
+}
+
+/**
+ * @brief Append a configuration record to the flash log.
+ *        Programs a single page; a sector is only erased when the log enters it,
+ *        once every few hundred saves. Saving an unchanged config is a no-op.
+ * @param cfg Configuration to persist.
+ */
+void save_config(const config_t *cfg);
+
+/**
+ * @brief Queue a configuration to be saved CONFIG_WRITE_BEHIND_US from now.
+ *        A newer one queued before then replaces it and restarts the wait, so a
+ *        run of setting changes costs one save, away from the console line
+ *        changes that made it (a flash write masks core 0's interrupts).
+ * @param cfg Configuration to persist.
+ */
+void save_config_later(const config_t *cfg);
+
+/**
+ * @brief Time the queued configuration is due.
+ * @return Absolute time in microseconds, or UINT64_MAX when nothing is queued.
+ */
+uint64_t config_write_due_us(void);
+
+/**
+ * @brief Save the queued configuration, if any. Call once it is due.
+ */
+void config_write_behind(void);
+
+#endif // CONFIG_STORE_H
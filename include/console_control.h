@@ -0,0 +1,106 @@
+#ifndef CONSOLE_CONTROL_H
+#define CONSOLE_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief One action on the 68000 control lines.
+ */
+typedef enum
+{
+    CONSOLE_HALT_ASSERT,   ///< Drive !HALT low
+    CONSOLE_HALT_RELEASE,  ///< Release !HALT
+    CONSOLE_VRES_ASSERT,   ///< Drive !VRES low
+    CONSOLE_VRES_RELEASE,  ///< Release !VRES
+    CONSOLE_CALL,          ///< Call fn(arg) from the alarm IRQ
+    CONSOLE_END            ///< End of sequence
+} console_op_t;
+
+/**
+ * @brief A sequence step: an action, then a wait before the next step.
+ */
+typedef struct
+{
+    console_op_t op;        ///< Action to perform
+    uint32_t wait_us;       ///< Delay before the next step (0 = run it straight away)
+    void (*fn)(void *arg);  ///< CONSOLE_CALL only; receives the sequence argument
+} console_step_t;
+
+/**
+ * @brief A press or release of the console's reset button, seen on !VRES.
+ */
+typedef struct
+{
+    uint64_t time_us;       ///< time_us_64() in the edge IRQ
+    bool pressed;           ///< true on press, false on release
+} console_button_event_t;
+
+/**
+ * @brief Set up !HALT as an open collector output (released).
+ *        !VRES belongs to the TMSS skip, when enabled, until tmss_skip_poll() reports an outcome;
+ *        otherwise it is held low here until console_boot_release().
+ */
+void console_control_init(void);
+
+/**
+ * @brief Let the 68000 run for the first time: arm the TMSS skip, or release !VRES.
+ *        Call once MCLK/VCLK run at the stored region's rates.
+ */
+void console_boot_release(void);
+
+/**
+ * @brief When console_boot_release() let the console go.
+ * @return Microseconds from power-on, 0 before the release.
+ */
+uint64_t console_boot_release_us(void);
+
+/**
+ * @brief Queue a step sequence. Returns immediately; steps run from a timer alarm.
+ *        Core 0 only: the alarm fires there and the queue is guarded by masking IRQs.
+ * @param steps Sequence terminated by CONSOLE_END (must stay valid until it ran).
+ * @param arg   Argument passed to CONSOLE_CALL steps.
+ * @return false if the queue is full.
+ */
+bool console_run(const console_step_t *steps, void *arg);
+
+/**
+ * @brief Check whether a sequence is running or queued.
+ * @return true while the executor has work.
+ */
+bool console_busy(void);
+
+/**
+ * @brief Check whether the firmware is currently holding !VRES low.
+ *        Lets reset-button counting ignore our own reset pulses.
+ * @return true while a sequence asserts !VRES.
+ */
+bool console_vres_asserted(void);
+
+/**
+ * @brief Reset the 68000: !VRES low for CONSOLE_RESET_PULSE_US.
+ * @return false if the queue is full.
+ */
+bool console_reset(void);
+
+/**
+ * @brief Change the VCLK divider with the 68000 halted around the switch.
+ * @param div16 New VCLK divider relative to MCLK, in 1/16ths.
+ * @return false if the queue is full.
+ */
+bool console_set_vclk_div(uint32_t div16);
+
+/**
+ * @brief Start timestamping reset button edges on !VRES (core 0).
+ *        Call once the TMSS skip has handed !VRES back.
+ */
+void console_watch_reset_button(void);
+
+/**
+ * @brief Pop the oldest reset button edge.
+ * @param ev Receives the edge.
+ * @return true if an edge was available.
+ */
+bool console_reset_button_pop(console_button_event_t *ev);
+
+#endif // CONSOLE_CONTROL_H
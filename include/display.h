@@ -2,26 +2,113 @@
 #define DISPLAY_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "enums.h"
 #include "structs.h"
 
+/**
+ * @brief Image in SSD1306 page format, RLE compressed (generated by tools/img2pages.py).
+ */
+typedef struct
+{
+    uint8_t width;           ///< Columns
+    uint8_t pages;           ///< 8-row pages
+    uint8_t frames;          ///< Animation frames, 1 for a still image
+    const uint16_t *offsets; ///< Start of each frame in data, frames + 1 entries
+    const uint8_t *data;     ///< Compressed page bytes, frame after frame
+} display_image_t;
+
 /**
  * @brief Initialize the OLED display and I2C interface.
  */
 void display_init(void);
 
 /**
- * @brief Show the SEGA logo bitmap on the display.
+ * @brief Send the dirty parts of the back buffer, one address window per dirty page.
+ *        Never waits for the bus: if the previous transfer is still in flight the
+ *        dirty ranges are kept and go out with the next flush.
+ * @return true if a transfer was queued or nothing was dirty.
+ */
+bool display_flush(void);
+
+/**
+ * @brief Mark the whole back buffer dirty and send it.
+ * @return true if the frame was queued.
+ */
+bool display_present(void);
+
+/**
+ * @brief Total bytes (including I2C control and address bytes) queued for the panel.
+ * @return Byte count since init.
+ */
+uint32_t display_get_bus_bytes(void);
+
+/**
+ * @brief Check whether a frame is still being sent.
+ * @return true while the DMA or the I2C controller is busy with the previous frame.
+ */
+bool display_busy(void);
+
+/**
+ * @brief Frames per second the panel link can carry: the inverse of the bus time of
+ *        the last full frame. Partial updates are not counted, so the figure does not
+ *        depend on how often the status screen changes, or on its own line.
+ * @return Frames per second, 0 before a full frame was sent.
+ */
+uint32_t display_get_fps(void);
+
+/**
+ * @brief Draw one frame of a page-format image into the back buffer and mark it dirty.
+ *        Whole pages are replaced, so the image is placed on a page boundary.
+ * @param image Image to draw.
+ * @param frame Frame index.
+ * @param x     First column.
+ * @param page  First page.
+ */
+void display_draw_image(const display_image_t *image, uint8_t frame, uint8_t x, uint8_t page);
+
+/**
+ * @brief Draw text in the 5x8 font and mark it dirty. Glyph cells are
+ *        replaced, including their spacing column; the rest of the band is kept.
+ * @param x    First column.
+ * @param y    Top row, any alignment.
+ * @param text Text to draw; cut at the right edge of the panel.
+ * @return Columns drawn.
+ */
+uint32_t display_draw_text(uint8_t x, uint8_t y, const char *text);
+
+/**
+ * @brief Draw an uncompressed page-format bitmap at any row and mark it dirty.
+ *        Bands that fall off the bottom of the panel are dropped.
+ * @param data  Column bytes, one band of width bytes after the other.
+ * @param width Columns.
+ * @param pages 8-row bands.
+ * @param x     First column.
+ * @param y     Top row, any alignment.
+ */
+void display_draw_bitmap(const uint8_t *data, uint8_t width, uint8_t pages, uint8_t x, uint8_t y);
+
+/**
+ * @brief Show the SEGA logo bitmap on the display. Returns once the frame is
+ *        queued; it stays up until the next display_update_status().
  */
 void display_show_sega_logo(void);
 
+/**
+ * @brief Set the console release time shown on the status screen.
+ * @param release_us Microseconds from power-on to the console's release, 0 to leave the line out.
+ */
+void display_set_boot_time(uint64_t release_us);
+
 /**
  * @brief Update the display with region, overclock status, and pad inputs.
+ *        Only lines whose value changed since the last call are re-rendered,
+ *        and only their columns are sent to the panel.
  * @param region      The current video region.
- * @param overclocked Overclock status (true if enabled).
+ * @param oc_vclk_khz 68000 clock while overclocked, 0 at stock speed.
  * @param pad         Current joypad state.
  */
-void display_update_status(region_t region, bool overclocked, joypad_state_t pad);
+void display_update_status(region_t region, uint32_t oc_vclk_khz, joypad_state_t pad);
 
 /**
  * @brief Draw the region and subcarrier information at the top of the display.
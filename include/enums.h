@@ -15,5 +15,15 @@ typedef enum
     REGION_INVALID = 0x80 ///< Invalid/unknown region
 } region_t;
 
+/**
+ * @brief How the master clock (MCLK) is generated.
+ */
+typedef enum
+{
+    CLOCK_MODE_RELOCK,    ///< Re-lock PLL_SYS on every region change (clk_sys follows MCLK)
+    CLOCK_MODE_PRELOCKED, ///< NTSC on PLL_SYS and PAL on PLL_USB, both locked; switch the GPOUT source
+    CLOCK_MODE_DECOUPLED  ///< clk_sys fixed at 144 MHz on PLL_SYS; MCLK re-locked on PLL_USB only
+} clock_mode_t;
+
 #endif // ENUMS_H
        // End of enums.h
\ No newline at end of file
@@ -0,0 +1,15 @@
+#ifndef FLASH_WINDOW_H
+#define FLASH_WINDOW_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Core 1 side of flash writes: when core 0 is about to write flash,
+ *        acknowledge and keep calling rt_work (which must be RAM-resident)
+ *        until flash is usable again. Returns straight away otherwise.
+ *        Core 1 must have called flash_safe_execute_core_init() first.
+ * @param rt_work Real-time work to keep doing, called every FLASH_WINDOW_POLL_US.
+ */
+void flash_window_service(void (*rt_work)(void));
+
+#endif // FLASH_WINDOW_H
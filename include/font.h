@@ -0,0 +1,18 @@
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdint.h>
+
+#define FONT_FIRST_CHAR ' '
+#define FONT_LAST_CHAR  '~'
+#define FONT_HEIGHT     8   ///< One SSD1306 page
+#define FONT_ADVANCE    6   ///< 5 pixel glyph + 1 pixel spacing
+
+/**
+ * @brief 5x8 ASCII font in SSD1306 page format: one byte per column, LSB at
+ *        the top, with the spacing column included, so a glyph is copied
+ *        into a page as is.
+ */
+extern const uint8_t font_5x8[FONT_LAST_CHAR - FONT_FIRST_CHAR + 1][FONT_ADVANCE];
+
+#endif // FONT_H
@@ -0,0 +1,41 @@
+#ifndef FRAME_SYNC_H
+#define FRAME_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Start counting frames on GPIO_VSYNC_PIN. Call on core 0: the
+ *        vertical blank interrupt, and the changes it applies, run there.
+ */
+void frame_sync_init(void);
+
+/**
+ * @brief Run a clock, divider or region jumper change at the start of the
+ *        next vertical blank, from the frame interrupt. Runs it straight away
+ *        when there is no sync signal, and after FRAME_SYNC_LOST_US if the
+ *        signal goes away in the meantime. A change already waiting is not
+ *        queued twice: it reads the current settings when it runs.
+ * @param fn Change to apply.
+ */
+void frame_sync_defer(void (*fn)(void));
+
+/**
+ * @brief Check whether frames are being counted.
+ * @return true if a vertical sync pulse arrived within FRAME_SYNC_LOST_US.
+ */
+bool frame_sync_locked(void);
+
+/**
+ * @brief Frames counted since frame_sync_init().
+ * @return Frame count.
+ */
+uint32_t frame_sync_frames(void);
+
+/**
+ * @brief Console frames per second, measured over ~1 s windows.
+ * @return Frames per second, 0 without a sync signal.
+ */
+uint32_t frame_sync_fps(void);
+
+#endif // FRAME_SYNC_H
@@ -0,0 +1,61 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "structs.h"
+
+#define GESTURE_MAX        8          ///< Gestures a table may hold
+#define GESTURE_PAD_BITS   0x0FFFu    ///< PAD_BTN_* bits of the input mask
+#define GESTURE_BTN_RESET  (1u << 15) ///< Console reset button, packed above the pad buttons
+
+/**
+ * @brief What has to happen for a gesture to fire.
+ */
+typedef enum
+{
+    GESTURE_HOLD,   ///< Chord held for time_us without a change
+    GESTURE_TAPS    ///< Chord pressed `taps` times, all within time_us of the first press
+} gesture_kind_t;
+
+/**
+ * @brief One gesture table entry.
+ *        Chords match exactly within their group: the pad buttons, or the reset button.
+ */
+typedef struct
+{
+    gesture_kind_t kind;     ///< Hold or multi-tap
+    uint16_t chord;          ///< Buttons that make up the gesture (PAD_BTN_* or GESTURE_BTN_RESET)
+    uint8_t taps;            ///< GESTURE_TAPS only: presses needed
+    uint32_t time_us;        ///< Hold time, or tap window
+    void (*action)(void);    ///< Called from gesture_input()/gesture_update() when the gesture fires
+} gesture_t;
+
+/**
+ * @brief Install a gesture table and clear all gesture state.
+ * @param table Gestures (must stay valid while in use).
+ * @param count Number of entries, at most GESTURE_MAX.
+ */
+void gesture_init(const gesture_t *table, uint8_t count);
+
+/**
+ * @brief Feed a timestamped input change. Changes of each group must arrive in time order.
+ * @param bits    Input bits this change covers (GESTURE_PAD_BITS or GESTURE_BTN_RESET).
+ * @param values  New state of those bits, pressed = 1.
+ * @param time_us When the change was observed.
+ */
+void gesture_input(uint16_t bits, uint16_t values, uint64_t time_us);
+
+/**
+ * @brief Fire every hold whose deadline has passed.
+ * @param now_us Current time_us_64().
+ */
+void gesture_update(uint64_t now_us);
+
+/**
+ * @brief Time gesture_update() next has something to do.
+ * @return Absolute time in microseconds, or UINT64_MAX when no hold is pending.
+ */
+uint64_t gesture_next_deadline_us(void);
+
+#endif // GESTURE_H
@@ -1,6 +1,9 @@
 #ifndef IN_GAME_RESET_H
 #define IN_GAME_RESET_H
 
-void handle_ingame_reset();
+/**
+ * @brief Reset the console from the pad (A+B+C+Start hotkey).
+ */
+void handle_ingame_reset(void);
 
 #endif // IN_GAME_RESET_H
@@ -0,0 +1,42 @@
+#ifndef LOGIC_ANALYZER_H
+#define LOGIC_ANALYZER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "setup.h"
+
+/**
+ * @brief What stopped a capture. Keep in step with tools/la_decode.py.
+ */
+typedef enum
+{
+    LA_TRIGGER_PAD = 1,   ///< Trigger chord held on the pad
+    LA_TRIGGER_RESET      ///< !VRES fell (reset button or our own pulse)
+} la_trigger_t;
+
+/**
+ * @brief Start sampling the pad and console lines into the capture rings.
+ *        Claims a PIO state machine and LA_RING_CHUNKS DMA channels. Core 0.
+ */
+void la_init(void);
+
+/**
+ * @brief Stop the running capture LA_RING_CHUNKS - 1 rings from now.
+ *        Ignored unless armed. RAM-resident and safe from IRQs on core 0.
+ * @param source Reason for the trigger, reported with the capture.
+ */
+void la_trigger(la_trigger_t source);
+
+/**
+ * @brief Gesture action: trigger a capture from the pad.
+ */
+void handle_la_trigger(void);
+
+/**
+ * @brief Send a finished capture to the host over USB CDC, a bounded batch
+ *        per call, then re-arm. Core 0 only. A capture waits for a host.
+ * @return true while a capture is being sent: call again within TRACE_DRAIN_INTERVAL_US.
+ */
+bool la_drain(void);
+
+#endif // LOGIC_ANALYZER_H
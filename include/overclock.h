@@ -0,0 +1,27 @@
+#ifndef OVERCLOCK_H
+#define OVERCLOCK_H
+
+#include <stdint.h>
+
+/**
+ * @brief VCLK divider for the current overclock setting.
+ * @return Divider relative to MCLK in 1/16ths: the stock divider, or the selected ladder step.
+ */
+uint32_t overclock_vclk_div16(void);
+
+/**
+ * @brief Toggle the 68000 overclock (A+Start hotkey) and save the setting.
+ */
+void handle_overclock_toggle(void);
+
+/**
+ * @brief Overclock one ladder step faster (A+Start+Up hotkey) and save the setting.
+ */
+void handle_overclock_faster(void);
+
+/**
+ * @brief Overclock one ladder step slower (A+Start+Down hotkey) and save the setting.
+ */
+void handle_overclock_slower(void);
+
+#endif // OVERCLOCK_H
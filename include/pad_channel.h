@@ -0,0 +1,53 @@
+#ifndef PAD_CHANNEL_H
+#define PAD_CHANNEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "structs.h"
+
+#define PAD_CHANNEL_RING_SIZE 64 ///< Snapshots buffered between producer and consumer (power of 2)
+
+/**
+ * @brief Pack a joypad_state_t into a button mask.
+ * @param pad Joypad state to pack.
+ * @return Packed mask (PAD_BTN_* bits).
+ */
+pad_mask_t pad_mask_from_state(const joypad_state_t *pad);
+
+/**
+ * @brief Unpack a button mask into a joypad_state_t.
+ * @param mask Packed mask (PAD_BTN_* bits).
+ * @return Joypad state.
+ */
+joypad_state_t pad_state_from_mask(pad_mask_t mask);
+
+/**
+ * @brief Publish a pad state (producer side, one core only).
+ *        Unchanged states are ignored; every change is pushed to the snapshot ring
+ *        and becomes the latest state in a single atomic word store.
+ * @param mask    Packed button state.
+ * @param time_us Time the state was observed.
+ */
+void pad_channel_publish(pad_mask_t mask, uint64_t time_us);
+
+/**
+ * @brief Read the latest published state. Lock-free and never torn, from any core.
+ * @param seq Optional, receives the publish sequence number of the state.
+ * @return Packed button state.
+ */
+pad_mask_t pad_channel_latest(uint16_t *seq);
+
+/**
+ * @brief Pop the oldest unread snapshot (consumer side, one core only).
+ * @param snap Receives the snapshot.
+ * @return true if a snapshot was available.
+ */
+bool pad_channel_pop(pad_snapshot_t *snap);
+
+/**
+ * @brief Snapshots dropped because the consumer fell behind.
+ * @return Dropped snapshot count.
+ */
+uint32_t pad_channel_dropped(void);
+
+#endif // PAD_CHANNEL_H
@@ -0,0 +1,52 @@
+#ifndef PAD_DECODER_H
+#define PAD_DECODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "structs.h"
+
+/**
+ * @brief Sample layout fed to the decoder: the pad lines and SELECT as the
+ *        sniffer latches them. Data bits are raw, i.e. active low.
+ */
+#define PAD_SAMPLE_DATA_MASK  0x3F      ///< bit0=Up, bit1=Down, bit2=Left, bit3=Right, bit4=B/A, bit5=C/Start
+#define PAD_SAMPLE_SELECT_BIT (1 << 6)  ///< Level of SELECT when the sample was taken
+
+/**
+ * @brief 3/6-button protocol decoder state. Plain data: one per pad, no allocation.
+ */
+typedef struct
+{
+    pad_mask_t mask;       ///< Buttons decoded so far (PAD_BTN_* bits)
+    uint8_t state;         ///< Position in the read cycle
+    bool resync;           ///< Start a new read cycle on the next sample
+    uint32_t last_time;    ///< Time of the previous sample
+    uint32_t cycle_gap;    ///< Quiet time that ends a read cycle, in sample time units
+} pad_decoder_t;
+
+/**
+ * @brief Reset a decoder: no buttons, waiting for a read cycle.
+ * @param dec       Decoder to reset.
+ * @param cycle_gap Time without samples after which the next sample starts a
+ *                  new read cycle, in the unit of the timestamps passed to
+ *                  pad_decoder_feed().
+ */
+void pad_decoder_init(pad_decoder_t *dec, uint32_t cycle_gap);
+
+/**
+ * @brief Decode one sample. O(1): two table lookups, no branches on the data.
+ *        3-button and 6-button reads, and cycles cut short, are all handled.
+ * @param dec    Decoder state.
+ * @param sample Pad lines and SELECT (PAD_SAMPLE_* bits, higher bits ignored).
+ * @param time   Sample time, any unit that wraps at 2^32.
+ * @return Button mask after the sample.
+ */
+pad_mask_t pad_decoder_feed(pad_decoder_t *dec, uint32_t sample, uint32_t time);
+
+/**
+ * @brief Treat the next sample as the start of a read cycle, e.g. after samples were lost.
+ * @param dec Decoder state.
+ */
+void pad_decoder_resync(pad_decoder_t *dec);
+
+#endif // PAD_DECODER_H
@@ -0,0 +1,39 @@
+#ifndef PAD_SNIFFER_H
+#define PAD_SNIFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "structs.h"
+#include "pad_decoder.h"
+
+/**
+ * @brief Sample layout pushed by the PIO sniffer (one 32-bit word per SELECT edge):
+ *        PAD_SAMPLE_DATA_MASK and PAD_SAMPLE_SELECT_BIT as the decoder takes
+ *        them, and above them the PIO's idle tick counter when the edge was seen.
+ */
+#define PAD_SAMPLE_TICK_SHIFT 7         ///< Tick counter position (counts down, 1 tick = PAD_SNIFFER_SETTLE_NS / 16)
+#define PAD_SAMPLE_TICK_MASK  0x1FFFFFFu ///< Tick counter width: 25 bits
+
+/**
+ * @brief Start the passive controller sniffer.
+ *        Claims a PIO state machine and a DMA channel that stream one sample per
+ *        SELECT edge into a RAM ring. The SELECT line is left as an input and is
+ *        never driven. Must be called on the core that will poll the sniffer.
+ */
+void pad_sniffer_init(void);
+
+/**
+ * @brief Decode every sample captured since the last call.
+ *        Never blocks; 3-button and 6-button reads are both handled.
+ * @param pad Pointer to joypad_state_t struct to update with button states.
+ * @return true if at least one new sample was decoded.
+ */
+bool pad_sniffer_poll(joypad_state_t *pad);
+
+/**
+ * @brief Number of samples lost because the ring was not drained in time.
+ * @return Overrun sample count since init.
+ */
+uint32_t pad_sniffer_overruns(void);
+
+#endif // PAD_SNIFFER_H
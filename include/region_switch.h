@@ -1,4 +1,18 @@
 #ifndef REGION_SWITCH_H
 #define REGION_SWITCH_H
-void handle_region_switch();
-#endif
+
+#include "enums.h"
+
+/**
+ * @brief Set up the region jumper outputs for the given region.
+ *        Call at boot while the 68000 is still held in reset.
+ * @param region Region to apply.
+ */
+void region_switch_init(region_t region);
+
+/**
+ * @brief Switch to the next region (JPN > USA > EUR > BRA > JPN), save it and reset the console.
+ */
+void handle_region_switch(void);
+
+#endif // REGION_SWITCH_H
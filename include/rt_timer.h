@@ -0,0 +1,43 @@
+#ifndef RT_TIMER_H
+#define RT_TIMER_H
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+
+/*
+ * Timer access for RAM-resident code that keeps running while flash is
+ * being written (XIP off): plain register reads, no calls into the SDK.
+ */
+
+/**
+ * @brief 64-bit microsecond time, like time_us_64().
+ * @return Microseconds since boot.
+ */
+static inline uint64_t rt_time_us_64(void)
+{
+    // The raw registers do not latch: re-read the high word until it is stable
+    uint32_t hi = timer_hw->timerawh;
+    uint32_t lo;
+    while (true) {
+        lo = timer_hw->timerawl;
+        uint32_t next_hi = timer_hw->timerawh;
+        if (hi == next_hi)
+            break;
+        hi = next_hi;
+    }
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/**
+ * @brief Busy wait, like busy_wait_us_32().
+ * @param us Microseconds to wait.
+ */
+static inline void rt_busy_wait_us(uint32_t us)
+{
+    uint32_t start = timer_hw->timerawl;
+    while (timer_hw->timerawl - start < us)
+        tight_loop_contents();
+}
+
+#endif // RT_TIMER_H
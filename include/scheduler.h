@@ -0,0 +1,88 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHED_MAX_TASKS 8           ///< Tasks a core's table may hold
+#define SCHED_IDLE      UINT64_MAX  ///< Release time of a task that is not armed
+
+/**
+ * @brief One scheduler table entry.
+ */
+typedef struct
+{
+    const char *name;        ///< For the statistics
+    void (*run)(void);       ///< Called from sched_dispatch() once the task is released
+    uint32_t period_us;      ///< Periodic: time between releases; 0 for a one-shot task
+    uint32_t deadline_us;    ///< A run must end this long after its release (0: one period, none for one-shots)
+    uint8_t priority;        ///< Among released tasks, the highest runs first
+    bool start_idle;         ///< Not released by sched_init(): wait for sched_release()
+} sched_task_t;
+
+/**
+ * @brief Per-task statistics since sched_init().
+ */
+typedef struct
+{
+    uint64_t release_us;     ///< Next release, absolute; SCHED_IDLE when not armed
+    uint32_t runs;           ///< Completed runs
+    uint32_t misses;         ///< Runs that ended after their deadline, plus periodic releases skipped
+    uint32_t max_late_us;    ///< Worst start time behind the release (jitter)
+    uint64_t total_late_us;  ///< Sum of start delays, for the average
+    uint32_t max_run_us;     ///< Longest run
+} sched_stats_t;
+
+/**
+ * @brief Install the calling core's task table.
+ *        Tasks are released straight away, except those marked start_idle.
+ * @param table Tasks (must stay valid while in use).
+ * @param count Number of entries, at most SCHED_MAX_TASKS.
+ */
+void sched_init(const sched_task_t *table, uint8_t count);
+
+/**
+ * @brief Set the next release of one of the calling core's tasks.
+ *        Called from a periodic task's own run(), replaces the next periodic release.
+ * @param task    Index in the table.
+ * @param time_us Absolute release time, or SCHED_IDLE to disarm the task.
+ */
+void sched_release(uint8_t task, uint64_t time_us);
+
+/**
+ * @brief Release a task no later than a given time; an earlier release stands.
+ * @param task    Index in the table.
+ * @param time_us Absolute release time.
+ */
+void sched_release_by(uint8_t task, uint64_t time_us);
+
+/**
+ * @brief Run the released task with the highest priority, or sleep in WFE
+ *        until the next release. Never returns early for good: call in a loop.
+ */
+void sched_dispatch(void);
+
+/**
+ * @brief Number of tasks installed on a core.
+ * @param core Core number.
+ * @return Table size, 0 before sched_init() ran on that core.
+ */
+uint8_t sched_task_count(unsigned core);
+
+/**
+ * @brief A core's table entry.
+ * @param core Core number.
+ * @param task Index in the table.
+ * @return Pointer to the entry.
+ */
+const sched_task_t *sched_task(unsigned core, uint8_t task);
+
+/**
+ * @brief Statistics of a task.
+ * @param core Core number.
+ * @param task Index in the table.
+ * @return Pointer to the statistics.
+ */
+const sched_stats_t *sched_stats(unsigned core, uint8_t task);
+
+#endif // SCHEDULER_H
@@ -4,6 +4,24 @@
 // Feature toggles
 #define ENABLE_OLED_DISPLAY 1    ///< Enable support for OLED display (1 = enable, 0 = disable)
 #define ENABLE_OVERCLOCKING 1    ///< Enable support for system overclocking (1 = enable, 0 = disable)
+#define ENABLE_PAD_SNIFFER  1    ///< Sniff the pad on console SELECT edges (1) or poll it by driving SELECT (0)
+#define ENABLE_TMSS_SKIP    1    ///< Reset the 68000 while TMSS has the cart mapped (1 = enable, 0 = disable)
+#define ENABLE_TRACE        1    ///< Record hot-path trace events and stream them over USB CDC (1 = enable, 0 = disable; not with CLOCK_MODE_PRELOCKED)
+#define ENABLE_STATUS_LED   1    ///< Show region and overclock on a bi-color LED (1 = enable, 0 = disable)
+#define ENABLE_LOGIC_ANALYZER 0  ///< Capture the pad and console lines for USB export (1 = enable, 0 = disable; 128 KB of RAM, not with CLOCK_MODE_PRELOCKED)
+#define ENABLE_FRAME_SYNC   1    ///< Count frames on GPIO_VSYNC_PIN and apply clock/region changes in vertical blank (1 = enable, 0 = disable)
+
+// Clocking: CLOCK_MODE_RELOCK re-locks PLL_SYS on a region switch, so clk_sys, MCLK and the
+// VCLK PWM share one PLL and USB keeps its 48 MHz. The other modes are opt-in:
+// CLOCK_MODE_PRELOCKED keeps both PLLs locked for microsecond region switches, at the cost
+// of USB (PLL_USB no longer runs at 48 MHz), tracing and the logic analyzer, with Brazil on
+// the NTSC clock and the PAL VCLK from the NTSC PLL. CLOCK_MODE_DECOUPLED runs the firmware
+// at a fixed 144 MHz whatever the region and keeps USB, with VCLK synthesized by a
+// fractional PWM divider. Both need VCLK_ASYNC_MAX_PPM raised, PRELOCKED also CLOCK_PLAN_MAX_PPM (Brazil).
+#define MCLK_CLOCK_MODE     CLOCK_MODE_RELOCK
+#define CLOCK_PLAN_MAX_PPM  500  ///< Largest MCLK error any region may run at (checked at compile time)
+#define VCLK_MAX_PPM        0    ///< Largest VCLK error when the PWM runs from MCLK's own PLL: the divider is exact (checked at compile time)
+#define VCLK_ASYNC_MAX_PPM  0    ///< Largest VCLK error when MCLK is on another PLL than clk_sys (checked at compile time; ~7000 for the opt-in modes)
 
 /**
  * @brief Joystick DB9 pinout reference (viewed from plug):
@@ -29,7 +47,62 @@
 #define GPIO_PIN_RIGHT   5   ///< DB9 pin 4
 #define GPIO_PIN_B       6   ///< DB9 pin 6
 #define GPIO_PIN_C       7   ///< DB9 pin 9
-#define GPIO_PIN_SELECT  8   ///< DB9 pin 7 (Select line, output)
+#define GPIO_PIN_SELECT  8   ///< DB9 pin 7 (Select line, input when sniffing, output when polling)
+
+// Pad sniffer timing
+#define PAD_SNIFFER_SETTLE_NS   500 ///< Delay between a console SELECT edge and the data sample
+#define PAD_CYCLE_GAP_US        1000 ///< Quiet SELECT time that starts a new pad read cycle (6-button pads reset after ~1.5 ms)
+#define PAD_POLL_INTERVAL_MS    1   ///< How often core 1 drains the sniffer ring
+#define FLASH_WINDOW_POLL_US    (PAD_POLL_INTERVAL_MS * 1000) ///< Pad read interval while core 0 writes flash
+
+// 68000 control lines. !VRES and !HALT are open collector: driven low or released, never high
+#define GPIO_HALT_PIN     10 ///< !HALT of the 68000
+#define GPIO_CART_CE_PIN  14 ///< !CART_CE, cart port pin B17 (non-TMSS consoles: wire to ground)
+#define GPIO_VRES_PIN     15 ///< !VRES
+
+// Console line timing
+#define CONSOLE_RESET_PULSE_US 16700 ///< !VRES pulse, as long as the VDP's own reset button pulse
+#define VCLK_SWITCH_HALT_US    2     ///< !HALT held this long before a VCLK divider swap (~15 VCLK cycles)
+
+// TMSS skip timing
+#define TMSS_VRES_PULSE_US     CONSOLE_RESET_PULSE_US
+#define TMSS_LANDED_MAX_US     20    ///< A cart that is mapped is read this soon after VRES release
+
+// Frame sync: the VDP's /VSYNC (or composite sync), active low; changes apply as before while it is unwired
+#define GPIO_VSYNC_PIN       11     ///< Vertical sync input
+#define FRAME_SYNC_FILTER_NS 16000  ///< A sync pulse this long is vertical sync (line sync pulses last 4.7 us)
+#define FRAME_SYNC_LOST_US   100000 ///< No frame for this long: no sync signal, changes apply straight away
+
+// Region jumpers (GPIO 16/17 on the original board, now taken by the OLED)
+#define GPIO_STANDARD_PIN 12 ///< Video standard jumper: high = NTSC, low = PAL
+#define GPIO_REGION_PIN   13 ///< Region jumper: high = export, low = Japan
+
+// Hotkeys
+#define HOTKEY_HOLD_US          1000000 ///< A+B+C+Start (reset) and A+Start (overclock) hold time
+#define REGION_SWITCH_TAPS      3       ///< Reset button presses that switch to the next region
+#define REGION_SWITCH_WINDOW_US 3000000 ///< Time from the first of those presses to the last
+
+// VCLK dividers (MCLK/div) in 1/16ths, the resolution of the PWM divider fraction
+#define VCLK_DIV_STOCK          (7 * 16)                ///< 68000 at stock speed
+#define VCLK_OC_LADDER          {100, 92, 80, 72, 64}   ///< Overclock steps, slowest first: MCLK/6.25, /5.75, /5, /4.5, /4
+#define VCLK_OC_DEFAULT_STEP    2                       ///< Ladder step used until another is picked (MCLK/5)
+
+// Trace export
+#define TRACE_DRAIN_INTERVAL_US 5000 ///< Trace export interval while a host is connected (rings hold ~60 ms of core 1 events)
+
+// Task periods (scheduler.c)
+#define PAD_READ_INTERVAL_US    10000  ///< Core 1 pad read interval when it polls the pad itself (sniffer off)
+#define INPUT_INTERVAL_US       10000  ///< Core 0 collects pad and reset button changes for the hotkeys
+#define DISPLAY_INTERVAL_US     100000 ///< Status screen refresh
+#define STATUS_LED_INTERVAL_US  20000  ///< Status LED pattern check
+#define EXPORT_IDLE_INTERVAL_US 100000 ///< Trace/capture export check while no host is listening
+#define CONFIG_WRITE_BEHIND_US  500000 ///< A changed setting is saved once it has been left alone this long
+#define SPLASH_TIME_US          2000000 ///< Boot logo time on the OLED before the status screen
+
+// Logic analyzer: GPIO_PIN_UP and the 15 GPIOs above it, into LA_RING_CHUNKS chained 32 KB rings
+#define LA_SAMPLE_HZ        4000000 ///< Sample rate: 16384 samples per ring, ~16 ms window with 4 rings
+#define LA_RING_CHUNKS      4       ///< Rings (one DMA channel each, at least 3); one ring of history precedes the trigger
+#define LA_TRIGGER_HOLD_US  500000  ///< B+C+Start hold that triggers a capture
 
 // GPIO pin used for VCLK output (CPU clock or overclocking)
 #define GPIO_VCLK_PIN    20  ///< VCLK output pin
@@ -40,6 +113,11 @@
 // OLED display I2C pin assignments
 #define OLED_SCL_PIN     16  ///< OLED I2C clock (SCL)
 #define OLED_SDA_PIN     17  ///< OLED I2C data (SDA)
+#define ENABLE_OLED_FAST_MODE_PLUS 0 ///< Run the OLED bus at 1MHz instead of 400kHz (needs stiffer pull-ups)
+
+// Status LED: the two anodes of a common cathode bi-color LED, on one PWM slice (even GPIO, then the next one)
+#define GPIO_LED1_PIN    18  ///< LED1, Japan color (PWM channel A)
+#define GPIO_LED2_PIN    19  ///< LED2, US/Americas color (PWM channel B)
 
 // GPIO pin used for error LED indication (typically onboard LED on Pico)
 #define ERROR_LED_PIN    25  ///< Error LED pin
@@ -0,0 +1,22 @@
+#ifndef STATUS_LED_H
+#define STATUS_LED_H
+
+#include <stdbool.h>
+#include "enums.h"
+
+/**
+ * @brief Set up the LED PWM slice and the DMA channels that stream patterns into it.
+ *        Call once clk_sys is final (after init_clock_output()). LEDs stay off until
+ *        the first status_led_show().
+ */
+void status_led_init(void);
+
+/**
+ * @brief Show a status: the region's color, pulsing while overclocked.
+ *        Builds the pattern only when the status changed; playback costs no CPU time.
+ * @param region      Current region.
+ * @param overclocked Overclock state.
+ */
+void status_led_show(region_t region, bool overclocked);
+
+#endif // STATUS_LED_H
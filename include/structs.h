@@ -24,6 +24,46 @@ typedef struct
     bool mode;    ///< Mode button pressed
 } joypad_state_t;
 
+/**
+ * @brief Packed joypad state: one bit per button, pressed = 1.
+ *        Fits in a single word so it can be shared between cores atomically.
+ */
+typedef uint16_t pad_mask_t;
+
+#define PAD_BTN_UP    (1u << 0)   ///< Up direction
+#define PAD_BTN_DOWN  (1u << 1)   ///< Down direction
+#define PAD_BTN_LEFT  (1u << 2)   ///< Left direction
+#define PAD_BTN_RIGHT (1u << 3)   ///< Right direction
+#define PAD_BTN_A     (1u << 4)   ///< A button
+#define PAD_BTN_B     (1u << 5)   ///< B button
+#define PAD_BTN_C     (1u << 6)   ///< C button
+#define PAD_BTN_START (1u << 7)   ///< Start button
+#define PAD_BTN_X     (1u << 8)   ///< X button
+#define PAD_BTN_Y     (1u << 9)   ///< Y button
+#define PAD_BTN_Z     (1u << 10)  ///< Z button
+#define PAD_BTN_MODE  (1u << 11)  ///< Mode button
+
+/**
+ * @brief A pad state change with the time it was observed.
+ */
+typedef struct
+{
+    uint64_t time_us;        ///< time_us_64() when the state was decoded
+    pad_mask_t mask;         ///< Packed button state
+    uint16_t seq;            ///< Publish sequence number (wraps)
+} pad_snapshot_t;
+
+/**
+ * @brief TMSS skip outcomes since power-on.
+ */
+typedef struct
+{
+    uint32_t armed;          ///< Boots released with the reflex armed
+    uint32_t landed;         ///< Boots that restarted straight into the cart
+    uint32_t missed;         ///< Boots where the TMSS ROM ran anyway
+    uint32_t last_latency_ns; ///< VRES release to first cart access on the last boot
+} tmss_stats_t;
+
 /**
  * @brief Represents the current status of the system.
  */
@@ -31,9 +71,13 @@ typedef struct
 {
     region_t region;         ///< Current region setting
     bool overclocked;        ///< Overclocking enabled/disabled
+    uint8_t oc_step;         ///< Overclock ladder step used while overclocked
+    uint16_t vclk_swap_timeouts; ///< VCLK divider swaps forced after the staged write did not land
     joypad_state_t pad;      ///< Current joypad state
 } system_status_t;
 
+extern system_status_t system_status; ///< Defined in main.c, owned by core 0
+
 /**
  * @brief Represents persistent configuration data.
  */
@@ -42,6 +86,7 @@ typedef struct
     uint32_t magic;          ///< Magic number to identify config
     region_t region;         ///< Saved region setting
     bool overclocked;        ///< Overclocking enabled/disabled
+    uint8_t oc_step;         ///< Overclock ladder step
 } config_t;
 
 /**
@@ -0,0 +1,34 @@
+#ifndef TMSS_SKIP_H
+#define TMSS_SKIP_H
+
+#include <stdbool.h>
+#include "structs.h"
+
+/**
+ * @brief Hold the 68000 in reset and load the TMSS skip reflex.
+ *        Call first thing at boot, before the master clock starts.
+ */
+void tmss_skip_init(void);
+
+/**
+ * @brief Release the console from reset with the reflex armed.
+ *        Call once MCLK/VCLK run at their final rates: the reset pulse
+ *        length is computed from the current clk_sys.
+ */
+void tmss_skip_arm(void);
+
+/**
+ * @brief Collect the outcome of this boot's skip, if it is known yet.
+ *        Never blocks. Frees the state machine and hands !VRES back to
+ *        SIO (released) once the result is in.
+ * @return true once the outcome has been recorded (straight away when the skip is disabled).
+ */
+bool tmss_skip_poll(void);
+
+/**
+ * @brief Skip counters since power-on.
+ * @return Pointer to the statistics.
+ */
+const tmss_stats_t *tmss_skip_stats(void);
+
+#endif // TMSS_SKIP_H
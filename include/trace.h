@@ -0,0 +1,106 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "setup.h"
+
+#define TRACE_RING_LEN  256    ///< Events buffered per core (power of 2)
+#define TRACE_END       0x80u  ///< Set in trace_event_t.id on the closing event of a span
+
+/**
+ * @brief Traced events. Spans record a begin and an end event, marks a single event.
+ *        Keep in step with tools/trace_decode.py.
+ */
+typedef enum
+{
+    TRACE_IDLE = 1,          ///< Span: core sleeping (arg: 0)
+    TRACE_ISR,               ///< Span: interrupt handler (arg: IRQ number)
+    TRACE_PAD_SAMPLE,        ///< Span: pad read or sniffer decode (end arg: pad mask)
+    TRACE_DISPLAY,           ///< Span: display frame on the bus (begin arg: bus bytes)
+    TRACE_FLASH,             ///< Span: flash erase/program (begin arg: flash offset)
+    TRACE_REGION_SWITCH,     ///< Mark: region switched (arg: new region)
+    TRACE_CONSOLE_STEP,      ///< Mark: console line executor step (arg: console_op_t)
+    TRACE_GESTURE,           ///< Mark: gesture fired (arg: table index)
+    TRACE_VBLANK,            ///< Mark: vertical blank started (arg: frames counted)
+    TRACE_TMSS_SKIP,         ///< Mark: TMSS skip outcome (arg: cart read ns after reset)
+    TRACE_LA_TRIGGER_MISSED  ///< Mark: logic analyzer trigger dropped, no ring clear of a hand-over (arg: la_trigger_t)
+} trace_id_t;
+
+/**
+ * @brief One trace event, 16 bytes, stored and exported as-is (little endian).
+ */
+typedef struct
+{
+    uint64_t time_us;        ///< time_us_64() when recorded
+    uint32_t arg;            ///< Event specific value
+    uint8_t id;              ///< trace_id_t, | TRACE_END for the end of a span
+    uint8_t core;            ///< Core that recorded the event
+    uint16_t seq;            ///< Per-core sequence number, gaps mean dropped events
+} trace_event_t;
+
+/**
+ * @brief Trace counters since power-on.
+ */
+typedef struct
+{
+    uint32_t recorded[2];    ///< Events recorded, per core
+    uint32_t dropped[2];     ///< Events lost to a full ring, per core
+    uint32_t drained;        ///< Events sent to the host
+} trace_stats_t;
+
+/**
+ * @brief Append an event to the calling core's ring. Never blocks, safe from IRQs.
+ * @param id  Event id (| TRACE_END to close a span).
+ * @param arg Event specific value.
+ */
+void trace_record(uint8_t id, uint32_t arg);
+
+/**
+ * @brief Send buffered events to the host over USB CDC, a bounded batch per call.
+ *        Core 0 only. Without a host the rings are emptied, so a host that
+ *        connects later starts with recent events.
+ * @return true while a host is listening: call again within TRACE_DRAIN_INTERVAL_US.
+ */
+bool trace_drain(void);
+
+/**
+ * @brief Whether a host has the USB CDC stream open, for the trace and capture exports.
+ * @return false when USB stdio is not linked in (CLOCK_MODE_PRELOCKED).
+ */
+bool trace_host_connected(void);
+
+/**
+ * @brief Trace counters.
+ * @return Pointer to the statistics.
+ */
+const trace_stats_t *trace_stats(void);
+
+/**
+ * @brief Open a span.
+ */
+static inline void trace_begin(trace_id_t id, uint32_t arg)
+{
+    if (ENABLE_TRACE)
+        trace_record((uint8_t)id, arg);
+}
+
+/**
+ * @brief Close a span opened with trace_begin().
+ */
+static inline void trace_end(trace_id_t id, uint32_t arg)
+{
+    if (ENABLE_TRACE)
+        trace_record((uint8_t)id | TRACE_END, arg);
+}
+
+/**
+ * @brief Record a single event.
+ */
+static inline void trace_mark(trace_id_t id, uint32_t arg)
+{
+    if (ENABLE_TRACE)
+        trace_record((uint8_t)id, arg);
+}
+
+#endif // TRACE_H
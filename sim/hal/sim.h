@@ -0,0 +1,141 @@
+#ifndef SIM_H
+#define SIM_H
+
+/*
+ * Simulation kernel and model interface
+ * -------------------------------------
+ * Virtual time is kept in nanoseconds. Each RP2040 core runs as a coroutine
+ * with its own local clock; the scheduler always resumes whichever of the
+ * two cores or the pending events is furthest behind, so the firmware and
+ * the console-side models see one consistent timeline. Firmware code runs in
+ * zero virtual time except where the HAL charges for it (sleeps, busy waits,
+ * blocking bus transfers, flash operations).
+ *
+ * Models (pad, console, OLED, PIO programs) run in event context: they may
+ * read and drive pins, schedule events and raise IRQs, but never block.
+ */
+
+#include "sim_hal.h"
+#include <stdio.h>
+
+#define SIM_NUM_CORES 2
+#define SIM_NS_PER_US 1000ull
+#define SIM_NS_PER_MS 1000000ull
+#define SIM_NEVER     UINT64_MAX
+#define SIM_MODEL     (-1) ///< Event owner for model events (not delivered to a core)
+
+typedef void (*sim_event_fn)(void *arg);
+typedef struct sim_event sim_event_t;
+
+/* ---- kernel (sim_core.c) ---- */
+void sim_init(void);
+void sim_start_core0(void (*entry)(void));
+uint64_t sim_run(uint64_t until_ns);
+void sim_stop(void);
+uint64_t sim_now_ns(void);
+int sim_current_core(void);
+sim_event_t *sim_schedule(uint64_t at_ns, int core, sim_event_fn fn, void *arg);
+void sim_cancel(sim_event_t *ev);
+void sim_advance_ns(uint64_t ns);
+void sim_irq_raise(uint num);
+uint64_t sim_core_busy_ns(int core);
+bool sim_core_launched(int core);
+void sim_core_park(int core, bool parked);  ///< Stop scheduling a core (e.g. locked out during a flash write)
+
+/* ---- gpio (sim_gpio.c) ---- */
+typedef void (*sim_pin_watch_fn)(uint pin, bool level, void *arg);
+void sim_gpio_reset(void);
+void sim_gpio_drive(uint pin, int level);              ///< External driver: 0, 1 or -1 to release
+bool sim_gpio_level(uint pin);
+bool sim_gpio_is_output(uint pin);
+void sim_gpio_watch(uint pin, sim_pin_watch_fn fn, void *arg);
+void sim_gpio_pio_drive(uint pin, bool oe, bool level); ///< Pin driven by a PIO state machine
+
+/* ---- dma (sim_dma.c) ---- */
+void sim_dma_reset(void);
+bool sim_dma_dreq_push(uint dreq, uint32_t word);      ///< Peripheral produced a word; false if no channel took it
+bool sim_dma_dreq_pull(uint dreq, uint32_t *word);     ///< Peripheral wants a word; false if no channel supplied one
+size_t sim_dma_drain(uint ch, uint32_t *out, size_t count); ///< Paced peripheral consuming a busy channel
+void sim_dma_complete(uint ch);
+void sim_dma_reg_written(volatile void *addr);
+uint32_t sim_dma_transfer_words(void);
+
+/* ---- i2c (sim_i2c.c) ---- */
+typedef void (*sim_i2c_rx_fn)(const uint8_t *bytes, size_t len, void *arg);
+void sim_i2c_attach(uint8_t addr, sim_i2c_rx_fn fn, void *arg);
+void sim_i2c_dma_start(uint ch);
+uint32_t sim_i2c_bytes(void);
+
+/* ---- pio (sim_pio.c) ---- */
+typedef struct sim_pio_sm sim_pio_sm_t;
+typedef struct
+{
+    const char *program;                             ///< .program name the model stands in for
+    void (*start)(sim_pio_sm_t *sm);
+    void (*stop)(sim_pio_sm_t *sm);
+    void (*tx)(sim_pio_sm_t *sm, uint32_t word);     ///< Word written to the TX FIFO (optional)
+} sim_pio_model_t;
+struct sim_pio_sm
+{
+    PIO pio;
+    uint index;
+    uint offset;                  ///< Program load offset
+    pio_sm_config cfg;
+    const pio_program_t *program;
+    const sim_pio_model_t *model;
+    bool enabled;
+    uint32_t rx_fifo[8];
+    uint rx_level;
+    uint32_t rx_dropped;
+    void *state;                  ///< Model private data
+};
+void sim_pio_reset(void);
+void sim_pio_register_model(const sim_pio_model_t *model);
+void sim_pio_push(sim_pio_sm_t *sm, uint32_t word);
+uint64_t sim_pio_cycles_to_ns(const sim_pio_sm_t *sm, uint32_t cycles);
+uint64_t sim_pio_ns_to_cycles(const sim_pio_sm_t *sm, uint64_t ns);
+void sim_pio_raise_irq(sim_pio_sm_t *sm, uint irq_flag);
+
+/* ---- clocks / pwm (sim_clocks.c, sim_pwm.c) ---- */
+typedef struct
+{
+    uint32_t gpout_stops;      ///< MCLK parked via ENABLE
+    uint32_t live_switches;    ///< MCLK source/divider changed while running (runt pulses on hardware)
+    uint32_t relocks_live;     ///< PLL re-initialised while feeding a running MCLK
+    uint32_t pll_locks;
+    uint64_t mclk_down_ns;     ///< Total time MCLK was stopped or unstable
+} sim_clock_stats_t;
+void sim_clocks_reset(void);
+uint32_t sim_mclk_hz(void);
+uint32_t sim_clk_peri_hz(void);
+const sim_clock_stats_t *sim_clock_stats(void);
+void sim_clocks_reg_written(volatile void *addr);
+typedef struct
+{
+    uint32_t div_swaps;          ///< DIV writes staged outside the SDK (DMA, hw_* helpers)
+    uint32_t div_swaps_off_wrap; ///< ... landing past the first counter step of a period
+} sim_pwm_stats_t;
+double sim_pwm_freq_hz(uint slice);
+uint64_t sim_pwm_dreq_ns(uint slice);
+const sim_pwm_stats_t *sim_pwm_stats(void);
+void sim_pwm_reg_written(volatile void *addr);
+
+/* ---- flash (sim_flash.c) ---- */
+typedef struct
+{
+    uint32_t erases;
+    uint32_t programs;
+    uint32_t safe_executes;
+    uint64_t stall_ns;
+} sim_flash_stats_t;
+void sim_flash_reset(void);
+bool sim_flash_load(const char *path);
+bool sim_flash_save(const char *path);
+const sim_flash_stats_t *sim_flash_stats(void);
+void sim_flash_xip_check(const char *what);  ///< Panic if flash is being written by the other core
+
+/* ---- logging ---- */
+extern bool sim_verbose;
+void sim_log(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#endif // SIM_H
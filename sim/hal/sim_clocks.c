@@ -0,0 +1,266 @@
+#include "sim.h"
+#include <string.h>
+
+/*
+ * Clocks, PLLs and GPOUT0 (MCLK)
+ * ------------------------------
+ * Frequencies are tracked, not waveforms. What matters to the firmware's
+ * clock switching is whether MCLK ever runs from something unstable, so the
+ * model watches GPOUT0: a source or divider change while it is enabled is a
+ * live switch (a runt pulse on hardware), and re-locking a PLL that is
+ * feeding an enabled GPOUT0 is counted separately. The time MCLK spends
+ * parked or unstable is accumulated.
+ *
+ * clock_get_hz() returns what the SDK recorded, as on hardware. clk_peri
+ * also has its real rate tracked from its source, so a PLL re-lock under
+ * it (set_sys_clock_pll() leaves it on PLL_USB) shows up as a mismatch.
+ */
+
+#define PLL_LOCK_NS (200 * SIM_NS_PER_US) ///< Typical lock time after pll_init()
+#define BOOT_SYS_HZ 125000000u
+
+struct pll_hw
+{
+    uint32_t vco_hz;
+    uint32_t out_hz;
+    bool locked;
+};
+
+static struct pll_hw plls[2];
+PLL pll_sys = &plls[0];
+PLL pll_usb = &plls[1];
+
+static clocks_hw_t clocks_regs;
+clocks_hw_t *clocks_hw = &clocks_regs;
+
+static uint32_t clk_hz[CLK_COUNT];
+static uint32_t clk_sys_src; ///< CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_* feeding clk_sys
+static uint32_t clk_peri_src; ///< CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_* feeding clk_peri
+static uint32_t clk_peri_src_hz, clk_peri_div_hz; ///< Divider as set: src_freq / freq
+static sim_clock_stats_t stats;
+
+// GPOUT0 as last seen, to classify changes
+static uint32_t gpout_ctrl_seen, gpout_div_seen;
+static uint32_t mclk_hz_seen;
+static uint64_t mclk_down_since;
+static bool mclk_down = true;
+
+static uint32_t aux_src_hz(uint32_t auxsrc)
+{
+    switch (auxsrc) {
+    case CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS: return pll_sys->locked ? pll_sys->out_hz : 0;
+    case CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB: return pll_usb->locked ? pll_usb->out_hz : 0;
+    case CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_XOSC_CLKSRC: return XOSC_HZ;
+    case CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_SYS: return clk_hz[clk_sys];
+    case CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_USB: return clk_hz[clk_usb];
+    default: return 0;
+    }
+}
+
+static uint32_t gpout_auxsrc(uint32_t ctrl)
+{
+    return (ctrl & CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_BITS) >> CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_LSB;
+}
+
+uint32_t sim_mclk_hz(void)
+{
+    const clock_hw_t *g = &clocks_hw->clk[clk_gpout0];
+    if (!(g->ctrl & CLOCKS_CLK_GPOUT0_CTRL_ENABLE_BITS))
+        return 0;
+    uint32_t div = g->div >> CLOCKS_CLK_GPOUT0_DIV_INT_LSB;
+    return aux_src_hz(gpout_auxsrc(g->ctrl)) / (div ? div : 1);
+}
+
+uint32_t sim_clk_peri_hz(void)
+{
+    uint32_t src_hz;
+    switch (clk_peri_src) {
+    case CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS: src_hz = clk_hz[clk_sys]; break;
+    case CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS: src_hz = pll_sys->locked ? pll_sys->out_hz : 0; break;
+    case CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB: src_hz = pll_usb->locked ? pll_usb->out_hz : 0; break;
+    case CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_XOSC_CLKSRC: src_hz = XOSC_HZ; break;
+    default: src_hz = 0; break;
+    }
+    return (uint32_t)((uint64_t)src_hz * clk_peri_div_hz / clk_peri_src_hz);
+}
+
+static void set_mclk_down(bool down)
+{
+    if (down && !mclk_down)
+        mclk_down_since = sim_now_ns();
+    else if (!down && mclk_down)
+        stats.mclk_down_ns += sim_now_ns() - mclk_down_since;
+    mclk_down = down;
+}
+
+/**
+ * @brief Re-evaluate GPOUT0 after a register or PLL change.
+ */
+static void gpout_changed(void)
+{
+    const clock_hw_t *g = &clocks_hw->clk[clk_gpout0];
+    bool was_on = gpout_ctrl_seen & CLOCKS_CLK_GPOUT0_CTRL_ENABLE_BITS;
+    bool is_on = g->ctrl & CLOCKS_CLK_GPOUT0_CTRL_ENABLE_BITS;
+    uint32_t hz = sim_mclk_hz();
+
+    if (was_on && !is_on)
+        stats.gpout_stops++;
+    if (was_on && is_on && (gpout_auxsrc(gpout_ctrl_seen) != gpout_auxsrc(g->ctrl) || gpout_div_seen != g->div))
+        stats.live_switches++;
+    if (hz != mclk_hz_seen)
+        sim_log("MCLK %.6f MHz", hz / 1e6);
+
+    gpout_ctrl_seen = g->ctrl;
+    gpout_div_seen = g->div;
+    mclk_hz_seen = hz;
+    set_mclk_down(hz == 0);
+}
+
+static bool gpout_fed_by(PLL pll)
+{
+    const clock_hw_t *g = &clocks_hw->clk[clk_gpout0];
+    if (!(g->ctrl & CLOCKS_CLK_GPOUT0_CTRL_ENABLE_BITS))
+        return false;
+    uint32_t src = gpout_auxsrc(g->ctrl);
+    if (pll == pll_sys)
+        return src == CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS ||
+               (src == CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_SYS && clk_sys_src == CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS);
+    return src == CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB;
+}
+
+void sim_clocks_reset(void)
+{
+    memset(plls, 0, sizeof(plls));
+    memset(&clocks_regs, 0, sizeof(clocks_regs));
+    memset(&stats, 0, sizeof(stats));
+    // Boot state of the SDK runtime: 125 MHz from PLL_SYS, 48 MHz USB
+    plls[0] = (struct pll_hw){1500000000u, BOOT_SYS_HZ, true};
+    plls[1] = (struct pll_hw){1440000000u, 48000000u, true};
+    clk_hz[clk_ref] = XOSC_HZ;
+    clk_hz[clk_sys] = BOOT_SYS_HZ;
+    clk_hz[clk_peri] = BOOT_SYS_HZ;
+    clk_peri_src = CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS;
+    clk_peri_src_hz = clk_peri_div_hz = BOOT_SYS_HZ;
+    clk_hz[clk_usb] = 48000000u;
+    clk_hz[clk_adc] = 48000000u;
+    clk_hz[clk_rtc] = 46875u;
+    clk_sys_src = CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS;
+    gpout_ctrl_seen = gpout_div_seen = mclk_hz_seen = 0;
+    mclk_down = true;
+    mclk_down_since = 0;
+}
+
+const sim_clock_stats_t *sim_clock_stats(void)
+{
+    set_mclk_down(mclk_down); // fold in the current outage
+    if (mclk_down)
+        mclk_down_since = sim_now_ns();
+    return &stats;
+}
+
+void sim_clocks_reg_written(volatile void *addr)
+{
+    const volatile uint8_t *a = addr;
+    if (a >= (const volatile uint8_t *)&clocks_hw->clk[clk_gpout0] &&
+        a < (const volatile uint8_t *)&clocks_hw->clk[clk_gpout1])
+        gpout_changed();
+}
+
+/* ---- SDK API ---- */
+
+void pll_init(PLL pll, uint ref_div, uint vco_freq, uint post_div1, uint post_div2)
+{
+    bool live = gpout_fed_by(pll);
+    if (live)
+        stats.relocks_live++;
+    stats.pll_locks++;
+
+    pll->locked = false;
+    if (live)
+        gpout_changed();
+    // The SDK spins until LOCK is set
+    sim_advance_ns(PLL_LOCK_NS);
+    // As the SDK: the feedback divider is truncated, so an unreachable VCO locks lower
+    uint32_t ref_hz = XOSC_HZ / ref_div;
+    pll->vco_hz = vco_freq / ref_hz * ref_hz;
+    pll->out_hz = pll->vco_hz / (post_div1 * post_div2);
+    pll->locked = true;
+
+    if (pll == pll_sys && clk_sys_src == CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS)
+        clk_hz[clk_sys] = pll->out_hz;
+    gpout_changed();
+}
+
+void pll_deinit(PLL pll)
+{
+    pll->locked = false;
+    gpout_changed();
+}
+
+bool set_sys_clock_pll(uint32_t vco_freq, uint post_div1, uint post_div2)
+{
+    // As the SDK: clk_sys runs from PLL_USB, taken to be 48 MHz, while PLL_SYS re-locks
+    clk_sys_src = CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB;
+    clk_hz[clk_sys] = pll_usb->locked ? pll_usb->out_hz : 0;
+    if (clk_hz[clk_sys] != 48 * MHZ)
+        sim_log("clk_sys at %.3f MHz from PLL_USB while PLL_SYS locks", clk_hz[clk_sys] / 1e6);
+    pll_init(pll_sys, PLL_SYS_REFDIV, vco_freq, post_div1, post_div2);
+    clk_sys_src = CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS;
+    clk_hz[clk_sys] = pll_sys->out_hz;
+    // ...and leaves clk_peri on PLL_USB, recorded as 48 MHz whatever it runs at
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, 48 * MHZ, 48 * MHZ);
+    return true;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required)
+{
+    (void)required;
+    uint32_t vco = freq_khz * 1000u * 12;
+    return set_sys_clock_pll(vco, 6, 2);
+}
+
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq)
+{
+    (void)src;
+    if (freq > src_freq)
+        return false;
+    clk_hz[clk_index] = freq;
+    if (clk_index == clk_sys)
+        clk_sys_src = auxsrc;
+    if (clk_index == clk_peri) {
+        clk_peri_src = auxsrc;
+        clk_peri_src_hz = src_freq;
+        clk_peri_div_hz = freq;
+    }
+    if (clk_index == clk_gpout0)
+        sim_panic("clock_configure() on GPOUT0: use clock_gpio_init()");
+    return true;
+}
+
+void clock_stop(enum clock_index clk_index)
+{
+    clk_hz[clk_index] = 0;
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+    return clk_hz[clk_index];
+}
+
+void clock_gpio_init_int_frac(uint gpio, uint src, uint32_t div_int, uint8_t div_frac)
+{
+    if (gpio != 21)
+        sim_panic("only GPOUT0 on GPIO21 is modelled (got GPIO%u)", gpio);
+    clock_hw_t *g = &clocks_hw->clk[clk_gpout0];
+    // Same register sequence as the SDK: divider and source written, then enabled in one store
+    g->div = (div_int << CLOCKS_CLK_GPOUT0_DIV_INT_LSB) | div_frac;
+    g->ctrl = (src << CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_LSB) | CLOCKS_CLK_GPOUT0_CTRL_ENABLE_BITS;
+    gpio_set_function(gpio, GPIO_FUNC_GPCK);
+    gpout_changed();
+}
+
+void clock_gpio_init(uint gpio, uint src, float div)
+{
+    uint32_t div_int = (uint32_t)div;
+    clock_gpio_init_int_frac(gpio, src, div_int, (uint8_t)((div - div_int) * 256));
+}
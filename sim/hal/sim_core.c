@@ -0,0 +1,743 @@
+#include "sim.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+/*
+ * Simulation kernel
+ * -----------------
+ * Events live in a binary min-heap ordered by (time, insertion order). A
+ * core coroutine runs until its local clock passes the next thing that could
+ * affect it (an event or the other core), then yields back here. Interrupt
+ * handlers run as events on the core that enabled the IRQ, and charge any
+ * time they consume to that core; model events falling due meanwhile run
+ * under them, as the peripherals would.
+ */
+
+#define CORE_STACK_BYTES (512 * 1024)
+#define MAX_SHARED_HANDLERS 4
+#define MAX_ALARMS 64
+
+struct sim_event
+{
+    uint64_t at;
+    uint64_t order;
+    int core;
+    bool cancelled;
+    sim_event_fn fn;
+    void *arg;
+};
+
+typedef struct
+{
+    ucontext_t ctx;
+    void *stack;
+    void (*entry)(void);
+    bool launched;
+    bool finished;
+    bool waiting;           ///< In __wfe()/best_effort_wfe_or_timeout()
+    bool event_flag;        ///< SEV / interrupt latch for WFE
+    bool parked;            ///< Held off by the other core (flash lockout)
+    uint64_t now;
+    uint64_t wake_at;
+    uint64_t busy_ns;
+    uint32_t irq_enabled;
+    uint32_t irq_pending;   ///< Raised while interrupts were masked
+    uint32_t irq_mask_depth;
+    irq_handler_t handlers[NUM_IRQS][MAX_SHARED_HANDLERS];
+} sim_core_t;
+
+static sim_core_t cores[SIM_NUM_CORES];
+static ucontext_t sched_ctx;
+static int current = SIM_MODEL;      ///< Core whose coroutine is running, or the event's core
+static bool in_event = false;
+static uint64_t event_now;           ///< Time inside an event (advances if a handler burns time)
+static bool stop_requested = false;
+
+static sim_event_t **heap;
+static size_t heap_len, heap_cap;
+static uint64_t event_order;
+
+bool sim_verbose = false;
+
+void sim_log(const char *fmt, ...)
+{
+    if (!sim_verbose)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "[%10.3f ms] ", sim_now_ns() / 1e6);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+void sim_panic(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "PANIC at %.3f ms on core %d: ", sim_now_ns() / 1e6, current);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    exit(2);
+}
+
+/* ---- event heap ---- */
+
+static bool ev_before(const sim_event_t *a, const sim_event_t *b)
+{
+    return a->at < b->at || (a->at == b->at && a->order < b->order);
+}
+
+static void heap_push(sim_event_t *ev)
+{
+    if (heap_len == heap_cap) {
+        heap_cap = heap_cap ? heap_cap * 2 : 256;
+        heap = realloc(heap, heap_cap * sizeof(*heap));
+    }
+    size_t i = heap_len++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!ev_before(ev, heap[parent]))
+            break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = ev;
+}
+
+static sim_event_t *heap_pop(void)
+{
+    sim_event_t *top = heap[0];
+    sim_event_t *last = heap[--heap_len];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= heap_len)
+            break;
+        if (child + 1 < heap_len && ev_before(heap[child + 1], heap[child]))
+            child++;
+        if (!ev_before(heap[child], last))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (heap_len)
+        heap[i] = last;
+    return top;
+}
+
+static sim_event_t *heap_peek(void)
+{
+    while (heap_len && heap[0]->cancelled)
+        free(heap_pop());
+    return heap_len ? heap[0] : NULL;
+}
+
+sim_event_t *sim_schedule(uint64_t at_ns, int core, sim_event_fn fn, void *arg)
+{
+    sim_event_t *ev = malloc(sizeof(*ev));
+    *ev = (sim_event_t){at_ns, event_order++, core, false, fn, arg};
+    heap_push(ev);
+    return ev;
+}
+
+void sim_cancel(sim_event_t *ev)
+{
+    if (ev)
+        ev->cancelled = true;
+}
+
+/* ---- time ---- */
+
+uint64_t sim_now_ns(void)
+{
+    if (in_event)
+        return event_now;
+    if (current >= 0)
+        return cores[current].now;
+    return event_now;
+}
+
+int sim_current_core(void)
+{
+    return current;
+}
+
+static uint64_t core_resume_time(const sim_core_t *c)
+{
+    if (!c->launched || c->finished || c->parked)
+        return SIM_NEVER;
+    return c->waiting ? c->wake_at : c->now;
+}
+
+/**
+ * @brief Earliest time anything other than the running core needs to act.
+ */
+static uint64_t horizon(void)
+{
+    sim_event_t *ev = heap_peek();
+    uint64_t h = ev ? ev->at : SIM_NEVER;
+    for (int i = 0; i < SIM_NUM_CORES; ++i) {
+        if (i != current) {
+            uint64_t t = core_resume_time(&cores[i]);
+            if (t < h)
+                h = t;
+        }
+    }
+    return h;
+}
+
+static void yield_to_scheduler(void)
+{
+    sim_core_t *c = &cores[current];
+    swapcontext(&c->ctx, &sched_ctx);
+}
+
+/**
+ * @brief Run model events that fell due while an event handler burned time,
+ *        so peripherals (DMA, PIO) keep going under a spinning IRQ handler.
+ *        Stops at the first event owned by a core: handlers do not nest.
+ */
+static void run_due_models(void)
+{
+    static bool running = false;
+    if (running)
+        return;
+    running = true;
+    int core = current;
+    uint64_t now = event_now;
+    sim_event_t *ev;
+    while ((ev = heap_peek()) && ev->at <= now && ev->core == SIM_MODEL) {
+        heap_pop();
+        current = SIM_MODEL;
+        event_now = ev->at;
+        ev->fn(ev->arg);
+        free(ev);
+    }
+    current = core;
+    event_now = now;
+    running = false;
+}
+
+void sim_advance_ns(uint64_t ns)
+{
+    if (in_event || current < 0) {
+        // Interrupt handler burning time: the interrupted core loses it too
+        event_now += ns;
+        if (current >= 0) {
+            cores[current].now += ns;
+            cores[current].busy_ns += ns;
+        }
+        run_due_models();
+        return;
+    }
+    sim_core_t *c = &cores[current];
+    c->now += ns;
+    c->busy_ns += ns;
+    if (c->now > horizon())
+        yield_to_scheduler();
+}
+
+static void sleep_until_ns(uint64_t t)
+{
+    if (in_event || current < 0) {
+        // Blocking inside an IRQ handler or a model is a firmware bug on hardware too
+        sim_panic("blocking call from interrupt/model context");
+    }
+    sim_core_t *c = &cores[current];
+    if (t > c->now)
+        c->now = t;
+    yield_to_scheduler();
+}
+
+/* ---- IRQs ---- */
+
+static void run_handlers(int core, uint num)
+{
+    for (int i = 0; i < MAX_SHARED_HANDLERS; ++i) {
+        irq_handler_t h = cores[core].handlers[num][i];
+        if (h)
+            h();
+    }
+}
+
+static void irq_event(void *arg)
+{
+    uint num = (uint)(uintptr_t)arg;
+    sim_core_t *c = &cores[current];
+    if (!(c->irq_enabled & (1u << num)))
+        return;
+    if (c->irq_mask_depth) {
+        c->irq_pending |= 1u << num;
+        return;
+    }
+    run_handlers(current, num);
+}
+
+void sim_irq_raise(uint num)
+{
+    for (int i = 0; i < SIM_NUM_CORES; ++i) {
+        if (cores[i].launched && (cores[i].irq_enabled & (1u << num)))
+            sim_schedule(sim_now_ns(), i, irq_event, (void *)(uintptr_t)num);
+    }
+}
+
+static int irq_core(void)
+{
+    return current < 0 ? 0 : current;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+    sim_core_t *c = &cores[irq_core()];
+    memset(c->handlers[num], 0, sizeof(c->handlers[num]));
+    c->handlers[num][0] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority)
+{
+    (void)order_priority;
+    sim_core_t *c = &cores[irq_core()];
+    for (int i = 0; i < MAX_SHARED_HANDLERS; ++i) {
+        if (!c->handlers[num][i]) {
+            c->handlers[num][i] = handler;
+            return;
+        }
+    }
+    sim_panic("too many shared handlers on IRQ %u", num);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler)
+{
+    sim_core_t *c = &cores[irq_core()];
+    for (int i = 0; i < MAX_SHARED_HANDLERS; ++i) {
+        if (c->handlers[num][i] == handler)
+            c->handlers[num][i] = NULL;
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    sim_core_t *c = &cores[irq_core()];
+    if (enabled)
+        c->irq_enabled |= 1u << num;
+    else
+        c->irq_enabled &= ~(1u << num);
+}
+
+bool irq_is_enabled(uint num)
+{
+    return (cores[irq_core()].irq_enabled & (1u << num)) != 0;
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority)
+{
+    (void)num;
+    (void)hardware_priority;
+}
+
+uint32_t save_and_disable_interrupts(void)
+{
+    sim_core_t *c = &cores[irq_core()];
+    return c->irq_mask_depth++;
+}
+
+void restore_interrupts_from_disabled(uint32_t status)
+{
+    sim_core_t *c = &cores[irq_core()];
+    c->irq_mask_depth = status;
+    if (!c->irq_mask_depth && c->irq_pending) {
+        uint32_t pending = c->irq_pending;
+        c->irq_pending = 0;
+        for (uint num = 0; num < NUM_IRQS; ++num) {
+            if (pending & (1u << num))
+                run_handlers(irq_core(), num);
+        }
+    }
+}
+
+void restore_interrupts(uint32_t status)
+{
+    restore_interrupts_from_disabled(status);
+}
+
+/* ---- WFE / SEV ---- */
+
+static void wait_for_event(uint64_t wake_at)
+{
+    sim_core_t *c = &cores[current];
+    c->waiting = true;
+    c->wake_at = wake_at;
+    yield_to_scheduler();
+}
+
+void __wfe(void)
+{
+    sim_core_t *c = &cores[irq_core()];
+    if (!c->event_flag && !in_event)
+        wait_for_event(SIM_NEVER);
+    c->event_flag = false;
+}
+
+void __wfi(void)
+{
+    __wfe();
+}
+
+void __sev(void)
+{
+    for (int i = 0; i < SIM_NUM_CORES; ++i) {
+        if (i == current)
+            continue;
+        sim_core_t *c = &cores[i];
+        c->event_flag = true;
+        if (c->waiting) {
+            c->waiting = false;
+            if (c->now < sim_now_ns())
+                c->now = sim_now_ns();
+        }
+    }
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp)
+{
+    uint64_t deadline = timeout_timestamp * SIM_NS_PER_US;
+    sim_core_t *c = &cores[irq_core()];
+    if (sim_now_ns() >= deadline)
+        return true;
+    if (c->event_flag) {
+        c->event_flag = false;
+        return false;
+    }
+    wait_for_event(deadline);
+    c->event_flag = false;
+    return sim_now_ns() >= deadline;
+}
+
+void tight_loop_contents(void)
+{
+    sim_advance_ns(20);
+}
+
+uint get_core_num(void)
+{
+    return (uint)irq_core();
+}
+
+void busy_wait_at_least_cycles(uint32_t cycles)
+{
+    uint32_t hz = clock_get_hz(clk_sys);
+    sim_advance_ns((uint64_t)cycles * 1000000000ull / (hz ? hz : 1));
+}
+
+/* ---- sleeping and timestamps ---- */
+
+uint64_t time_us_64(void)
+{
+    sim_flash_xip_check("time_us_64");
+    return sim_now_ns() / SIM_NS_PER_US;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)time_us_64();
+}
+
+timer_hw_t *sim_timer_hw(void)
+{
+    static timer_hw_t regs;
+    // Register reads, so unlike time_us_64() usable while flash is busy
+    uint64_t now = sim_now_ns() / SIM_NS_PER_US;
+    regs.timerawh = (uint32_t)(now >> 32);
+    regs.timerawl = (uint32_t)now;
+    return &regs;
+}
+
+void sleep_us(uint64_t us)
+{
+    sim_flash_xip_check("sleep_us");
+    sleep_until_ns(sim_now_ns() + us * SIM_NS_PER_US);
+}
+
+void sleep_ms(uint32_t ms)
+{
+    sleep_us(ms * 1000ull);
+}
+
+void sleep_until(absolute_time_t t)
+{
+    sim_flash_xip_check("sleep_until");
+    sleep_until_ns(t * SIM_NS_PER_US);
+}
+
+void busy_wait_us_32(uint32_t delay_us)
+{
+    sim_flash_xip_check("busy_wait_us_32");
+    sim_advance_ns(delay_us * SIM_NS_PER_US);
+}
+
+void busy_wait_us(uint64_t delay_us)
+{
+    sim_flash_xip_check("busy_wait_us");
+    sim_advance_ns(delay_us * SIM_NS_PER_US);
+}
+
+void busy_wait_ms(uint32_t delay_ms)
+{
+    sim_advance_ns(delay_ms * SIM_NS_PER_MS);
+}
+
+/* ---- alarms ---- */
+
+typedef struct
+{
+    bool used;
+    alarm_id_t id;
+    uint64_t target_us;
+    alarm_callback_t callback;
+    void *user_data;
+    sim_event_t *ev;
+} sim_alarm_t;
+
+static sim_alarm_t alarms[MAX_ALARMS];
+static alarm_id_t next_alarm_id = 1;
+
+static void alarm_event(void *arg)
+{
+    sim_alarm_t *a = arg;
+    a->ev = NULL;
+    int64_t again = a->callback(a->id, a->user_data);
+    if (!a->used || a->ev)
+        return; // cancelled or re-armed from inside the callback
+    if (again == 0) {
+        a->used = false;
+        return;
+    }
+    // <0: relative to the previous target, >0: relative to now
+    a->target_us = again < 0 ? a->target_us + (uint64_t)(-again) : time_us_64() + (uint64_t)again;
+    a->ev = sim_schedule(a->target_us * SIM_NS_PER_US, irq_core(), alarm_event, a);
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+    if (time <= time_us_64()) {
+        if (!fire_if_past)
+            return 0;
+    }
+    for (int i = 0; i < MAX_ALARMS; ++i) {
+        sim_alarm_t *a = &alarms[i];
+        if (a->used)
+            continue;
+        *a = (sim_alarm_t){true, next_alarm_id++, time, callback, user_data, NULL};
+        if (next_alarm_id <= 0)
+            next_alarm_id = 1;
+        uint64_t at = time * SIM_NS_PER_US;
+        a->ev = sim_schedule(at > sim_now_ns() ? at : sim_now_ns(), irq_core(), alarm_event, a);
+        return a->id;
+    }
+    return -1;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+    return add_alarm_at(time_us_64() + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+    return add_alarm_at(time_us_64() + ms * 1000ull, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id)
+{
+    for (int i = 0; i < MAX_ALARMS; ++i) {
+        sim_alarm_t *a = &alarms[i];
+        if (a->used && a->id == alarm_id) {
+            sim_cancel(a->ev);
+            a->ev = NULL;
+            a->used = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int64_t repeating_timer_alarm(alarm_id_t id, void *user_data)
+{
+    (void)id;
+    repeating_timer_t *rt = user_data;
+    if (!rt->callback(rt))
+        return 0;
+    // Negative delay: fixed rate from the previous start, positive: from now
+    return rt->delay_us;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out)
+{
+    if (!delay_us)
+        delay_us = 1;
+    out->delay_us = delay_us;
+    out->callback = callback;
+    out->user_data = user_data;
+    out->alarm_id = add_alarm_in_us((uint64_t)(delay_us < 0 ? -delay_us : delay_us), repeating_timer_alarm, out, true);
+    return out->alarm_id > 0;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out)
+{
+    return add_repeating_timer_us(delay_ms * 1000ll, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer)
+{
+    return cancel_alarm(timer->alarm_id);
+}
+
+/* ---- cores ---- */
+
+static void core_trampoline(void)
+{
+    sim_core_t *c = &cores[current];
+    c->entry();
+    c->finished = true;
+    swapcontext(&c->ctx, &sched_ctx);
+}
+
+static void core_launch(int index, void (*entry)(void), uint64_t at)
+{
+    sim_core_t *c = &cores[index];
+    if (!c->stack)
+        c->stack = malloc(CORE_STACK_BYTES);
+    getcontext(&c->ctx);
+    c->ctx.uc_stack.ss_sp = c->stack;
+    c->ctx.uc_stack.ss_size = CORE_STACK_BYTES;
+    c->ctx.uc_link = NULL;
+    makecontext(&c->ctx, core_trampoline, 0);
+    c->entry = entry;
+    c->launched = true;
+    c->finished = false;
+    c->now = at;
+}
+
+void sim_start_core0(void (*entry)(void))
+{
+    core_launch(0, entry, 0);
+}
+
+void multicore_launch_core1(void (*entry)(void))
+{
+    if (cores[1].launched && !cores[1].finished)
+        sim_panic("core 1 launched twice");
+    core_launch(1, entry, sim_now_ns());
+}
+
+void multicore_reset_core1(void)
+{
+    cores[1].launched = false;
+    cores[1].irq_enabled = 0;
+}
+
+bool sim_core_launched(int core)
+{
+    return cores[core].launched && !cores[core].finished;
+}
+
+void sim_core_park(int core, bool parked)
+{
+    sim_core_t *c = &cores[core];
+    c->parked = parked;
+    if (parked)
+        return;
+    // Resume no earlier than the release; a pending timeout slips with it
+    uint64_t now = sim_now_ns();
+    if (c->now < now)
+        c->now = now;
+    if (c->waiting && c->wake_at < now)
+        c->wake_at = now;
+}
+
+uint64_t sim_core_busy_ns(int core)
+{
+    return cores[core].busy_ns;
+}
+
+/* ---- scheduler ---- */
+
+void sim_init(void)
+{
+    for (int i = 0; i < SIM_NUM_CORES; ++i) {
+        void *stack = cores[i].stack;
+        memset(&cores[i], 0, sizeof(cores[i]));
+        cores[i].stack = stack;
+    }
+    while (heap_len)
+        free(heap_pop());
+    memset(alarms, 0, sizeof(alarms));
+    current = SIM_MODEL;
+    event_now = 0;
+    stop_requested = false;
+}
+
+void sim_stop(void)
+{
+    stop_requested = true;
+}
+
+uint64_t sim_run(uint64_t until_ns)
+{
+    while (!stop_requested) {
+        int next_core = SIM_MODEL;
+        uint64_t core_t = SIM_NEVER;
+        for (int i = 0; i < SIM_NUM_CORES; ++i) {
+            uint64_t t = core_resume_time(&cores[i]);
+            if (t < core_t) {
+                core_t = t;
+                next_core = i;
+            }
+        }
+        sim_event_t *ev = heap_peek();
+
+        if (ev && ev->at <= core_t) {
+            if (ev->at > until_ns)
+                break;
+            heap_pop();
+            current = ev->core;
+            in_event = true;
+            event_now = ev->at;
+            if (current >= 0) {
+                // Interrupts wake a core sleeping in WFE
+                sim_core_t *c = &cores[current];
+                c->event_flag = true;
+                if (c->waiting) {
+                    c->waiting = false;
+                    if (c->now < ev->at)
+                        c->now = ev->at;
+                }
+            }
+            ev->fn(ev->arg);
+            in_event = false;
+            current = SIM_MODEL;
+            free(ev);
+            continue;
+        }
+
+        if (next_core == SIM_MODEL || core_t > until_ns)
+            break;
+
+        sim_core_t *c = &cores[next_core];
+        if (c->waiting) {
+            c->waiting = false;
+            c->now = c->wake_at;
+        }
+        current = next_core;
+        swapcontext(&sched_ctx, &c->ctx);
+        current = SIM_MODEL;
+    }
+    // A stop request ends the run at the time of the event that made it
+    if (!stop_requested)
+        event_now = until_ns;
+    return event_now;
+}
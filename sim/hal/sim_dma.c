@@ -0,0 +1,585 @@
+#include "sim.h"
+#include <string.h>
+
+/*
+ * DMA controller
+ * --------------
+ * The channel registers live in dma_hw so firmware can read them (e.g. a
+ * live transfer_count), but addresses are tracked as host pointers on the
+ * side: a 64-bit host cannot keep them in 32-bit registers. Pacing follows
+ * TREQ_SEL: DREQ_FORCE runs to completion at once, PIO and I2C channels move
+ * data when the peripheral model pushes/pulls or drains them, and PWM/timer
+ * paced channels tick on their own period.
+ *
+ * A channel writing a DMA address register (control blocks) moves a whole
+ * host pointer per transfer, so tables of `void *` behave as on the RP2040.
+ * Writing TRANS_COUNT sets the reload value, copied into the live counter
+ * each time the channel is triggered, so a chained restart runs full length.
+ */
+
+#define CTRL_EN_BITS          0x00000001u
+#define CTRL_DATA_SIZE_LSB    2
+#define CTRL_DATA_SIZE_BITS   0x0000000cu
+#define CTRL_INCR_READ_BITS   0x00000010u
+#define CTRL_INCR_WRITE_BITS  0x00000020u
+#define CTRL_RING_SIZE_LSB    6
+#define CTRL_RING_SIZE_BITS   0x000003c0u
+#define CTRL_RING_SEL_BITS    0x00000400u
+#define CTRL_CHAIN_TO_LSB     11
+#define CTRL_CHAIN_TO_BITS    0x00007800u
+#define CTRL_TREQ_SEL_LSB     15
+#define CTRL_TREQ_SEL_BITS    0x001f8000u
+#define CTRL_IRQ_QUIET_BITS   0x00200000u
+#define CTRL_BUSY_BITS        0x01000000u
+
+#define MIN_TICK_NS 1000 ///< Fastest simulated PWM/timer pacing; faster DREQs are slowed down to this
+
+static dma_hw_t dma_regs;
+dma_hw_t *dma_hw = &dma_regs;
+
+typedef struct
+{
+    bool claimed;
+    volatile uint8_t *read_ptr;
+    volatile uint8_t *write_ptr;
+    uint32_t ctrl;
+    uint32_t reload;        ///< Last TRANS_COUNT written, loaded into the counter on each trigger
+    sim_event_t *tick;
+} sim_dma_ch_t;
+
+static sim_dma_ch_t chans[NUM_DMA_CHANNELS];
+static bool timers_claimed[NUM_DMA_TIMERS];
+static uint16_t timer_num[NUM_DMA_TIMERS], timer_den[NUM_DMA_TIMERS];
+static uint32_t words_moved;
+
+static void trigger(uint ch);
+
+static inline uint ctrl_treq(uint32_t ctrl)
+{
+    return (ctrl & CTRL_TREQ_SEL_BITS) >> CTRL_TREQ_SEL_LSB;
+}
+
+static inline uint ctrl_size(uint32_t ctrl)
+{
+    return 1u << ((ctrl & CTRL_DATA_SIZE_BITS) >> CTRL_DATA_SIZE_LSB);
+}
+
+static inline bool is_busy(uint ch)
+{
+    return (dma_hw->ch[ch].ctrl_trig & CTRL_BUSY_BITS) != 0;
+}
+
+static void set_busy(uint ch, bool busy)
+{
+    chans[ch].ctrl = busy ? chans[ch].ctrl | CTRL_BUSY_BITS : chans[ch].ctrl & ~CTRL_BUSY_BITS;
+    dma_hw->ch[ch].ctrl_trig = chans[ch].ctrl;
+    dma_hw->ch[ch].al1_ctrl = chans[ch].ctrl;
+}
+
+static bool is_dma_addr_reg(volatile void *addr, uint *ch_out, size_t *off_out)
+{
+    uintptr_t a = (uintptr_t)addr, base = (uintptr_t)&dma_hw->ch[0];
+    if (a < base || a >= base + sizeof(dma_hw->ch))
+        return false;
+    *ch_out = (uint)((a - base) / sizeof(dma_channel_hw_t));
+    *off_out = (a - base) % sizeof(dma_channel_hw_t);
+    return true;
+}
+
+static volatile uint8_t *ring_step(volatile uint8_t *p, uint size, uint32_t ctrl, bool is_write)
+{
+    uint ring_bits = (ctrl & CTRL_RING_SIZE_BITS) >> CTRL_RING_SIZE_LSB;
+    bool ring_on_write = (ctrl & CTRL_RING_SEL_BITS) != 0;
+    uintptr_t next = (uintptr_t)p + size;
+    if (ring_bits && ring_on_write == is_write) {
+        uintptr_t mask = ((uintptr_t)1 << ring_bits) - 1;
+        next = ((uintptr_t)p & ~mask) | (next & mask);
+    }
+    return (volatile uint8_t *)next;
+}
+
+static bool is_addr_offset(size_t off)
+{
+    return off == offsetof(dma_channel_hw_t, read_addr) || off == offsetof(dma_channel_hw_t, write_addr) ||
+           off == offsetof(dma_channel_hw_t, al1_read_addr) || off == offsetof(dma_channel_hw_t, al1_write_addr) ||
+           off == offsetof(dma_channel_hw_t, al2_read_addr) || off == offsetof(dma_channel_hw_t, al2_write_addr_trig) ||
+           off == offsetof(dma_channel_hw_t, al3_write_addr) || off == offsetof(dma_channel_hw_t, al3_read_addr_trig);
+}
+
+/**
+ * @brief Store one element at the channel's write address.
+ *        Writes into DMA channel registers are decoded as control-block writes.
+ */
+static void store(sim_dma_ch_t *c, const void *src, uint size)
+{
+    uint target;
+    size_t off;
+    if (is_dma_addr_reg(c->write_ptr, &target, &off)) {
+        const void *ptr = *(const void *const *)src;
+        uint32_t value;
+        memcpy(&value, src, sizeof(value));
+        switch (off) {
+        case offsetof(dma_channel_hw_t, read_addr):
+        case offsetof(dma_channel_hw_t, al1_read_addr):
+        case offsetof(dma_channel_hw_t, al2_read_addr):
+            chans[target].read_ptr = (volatile uint8_t *)ptr;
+            break;
+        case offsetof(dma_channel_hw_t, al3_read_addr_trig):
+            chans[target].read_ptr = (volatile uint8_t *)ptr;
+            if (ptr)
+                trigger(target);
+            break;
+        case offsetof(dma_channel_hw_t, write_addr):
+        case offsetof(dma_channel_hw_t, al1_write_addr):
+        case offsetof(dma_channel_hw_t, al3_write_addr):
+            chans[target].write_ptr = (volatile uint8_t *)ptr;
+            break;
+        case offsetof(dma_channel_hw_t, al2_write_addr_trig):
+            chans[target].write_ptr = (volatile uint8_t *)ptr;
+            if (ptr)
+                trigger(target);
+            break;
+        case offsetof(dma_channel_hw_t, transfer_count):
+        case offsetof(dma_channel_hw_t, al2_transfer_count):
+        case offsetof(dma_channel_hw_t, al3_transfer_count):
+            chans[target].reload = value;
+            break;
+        case offsetof(dma_channel_hw_t, al1_transfer_count_trig):
+            chans[target].reload = value;
+            if (value)
+                trigger(target);
+            break;
+        default:
+            sim_panic("DMA write to unsupported channel register offset %zu", off);
+        }
+        return;
+    }
+    memcpy((void *)c->write_ptr, src, size);
+    sim_reg_written(c->write_ptr);
+}
+
+/**
+ * @brief Perform one element transfer on a busy channel.
+ * @param in Word supplied by a peripheral (NULL: read from read_ptr).
+ * @param out Word taken by a peripheral (NULL: store to write_ptr).
+ */
+static void transfer_one(uint ch, const uint32_t *in, uint32_t *out)
+{
+    sim_dma_ch_t *c = &chans[ch];
+    uint size = ctrl_size(c->ctrl);
+    uint target;
+    size_t off;
+    bool ptr_mode = !out && size == 4 && is_dma_addr_reg(c->write_ptr, &target, &off) && is_addr_offset(off);
+    uint step = ptr_mode ? sizeof(void *) : size;
+    uint8_t buf[sizeof(void *) > 4 ? sizeof(void *) : 4] = {0};
+
+    if (in)
+        memcpy(buf, in, size);
+    else
+        memcpy(buf, (const void *)c->read_ptr, step);
+
+    if (out) {
+        uint32_t w = 0;
+        memcpy(&w, buf, size);
+        *out = w;
+    } else {
+        store(c, buf, size);
+    }
+
+    if (c->ctrl & CTRL_INCR_READ_BITS)
+        c->read_ptr = ring_step(c->read_ptr, step, c->ctrl, false);
+    if (c->ctrl & CTRL_INCR_WRITE_BITS)
+        c->write_ptr = ring_step(c->write_ptr, size, c->ctrl, true);
+    dma_hw->ch[ch].read_addr = (uint32_t)(uintptr_t)c->read_ptr;
+    dma_hw->ch[ch].write_addr = (uint32_t)(uintptr_t)c->write_ptr;
+    words_moved++;
+
+    if (--dma_hw->ch[ch].transfer_count == 0)
+        sim_dma_complete(ch);
+}
+
+void sim_dma_complete(uint ch)
+{
+    sim_dma_ch_t *c = &chans[ch];
+    sim_cancel(c->tick);
+    c->tick = NULL;
+    dma_hw->ch[ch].transfer_count = 0;
+    set_busy(ch, false);
+
+    if (!(c->ctrl & CTRL_IRQ_QUIET_BITS)) {
+        dma_hw->intr |= 1u << ch;
+        dma_hw->ints0 = dma_hw->intr & dma_hw->inte0;
+        dma_hw->ints1 = dma_hw->intr & dma_hw->inte1;
+        if (dma_hw->inte0 & (1u << ch))
+            sim_irq_raise(DMA_IRQ_0);
+        if (dma_hw->inte1 & (1u << ch))
+            sim_irq_raise(DMA_IRQ_1);
+    }
+
+    uint chain = (c->ctrl & CTRL_CHAIN_TO_BITS) >> CTRL_CHAIN_TO_LSB;
+    if (chain != ch)
+        trigger(chain);
+}
+
+static uint64_t tick_period_ns(uint treq)
+{
+    uint64_t ns = 0;
+    if (treq >= DREQ_PWM_WRAP0 && treq < DREQ_PWM_WRAP0 + NUM_PWM_SLICES) {
+        double hz = sim_pwm_freq_hz(treq - DREQ_PWM_WRAP0);
+        ns = hz > 0 ? (uint64_t)(1e9 / hz) : SIM_NEVER;
+    } else if (treq >= DREQ_DMA_TIMER0 && treq < DREQ_DMA_TIMER0 + NUM_DMA_TIMERS) {
+        uint t = treq - DREQ_DMA_TIMER0;
+        double hz = timer_den[t] ? (double)clock_get_hz(clk_sys) * timer_num[t] / timer_den[t] : 0;
+        ns = hz > 0 ? (uint64_t)(1e9 / hz) : SIM_NEVER;
+    }
+    return ns < MIN_TICK_NS ? MIN_TICK_NS : ns;
+}
+
+static void tick_event(void *arg)
+{
+    uint ch = (uint)(uintptr_t)arg;
+    sim_dma_ch_t *c = &chans[ch];
+    c->tick = NULL;
+    if (!is_busy(ch))
+        return;
+    uint64_t period = tick_period_ns(ctrl_treq(c->ctrl));
+    if (period != SIM_NEVER)
+        c->tick = sim_schedule(sim_now_ns() + period, SIM_MODEL, tick_event, arg);
+    transfer_one(ch, NULL, NULL);
+}
+
+static void trigger(uint ch)
+{
+    sim_dma_ch_t *c = &chans[ch];
+    if (!(c->ctrl & CTRL_EN_BITS))
+        return;
+    dma_hw->ch[ch].transfer_count = c->reload;
+    if (dma_hw->ch[ch].transfer_count == 0) {
+        // Zero-length run: completes immediately
+        set_busy(ch, true);
+        sim_dma_complete(ch);
+        return;
+    }
+    set_busy(ch, true);
+
+    uint treq = ctrl_treq(c->ctrl);
+    if (treq == DREQ_I2C0_TX || treq == DREQ_I2C0_TX + 2) {
+        sim_i2c_dma_start(ch);
+    } else if (treq >= DREQ_PWM_WRAP0 && treq < DREQ_PWM_WRAP0 + NUM_PWM_SLICES) {
+        // At once if the wrap DREQ is still raised, else on the next wrap
+        uint64_t at = sim_pwm_dreq_ns(treq - DREQ_PWM_WRAP0);
+        sim_cancel(c->tick);
+        c->tick = at == SIM_NEVER ? NULL : sim_schedule(at, SIM_MODEL, tick_event, (void *)(uintptr_t)ch);
+    } else if (treq >= DREQ_DMA_TIMER0 && treq < DREQ_DMA_TIMER0 + NUM_DMA_TIMERS) {
+        sim_cancel(c->tick);
+        c->tick = sim_schedule(sim_now_ns(), SIM_MODEL, tick_event, (void *)(uintptr_t)ch);
+    } else if (treq < DREQ_PWM_WRAP0) {
+        // PIO FIFOs: the state machine model moves the data
+    } else {
+        while (is_busy(ch) && dma_hw->ch[ch].transfer_count)
+            transfer_one(ch, NULL, NULL);
+    }
+}
+
+/* ---- model interface ---- */
+
+void sim_dma_reset(void)
+{
+    memset(&dma_regs, 0, sizeof(dma_regs));
+    memset(chans, 0, sizeof(chans));
+    memset(timers_claimed, 0, sizeof(timers_claimed));
+    words_moved = 0;
+}
+
+bool sim_dma_dreq_push(uint dreq, uint32_t word)
+{
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (is_busy(ch) && ctrl_treq(chans[ch].ctrl) == dreq) {
+            transfer_one(ch, &word, NULL);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool sim_dma_dreq_pull(uint dreq, uint32_t *word)
+{
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (is_busy(ch) && ctrl_treq(chans[ch].ctrl) == dreq) {
+            transfer_one(ch, NULL, word);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Copy the next @p count elements of a busy channel out, as a paced
+ *        peripheral (e.g. the I2C TX FIFO) would consume them.
+ */
+size_t sim_dma_drain(uint ch, uint32_t *out, size_t count)
+{
+    size_t n = 0;
+    while (n < count && is_busy(ch) && dma_hw->ch[ch].transfer_count) {
+        uint32_t w;
+        transfer_one(ch, NULL, &w);
+        out[n++] = w;
+    }
+    return n;
+}
+
+void sim_dma_reg_written(volatile void *addr)
+{
+    uint ch;
+    size_t off;
+    if (!is_dma_addr_reg(addr, &ch, &off))
+        return;
+    if (off == offsetof(dma_channel_hw_t, ctrl_trig) || off == offsetof(dma_channel_hw_t, al1_ctrl)) {
+        chans[ch].ctrl = (dma_hw->ch[ch].ctrl_trig & ~CTRL_BUSY_BITS) | (chans[ch].ctrl & CTRL_BUSY_BITS);
+        if (!(chans[ch].ctrl & CTRL_EN_BITS) && is_busy(ch))
+            set_busy(ch, false); // disabling pauses the channel
+    }
+}
+
+uint32_t sim_dma_transfer_words(void)
+{
+    return words_moved;
+}
+
+/* ---- SDK API ---- */
+
+int dma_claim_unused_channel(bool required)
+{
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (!chans[ch].claimed) {
+            chans[ch].claimed = true;
+            return (int)ch;
+        }
+    }
+    if (required)
+        sim_panic("no DMA channels available");
+    return -1;
+}
+
+void dma_channel_claim(uint channel)
+{
+    if (chans[channel].claimed)
+        sim_panic("DMA channel %u already claimed", channel);
+    chans[channel].claimed = true;
+}
+
+void dma_channel_unclaim(uint channel)
+{
+    chans[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    dma_channel_config c = {0};
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, DREQ_FORCE);
+    channel_config_set_chain_to(&c, channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_ring(&c, false, 0);
+    channel_config_set_irq_quiet(&c, false);
+    channel_config_set_enable(&c, true);
+    return c;
+}
+
+static void set_field(uint32_t *ctrl, uint32_t mask, uint lsb, uint32_t value)
+{
+    *ctrl = (*ctrl & ~mask) | ((value << lsb) & mask);
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    set_field(&c->ctrl, CTRL_INCR_READ_BITS, 4, incr);
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    set_field(&c->ctrl, CTRL_INCR_WRITE_BITS, 5, incr);
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+    set_field(&c->ctrl, CTRL_TREQ_SEL_BITS, CTRL_TREQ_SEL_LSB, dreq);
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to)
+{
+    set_field(&c->ctrl, CTRL_CHAIN_TO_BITS, CTRL_CHAIN_TO_LSB, chain_to);
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    set_field(&c->ctrl, CTRL_DATA_SIZE_BITS, CTRL_DATA_SIZE_LSB, size);
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits)
+{
+    set_field(&c->ctrl, CTRL_RING_SIZE_BITS, CTRL_RING_SIZE_LSB, size_bits);
+    set_field(&c->ctrl, CTRL_RING_SEL_BITS, 10, write);
+}
+
+void channel_config_set_irq_quiet(dma_channel_config *c, bool irq_quiet)
+{
+    set_field(&c->ctrl, CTRL_IRQ_QUIET_BITS, 21, irq_quiet);
+}
+
+void channel_config_set_enable(dma_channel_config *c, bool enable)
+{
+    set_field(&c->ctrl, CTRL_EN_BITS, 0, enable);
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger_now)
+{
+    chans[channel].ctrl = (config->ctrl & ~CTRL_BUSY_BITS) | (chans[channel].ctrl & CTRL_BUSY_BITS);
+    dma_hw->ch[channel].al1_ctrl = chans[channel].ctrl;
+    dma_hw->ch[channel].ctrl_trig = chans[channel].ctrl;
+    if (trigger_now)
+        trigger(channel);
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger_now)
+{
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, false);
+    dma_channel_set_config(channel, config, trigger_now);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger_now)
+{
+    chans[channel].read_ptr = (volatile uint8_t *)read_addr;
+    dma_hw->ch[channel].read_addr = (uint32_t)(uintptr_t)read_addr;
+    if (trigger_now)
+        trigger(channel);
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger_now)
+{
+    chans[channel].write_ptr = (volatile uint8_t *)write_addr;
+    dma_hw->ch[channel].write_addr = (uint32_t)(uintptr_t)write_addr;
+    if (trigger_now)
+        trigger(channel);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger_now)
+{
+    chans[channel].reload = trans_count;
+    if (trigger_now)
+        trigger(channel);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count)
+{
+    dma_channel_set_trans_count(channel, transfer_count, false);
+    dma_channel_set_read_addr(channel, read_addr, true);
+}
+
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void *write_addr, uint32_t transfer_count)
+{
+    dma_channel_set_trans_count(channel, transfer_count, false);
+    dma_channel_set_write_addr(channel, write_addr, true);
+}
+
+void dma_channel_start(uint channel)
+{
+    trigger(channel);
+}
+
+void dma_start_channel_mask(uint32_t chan_mask)
+{
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (chan_mask & (1u << ch))
+            trigger(ch);
+    }
+}
+
+void dma_channel_abort(uint channel)
+{
+    sim_cancel(chans[channel].tick);
+    chans[channel].tick = NULL;
+    set_busy(channel, false);
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+    sim_advance_ns(8);
+    return is_busy(channel);
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+    while (dma_channel_is_busy(channel))
+        tight_loop_contents();
+}
+
+static void update_ints(void)
+{
+    dma_hw->ints0 = dma_hw->intr & dma_hw->inte0;
+    dma_hw->ints1 = dma_hw->intr & dma_hw->inte1;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled)
+{
+    if (enabled)
+        dma_hw->inte0 |= 1u << channel;
+    else
+        dma_hw->inte0 &= ~(1u << channel);
+    update_ints();
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled)
+{
+    if (enabled)
+        dma_hw->inte1 |= 1u << channel;
+    else
+        dma_hw->inte1 &= ~(1u << channel);
+    update_ints();
+}
+
+bool dma_channel_get_irq0_status(uint channel)
+{
+    return (dma_hw->ints0 & (1u << channel)) != 0;
+}
+
+bool dma_channel_get_irq1_status(uint channel)
+{
+    return (dma_hw->ints1 & (1u << channel)) != 0;
+}
+
+void dma_channel_acknowledge_irq0(uint channel)
+{
+    dma_hw->intr &= ~(1u << channel);
+    update_ints();
+}
+
+void dma_channel_acknowledge_irq1(uint channel)
+{
+    dma_hw->intr &= ~(1u << channel);
+    update_ints();
+}
+
+int dma_claim_unused_timer(bool required)
+{
+    for (uint t = 0; t < NUM_DMA_TIMERS; ++t) {
+        if (!timers_claimed[t]) {
+            timers_claimed[t] = true;
+            return (int)t;
+        }
+    }
+    if (required)
+        sim_panic("no DMA timers available");
+    return -1;
+}
+
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator)
+{
+    timer_num[timer] = numerator;
+    timer_den[timer] = denominator;
+    dma_hw->timer[timer] = (uint32_t)numerator << 16 | denominator;
+}
@@ -0,0 +1,166 @@
+#include "sim.h"
+#include <string.h>
+
+/*
+ * QSPI flash
+ * ----------
+ * The whole 2 MB image is a host array that XIP_BASE points at, so the
+ * firmware reads flash through plain pointers as it does on the RP2040.
+ * Program/erase enforce NOR rules (alignment, programming only clears bits)
+ * and charge datasheet-typical times. flash_safe_execute() goes through
+ * get_flash_safety_helper() like the SDK: the default one parks the other
+ * core for the duration and refuses to run while core 1 is up but has not
+ * called flash_safe_execute_core_init(). While an erase or program is in
+ * progress, the other core calling into the SDK's flash-resident timing
+ * functions is a panic (sim_flash_xip_check()).
+ */
+
+#define SECTOR_ERASE_NS (45 * SIM_NS_PER_MS)
+#define PAGE_PROGRAM_NS (700 * SIM_NS_PER_US)
+
+uint8_t sim_flash_image[PICO_FLASH_SIZE_BYTES];
+
+static sim_flash_stats_t stats;
+static bool lockout_ready[SIM_NUM_CORES];
+static bool in_safe_zone = false;
+static bool xip_off = false;     ///< Erase/program in progress: flash cannot be read
+static int xip_writer;
+
+void sim_flash_reset(void)
+{
+    memset(sim_flash_image, 0xFF, sizeof(sim_flash_image));
+    memset(&stats, 0, sizeof(stats));
+    memset(lockout_ready, 0, sizeof(lockout_ready));
+}
+
+bool sim_flash_load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    size_t n = fread(sim_flash_image, 1, sizeof(sim_flash_image), f);
+    fclose(f);
+    return n == sizeof(sim_flash_image);
+}
+
+bool sim_flash_save(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return false;
+    size_t n = fwrite(sim_flash_image, 1, sizeof(sim_flash_image), f);
+    fclose(f);
+    return n == sizeof(sim_flash_image);
+}
+
+const sim_flash_stats_t *sim_flash_stats(void)
+{
+    return &stats;
+}
+
+static void require_safe(const char *what)
+{
+    if (!in_safe_zone && sim_core_launched(1))
+        sim_panic("%s while core 1 runs outside flash_safe_execute()", what);
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    require_safe("flash_range_erase");
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+        sim_panic("flash_range_erase(0x%x, %zu): not sector aligned", flash_offs, count);
+    memset(&sim_flash_image[flash_offs], 0xFF, count);
+    stats.erases += count / FLASH_SECTOR_SIZE;
+    stats.stall_ns += SECTOR_ERASE_NS * (count / FLASH_SECTOR_SIZE);
+    xip_off = true;
+    xip_writer = sim_current_core();
+    sim_advance_ns(SECTOR_ERASE_NS * (count / FLASH_SECTOR_SIZE));
+    xip_off = false;
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    require_safe("flash_range_program");
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+        sim_panic("flash_range_program(0x%x, %zu): not page aligned", flash_offs, count);
+    for (size_t i = 0; i < count; ++i)
+        sim_flash_image[flash_offs + i] &= data[i]; // NOR: programming only clears bits
+    stats.programs += count / FLASH_PAGE_SIZE;
+    stats.stall_ns += PAGE_PROGRAM_NS * (count / FLASH_PAGE_SIZE);
+    xip_off = true;
+    xip_writer = sim_current_core();
+    sim_advance_ns(PAGE_PROGRAM_NS * (count / FLASH_PAGE_SIZE));
+    xip_off = false;
+}
+
+/* Default helper, as the SDK's: the other core spins in a RAM lockout loop for the whole call */
+
+static bool lockout_core_init_deinit(bool init)
+{
+    lockout_ready[get_core_num()] = init;
+    return true;
+}
+
+static uint32_t lockout_irq;
+
+static int lockout_enter(uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    uint other = get_core_num() ^ 1;
+    if (sim_core_launched((int)other) && !lockout_ready[other])
+        return PICO_ERROR_NOT_PERMITTED;
+    lockout_irq = save_and_disable_interrupts();
+    sim_core_park((int)other, true);
+    return PICO_OK;
+}
+
+static int lockout_exit(uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    sim_core_park((int)(get_core_num() ^ 1), false);
+    restore_interrupts(lockout_irq);
+    return PICO_OK;
+}
+
+static flash_safety_helper_t lockout_helper = {
+    .core_init_deinit = lockout_core_init_deinit,
+    .enter_safe_zone_timeout_ms = lockout_enter,
+    .exit_safe_zone_timeout_ms = lockout_exit,
+};
+
+__attribute__((weak)) flash_safety_helper_t *get_flash_safety_helper(void)
+{
+    return &lockout_helper;
+}
+
+bool flash_safe_execute_core_init(void)
+{
+    return get_flash_safety_helper()->core_init_deinit(true);
+}
+
+bool flash_safe_execute_core_deinit(void)
+{
+    return get_flash_safety_helper()->core_init_deinit(false);
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms)
+{
+    flash_safety_helper_t *helper = get_flash_safety_helper();
+    int rc = helper->enter_safe_zone_timeout_ms(enter_exit_timeout_ms);
+    if (rc != PICO_OK)
+        return rc;
+
+    in_safe_zone = true;
+    func(param);
+    in_safe_zone = false;
+    rc = helper->exit_safe_zone_timeout_ms(enter_exit_timeout_ms);
+    stats.safe_executes++;
+    return rc;
+}
+
+void sim_flash_xip_check(const char *what)
+{
+    int core = sim_current_core();
+    if (xip_off && core >= 0 && core != xip_writer)
+        sim_panic("core %d called %s (in flash) during a flash write", core, what);
+}
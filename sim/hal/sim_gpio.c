@@ -0,0 +1,302 @@
+#include "sim.h"
+#include <string.h>
+
+/*
+ * GPIO bank 0
+ * -----------
+ * A pin's level is, in order of precedence: the SIO output when the
+ * firmware drives it, the PIO output when a state machine drives it, the
+ * external (model) driver, then the pull resistor. Every level change is
+ * reported to model watchers synchronously and to the per-core GPIO IRQ
+ * callback as an event.
+ */
+
+#define MAX_WATCHERS 48
+
+typedef struct
+{
+    enum gpio_function fn;
+    bool sio_oe, sio_out;
+    bool pio_oe, pio_out;
+    int ext;              ///< -1 when nothing external drives the pin
+    bool pull_up, pull_down;
+    bool level;
+    uint32_t irq_mask[SIM_NUM_CORES];
+    uint32_t irq_events[SIM_NUM_CORES];
+} sim_pin_t;
+
+typedef struct
+{
+    uint pin;
+    sim_pin_watch_fn fn;
+    void *arg;
+} sim_watch_t;
+
+static sim_pin_t pins[NUM_BANK0_GPIOS];
+static sim_watch_t watchers[MAX_WATCHERS];
+static int watcher_count;
+static gpio_irq_callback_t irq_callbacks[SIM_NUM_CORES];
+static irq_handler_t raw_handlers[SIM_NUM_CORES][NUM_BANK0_GPIOS];
+
+static int this_core(void)
+{
+    int c = sim_current_core();
+    return c < 0 ? 0 : c;
+}
+
+static bool resolve(const sim_pin_t *p)
+{
+    if (p->fn == GPIO_FUNC_SIO && p->sio_oe)
+        return p->sio_out;
+    if ((p->fn == GPIO_FUNC_PIO0 || p->fn == GPIO_FUNC_PIO1) && p->pio_oe)
+        return p->pio_out;
+    if (p->ext >= 0)
+        return p->ext != 0;
+    if (p->pull_up)
+        return true;
+    return false;
+}
+
+static void gpio_irq_event(void *arg)
+{
+    uint pin = (uint)(uintptr_t)arg;
+    int core = this_core();
+    sim_pin_t *p = &pins[pin];
+    uint32_t events = p->irq_events[core];
+    if (!events)
+        return;
+    if (!irq_is_enabled(IO_IRQ_BANK0))
+        return;
+    if (raw_handlers[core][pin]) {
+        raw_handlers[core][pin]();
+    } else if (irq_callbacks[core]) {
+        p->irq_events[core] = 0;
+        irq_callbacks[core](pin, events);
+    }
+}
+
+static void update(uint pin)
+{
+    sim_pin_t *p = &pins[pin];
+    bool level = resolve(p);
+    if (level == p->level)
+        return;
+    p->level = level;
+
+    for (int i = 0; i < watcher_count; ++i) {
+        if (watchers[i].pin == pin)
+            watchers[i].fn(pin, level, watchers[i].arg);
+    }
+
+    uint32_t edge = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    for (int core = 0; core < SIM_NUM_CORES; ++core) {
+        if (p->irq_mask[core] & edge) {
+            bool already = p->irq_events[core] != 0;
+            p->irq_events[core] |= edge;
+            if (!already)
+                sim_schedule(sim_now_ns(), core, gpio_irq_event, (void *)(uintptr_t)pin);
+        }
+    }
+}
+
+void sim_gpio_reset(void)
+{
+    memset(pins, 0, sizeof(pins));
+    for (uint i = 0; i < NUM_BANK0_GPIOS; ++i) {
+        pins[i].fn = GPIO_FUNC_NULL;
+        pins[i].ext = -1;
+        pins[i].pull_down = true; // RP2040 reset state
+    }
+    watcher_count = 0;
+    memset(irq_callbacks, 0, sizeof(irq_callbacks));
+    memset(raw_handlers, 0, sizeof(raw_handlers));
+}
+
+void sim_gpio_drive(uint pin, int level)
+{
+    pins[pin].ext = level < 0 ? -1 : (level != 0);
+    update(pin);
+}
+
+bool sim_gpio_level(uint pin)
+{
+    return pins[pin].level;
+}
+
+bool sim_gpio_is_output(uint pin)
+{
+    const sim_pin_t *p = &pins[pin];
+    return (p->fn == GPIO_FUNC_SIO && p->sio_oe) || ((p->fn == GPIO_FUNC_PIO0 || p->fn == GPIO_FUNC_PIO1) && p->pio_oe);
+}
+
+void sim_gpio_watch(uint pin, sim_pin_watch_fn fn, void *arg)
+{
+    if (watcher_count == MAX_WATCHERS)
+        sim_panic("too many pin watchers");
+    watchers[watcher_count++] = (sim_watch_t){pin, fn, arg};
+}
+
+void sim_gpio_pio_drive(uint pin, bool oe, bool level)
+{
+    pins[pin].pio_oe = oe;
+    pins[pin].pio_out = level;
+    update(pin);
+}
+
+/* ---- SDK API ---- */
+
+void gpio_init(uint gpio)
+{
+    sim_pin_t *p = &pins[gpio];
+    p->sio_oe = false;
+    p->sio_out = false;
+    p->fn = GPIO_FUNC_SIO;
+    update(gpio);
+}
+
+void gpio_deinit(uint gpio)
+{
+    pins[gpio].fn = GPIO_FUNC_NULL;
+    update(gpio);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+    pins[gpio].fn = fn;
+    update(gpio);
+}
+
+enum gpio_function gpio_get_function(uint gpio)
+{
+    return pins[gpio].fn;
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    pins[gpio].sio_oe = out;
+    update(gpio);
+}
+
+bool gpio_get_dir(uint gpio)
+{
+    return pins[gpio].sio_oe;
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    sim_advance_ns(8);
+    pins[gpio].sio_out = value;
+    update(gpio);
+}
+
+bool gpio_get(uint gpio)
+{
+    sim_advance_ns(8);
+    return pins[gpio].level;
+}
+
+uint32_t gpio_get_all(void)
+{
+    sim_advance_ns(8);
+    uint32_t all = 0;
+    for (uint i = 0; i < NUM_BANK0_GPIOS; ++i)
+        all |= (uint32_t)pins[i].level << i;
+    return all;
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value)
+{
+    sim_advance_ns(8);
+    for (uint i = 0; i < NUM_BANK0_GPIOS; ++i) {
+        if (mask & (1u << i)) {
+            pins[i].sio_out = (value >> i) & 1;
+            update(i);
+        }
+    }
+}
+
+void gpio_set_dir_masked(uint32_t mask, uint32_t value)
+{
+    for (uint i = 0; i < NUM_BANK0_GPIOS; ++i) {
+        if (mask & (1u << i)) {
+            pins[i].sio_oe = (value >> i) & 1;
+            update(i);
+        }
+    }
+}
+
+void gpio_pull_up(uint gpio)
+{
+    pins[gpio].pull_up = true;
+    pins[gpio].pull_down = false;
+    update(gpio);
+}
+
+void gpio_pull_down(uint gpio)
+{
+    pins[gpio].pull_up = false;
+    pins[gpio].pull_down = true;
+    update(gpio);
+}
+
+void gpio_disable_pulls(uint gpio)
+{
+    pins[gpio].pull_up = false;
+    pins[gpio].pull_down = false;
+    update(gpio);
+}
+
+void gpio_set_input_enabled(uint gpio, bool enabled)
+{
+    (void)gpio;
+    (void)enabled;
+}
+
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive)
+{
+    (void)gpio;
+    (void)drive;
+}
+
+void gpio_set_slew_rate(uint gpio, enum gpio_slew_rate slew)
+{
+    (void)gpio;
+    (void)slew;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled)
+{
+    int core = this_core();
+    if (enabled)
+        pins[gpio].irq_mask[core] |= event_mask;
+    else
+        pins[gpio].irq_mask[core] &= ~event_mask;
+}
+
+void gpio_set_irq_callback(gpio_irq_callback_t callback)
+{
+    irq_callbacks[this_core()] = callback;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback)
+{
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+    gpio_set_irq_callback(callback);
+    if (enabled)
+        irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler)
+{
+    raw_handlers[this_core()][gpio] = handler;
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask)
+{
+    pins[gpio].irq_events[this_core()] &= ~event_mask;
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio)
+{
+    return pins[gpio].irq_events[this_core()];
+}
@@ -0,0 +1,203 @@
+#include "sim.h"
+#include <string.h>
+
+/*
+ * I2C controller (master only)
+ * ----------------------------
+ * Devices attach by 7-bit address and receive each transaction's bytes when
+ * its STOP is sent. Bus time is 9 clocks per byte plus start/stop. Blocking
+ * writes charge that time to the calling core; DMA-fed IC_DATA_CMD streams
+ * take it in the background: the DMA finishes once the last word is in the
+ * 16-deep TX FIFO, and the controller reports ACTIVITY until the FIFO drains.
+ */
+
+#define MAX_DEVICES     4
+#define TX_FIFO_DEPTH   16
+#define MAX_TRANSACTION 2048
+
+typedef struct
+{
+    uint8_t addr;
+    sim_i2c_rx_fn fn;
+    void *arg;
+} sim_i2c_dev_t;
+
+static i2c_hw_t i2c_regs[2];
+i2c_inst_t i2c0_inst = {&i2c_regs[0], false};
+i2c_inst_t i2c1_inst = {&i2c_regs[1], false};
+
+static uint baud[2];
+static sim_i2c_dev_t devices[MAX_DEVICES];
+static int device_count;
+static uint32_t bytes_on_bus;
+static uint32_t naks;
+
+static uint index_of(i2c_hw_t *hw)
+{
+    return hw == &i2c_regs[1] ? 1 : 0;
+}
+
+static uint64_t byte_ns(uint bus)
+{
+    return baud[bus] ? 9ull * 1000000000ull / baud[bus] : 0;
+}
+
+static uint64_t transaction_ns(uint bus, size_t len)
+{
+    // START + address + data + STOP
+    return (1 + len) * byte_ns(bus) + 2 * byte_ns(bus) / 9;
+}
+
+static sim_i2c_dev_t *find_device(uint8_t addr)
+{
+    for (int i = 0; i < device_count; ++i) {
+        if (devices[i].addr == addr)
+            return &devices[i];
+    }
+    return NULL;
+}
+
+static bool deliver(uint8_t addr, const uint8_t *bytes, size_t len)
+{
+    sim_i2c_dev_t *dev = find_device(addr);
+    if (!dev) {
+        naks++;
+        return false;
+    }
+    bytes_on_bus += len + 1;
+    dev->fn(bytes, len, dev->arg);
+    return true;
+}
+
+void sim_i2c_attach(uint8_t addr, sim_i2c_rx_fn fn, void *arg)
+{
+    if (device_count == MAX_DEVICES)
+        sim_panic("too many I2C devices");
+    devices[device_count++] = (sim_i2c_dev_t){addr, fn, arg};
+}
+
+uint32_t sim_i2c_bytes(void)
+{
+    return bytes_on_bus;
+}
+
+/* ---- DMA streams ---- */
+
+typedef struct
+{
+    uint ch;
+    uint bus;
+} i2c_stream_t;
+
+static i2c_stream_t streams[2];
+
+static void bus_idle_event(void *arg)
+{
+    i2c_hw_t *hw = arg;
+    hw->status = I2C_IC_STATUS_TFE_BITS | I2C_IC_STATUS_TFNF_BITS;
+    hw->txflr = 0;
+}
+
+/**
+ * @brief The DMA has pushed its last word into the TX FIFO: hand the
+ *        transactions to the devices and complete the channel.
+ */
+static void stream_dma_done_event(void *arg)
+{
+    i2c_stream_t *s = arg;
+    i2c_hw_t *hw = &i2c_regs[s->bus];
+    uint8_t addr = hw->tar & 0x7F;
+    static uint8_t buf[MAX_TRANSACTION];
+    size_t len = 0;
+    uint32_t word;
+
+    while (sim_dma_drain(s->ch, &word, 1)) {
+        if (len < MAX_TRANSACTION)
+            buf[len++] = word & 0xFF;
+        if (word & I2C_IC_DATA_CMD_STOP_BITS) {
+            deliver(addr, buf, len);
+            len = 0;
+        }
+    }
+    if (len)
+        deliver(addr, buf, len); // no STOP: bus left held, still delivered for inspection
+}
+
+void sim_i2c_dma_start(uint ch)
+{
+    // Find which controller the channel feeds from its DREQ
+    uint treq = (dma_hw->ch[ch].ctrl_trig >> 15) & 0x3F;
+    uint bus = treq == DREQ_I2C0_TX ? 0 : 1;
+    i2c_hw_t *hw = &i2c_regs[bus];
+    uint32_t words = dma_hw->ch[ch].transfer_count;
+
+    if (!(hw->enable & 1) || !(hw->dma_cr & I2C_IC_DMA_CR_TDMAE_BITS))
+        return; // DREQ never asserts: the channel stalls, as on hardware
+
+    // Walk the stream for transaction boundaries to cost the bus time
+    uint64_t ns = 0;
+    bool present = find_device(hw->tar & 0x7F) != NULL;
+    if (present) {
+        // Conservative: every word is one byte, each STOP adds an address byte and start/stop
+        ns = transaction_ns(bus, words);
+    } else {
+        // NAK on the address byte: the controller flushes the FIFO as fast as the DMA fills it
+        ns = byte_ns(bus) + words * 10;
+    }
+    uint64_t fifo_ns = present ? (words < TX_FIFO_DEPTH ? words : TX_FIFO_DEPTH) * byte_ns(bus) : 0;
+
+    hw->status = I2C_IC_STATUS_ACTIVITY_BITS | I2C_IC_STATUS_TFNF_BITS;
+    hw->txflr = words < TX_FIFO_DEPTH ? words : TX_FIFO_DEPTH;
+    streams[bus] = (i2c_stream_t){ch, bus};
+    uint64_t now = sim_now_ns();
+    sim_schedule(now + ns - fifo_ns, SIM_MODEL, stream_dma_done_event, &streams[bus]);
+    sim_schedule(now + ns, SIM_MODEL, bus_idle_event, hw);
+}
+
+/* ---- SDK API ---- */
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c_hw_t *hw = i2c->hw;
+    memset(hw, 0, sizeof(*hw));
+    hw->tar = 0x055;
+    hw->status = I2C_IC_STATUS_TFE_BITS | I2C_IC_STATUS_TFNF_BITS;
+    hw->enable = 1;
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+void i2c_deinit(i2c_inst_t *i2c)
+{
+    i2c->hw->enable = 0;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+    baud[index_of(i2c->hw)] = baudrate;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)nostop;
+    uint bus = index_of(i2c->hw);
+    if (!find_device(addr)) {
+        sim_advance_ns(byte_ns(bus));
+        naks++;
+        return PICO_ERROR_GENERIC;
+    }
+    sim_advance_ns(transaction_ns(bus, len));
+    deliver(addr, src, len);
+    return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+    (void)nostop;
+    uint bus = index_of(i2c->hw);
+    sim_advance_ns(transaction_ns(bus, len));
+    if (!find_device(addr))
+        return PICO_ERROR_GENERIC;
+    memset(dst, 0, len);
+    return (int)len;
+}
@@ -0,0 +1,88 @@
+#include "sim.h"
+#include <stdio.h>
+
+/*
+ * Register write dispatch, stdio, watchdog and spin locks.
+ */
+
+static spin_lock_t spin_locks[32];
+static uint32_t spin_locks_claimed;
+
+void sim_reg_written(volatile void *addr)
+{
+    sim_clocks_reg_written(addr);
+    sim_dma_reg_written(addr);
+    sim_pwm_reg_written(addr);
+}
+
+bool stdio_init_all(void)
+{
+    return true;
+}
+
+bool stdio_usb_connected(void)
+{
+    // USB only enumerates while clk_usb runs at 48 MHz
+    return clock_get_hz(clk_usb) == 48000000u;
+}
+
+int getchar_timeout_us(uint32_t timeout_us)
+{
+    if (timeout_us)
+        sleep_us(timeout_us);
+    return PICO_ERROR_TIMEOUT;
+}
+
+void stdio_flush(void)
+{
+    fflush(stdout);
+}
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug)
+{
+    (void)delay_ms;
+    (void)pause_on_debug;
+}
+
+void watchdog_update(void)
+{
+}
+
+bool watchdog_caused_reboot(void)
+{
+    return false;
+}
+
+int spin_lock_claim_unused(bool required)
+{
+    for (uint i = 16; i < 32; ++i) {
+        if (!(spin_locks_claimed & (1u << i))) {
+            spin_locks_claimed |= 1u << i;
+            return (int)i;
+        }
+    }
+    if (required)
+        sim_panic("no spin locks available");
+    return -1;
+}
+
+spin_lock_t *spin_lock_instance(uint lock_num)
+{
+    return &spin_locks[lock_num];
+}
+
+uint32_t spin_lock_blocking(spin_lock_t *lock)
+{
+    uint32_t irq = save_and_disable_interrupts();
+    // Cores only switch at HAL calls, so a held lock means the other core is inside it
+    while (*lock)
+        tight_loop_contents();
+    *lock = 1;
+    return irq;
+}
+
+void spin_unlock(spin_lock_t *lock, uint32_t saved_irq)
+{
+    *lock = 0;
+    restore_interrupts(saved_irq);
+}
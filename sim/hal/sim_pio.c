@@ -0,0 +1,400 @@
+#include "sim.h"
+#include <string.h>
+
+/*
+ * PIO blocks
+ * ----------
+ * Instruction memory is only allocated, never executed: each .program the
+ * firmware loads is matched by name to a behavioural model (sim/models) that
+ * reproduces its pin and FIFO behaviour. Loading still enforces the 32-slot
+ * budget, so a program mix that does not fit fails here as on hardware.
+ * RX pushes go straight to a DMA channel paced by the state machine's DREQ
+ * when one is running, otherwise into the (joined) 8-deep FIFO.
+ */
+
+#define MAX_MODELS   8
+#define MAX_PROGRAMS 8
+
+typedef struct
+{
+    const pio_program_t *program;
+    uint offset;
+} loaded_t;
+
+pio_hw_t sim_pio_hw[NUM_PIOS];
+
+static sim_pio_sm_t sms[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+static bool sm_claimed[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+static uint32_t used_slots[NUM_PIOS];
+static loaded_t loaded[NUM_PIOS][MAX_PROGRAMS];
+static const sim_pio_model_t *models[MAX_MODELS];
+static int model_count;
+
+static sim_pio_sm_t *sm_of(PIO pio, uint sm)
+{
+    return &sms[pio_get_index(pio)][sm];
+}
+
+void sim_pio_reset(void)
+{
+    memset(sim_pio_hw, 0, sizeof(sim_pio_hw));
+    memset(sms, 0, sizeof(sms));
+    memset(sm_claimed, 0, sizeof(sm_claimed));
+    memset(used_slots, 0, sizeof(used_slots));
+    memset(loaded, 0, sizeof(loaded));
+    for (uint p = 0; p < NUM_PIOS; ++p) {
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            sms[p][i].pio = &sim_pio_hw[p];
+            sms[p][i].index = i;
+        }
+    }
+}
+
+void sim_pio_register_model(const sim_pio_model_t *model)
+{
+    if (model_count == MAX_MODELS)
+        sim_panic("too many PIO models");
+    models[model_count++] = model;
+}
+
+static const sim_pio_model_t *find_model(const char *name)
+{
+    for (int i = 0; i < model_count; ++i) {
+        if (strcmp(models[i]->program, name) == 0)
+            return models[i];
+    }
+    return NULL;
+}
+
+void sim_pio_push(sim_pio_sm_t *sm, uint32_t word)
+{
+    uint dreq = pio_get_dreq(sm->pio, sm->index, false);
+    if (sim_dma_dreq_push(dreq, word))
+        return;
+    uint depth = sm->cfg.fifo_join == PIO_FIFO_JOIN_RX ? 8 : 4;
+    if (sm->rx_level < depth)
+        sm->rx_fifo[sm->rx_level++] = word;
+    else
+        sm->rx_dropped++; // push noblock on a full FIFO
+}
+
+uint64_t sim_pio_cycles_to_ns(const sim_pio_sm_t *sm, uint32_t cycles)
+{
+    double hz = clock_get_hz(clk_sys) / (sm->cfg.clkdiv > 0 ? sm->cfg.clkdiv : 1.0f);
+    return (uint64_t)(cycles * 1e9 / hz);
+}
+
+uint64_t sim_pio_ns_to_cycles(const sim_pio_sm_t *sm, uint64_t ns)
+{
+    double hz = clock_get_hz(clk_sys) / (sm->cfg.clkdiv > 0 ? sm->cfg.clkdiv : 1.0f);
+    return (uint64_t)(ns * hz / 1e9);
+}
+
+void sim_pio_raise_irq(sim_pio_sm_t *sm, uint irq_flag)
+{
+    pio_hw_t *pio = sm->pio;
+    pio->irq |= 1u << irq_flag;
+    uint base = pio_get_index(pio) ? PIO1_IRQ_0 : PIO0_IRQ_0;
+    sim_irq_raise(base);
+    sim_irq_raise(base + 1);
+}
+
+/* ---- SDK API ---- */
+
+int pio_claim_unused_sm(PIO pio, bool required)
+{
+    uint p = pio_get_index(pio);
+    for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+        if (!sm_claimed[p][i]) {
+            sm_claimed[p][i] = true;
+            return (int)i;
+        }
+    }
+    if (required)
+        sim_panic("no PIO%u state machines available", p);
+    return -1;
+}
+
+void pio_sm_claim(PIO pio, uint sm)
+{
+    uint p = pio_get_index(pio);
+    if (sm_claimed[p][sm])
+        sim_panic("PIO%u SM%u already claimed", p, sm);
+    sm_claimed[p][sm] = true;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm)
+{
+    sm_claimed[pio_get_index(pio)][sm] = false;
+}
+
+static int find_offset(PIO pio, const pio_program_t *program)
+{
+    uint32_t mask = (1u << program->length) - 1;
+    if (program->length >= 32)
+        mask = 0xFFFFFFFFu;
+    uint32_t used = used_slots[pio_get_index(pio)];
+    if (program->origin >= 0)
+        return (used & (mask << program->origin)) ? -1 : program->origin;
+    // The SDK allocates from the top of instruction memory down
+    for (int off = PIO_INSTRUCTION_COUNT - program->length; off >= 0; --off) {
+        if (!(used & (mask << off)))
+            return off;
+    }
+    return -1;
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program)
+{
+    return find_offset(pio, program) >= 0;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+    uint p = pio_get_index(pio);
+    int off = find_offset(pio, program);
+    if (off < 0)
+        sim_panic("PIO%u: no space for program '%s' (%u instructions)", p, program->name, program->length);
+    used_slots[p] |= ((program->length >= 32) ? 0xFFFFFFFFu : ((1u << program->length) - 1)) << off;
+    for (int i = 0; i < MAX_PROGRAMS; ++i) {
+        if (!loaded[p][i].program) {
+            loaded[p][i] = (loaded_t){program, (uint)off};
+            break;
+        }
+    }
+    if (!find_model(program->name))
+        sim_panic("no simulation model for PIO program '%s'", program->name);
+    return (uint)off;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset)
+{
+    uint p = pio_get_index(pio);
+    used_slots[p] &= ~(((1u << program->length) - 1) << loaded_offset);
+    for (int i = 0; i < MAX_PROGRAMS; ++i) {
+        if (loaded[p][i].program == program && loaded[p][i].offset == loaded_offset)
+            loaded[p][i].program = NULL;
+    }
+}
+
+pio_sm_config pio_get_default_sm_config(void)
+{
+    pio_sm_config c;
+    memset(&c, 0, sizeof(c));
+    c.clkdiv = 1.0f;
+    c.wrap = 31;
+    c.in_shift_right = true;
+    c.out_shift_right = true;
+    c.push_threshold = 32;
+    c.pull_threshold = 32;
+    return c;
+}
+
+void sm_config_set_in_pins(pio_sm_config *c, uint in_base) { c->in_base = in_base; }
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count) { c->out_base = out_base; c->out_count = out_count; }
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count) { c->set_base = set_base; c->set_count = set_count; }
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base) { c->sideset_base = sideset_base; }
+void sm_config_set_jmp_pin(pio_sm_config *c, uint pin) { c->jmp_pin = pin; }
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) { c->fifo_join = join; }
+void sm_config_set_clkdiv(pio_sm_config *c, float div) { c->clkdiv = div; }
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) { c->wrap_target = wrap_target; c->wrap = wrap; }
+
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac)
+{
+    c->clkdiv = div_int + div_frac / 256.0f;
+}
+
+void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold)
+{
+    c->in_shift_right = shift_right;
+    c->autopush = autopush;
+    c->push_threshold = push_threshold;
+}
+
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold)
+{
+    c->out_shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = pull_threshold;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config)
+{
+    sim_pio_sm_t *s = sm_of(pio, sm);
+    uint p = pio_get_index(pio);
+    if (s->enabled && s->model && s->model->stop)
+        s->model->stop(s);
+    s->enabled = false;
+    s->cfg = *config;
+    s->rx_level = 0;
+    s->program = NULL;
+    for (int i = 0; i < MAX_PROGRAMS; ++i) {
+        const loaded_t *l = &loaded[p][i];
+        if (l->program && initial_pc >= l->offset && initial_pc < l->offset + l->program->length) {
+            s->program = l->program;
+            s->offset = l->offset;
+        }
+    }
+    if (!s->program)
+        sim_panic("PIO%u SM%u started at pc %u outside any loaded program", p, sm, initial_pc);
+    s->model = find_model(s->program->name);
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+    sim_pio_sm_t *s = sm_of(pio, sm);
+    if (enabled == s->enabled)
+        return;
+    s->enabled = enabled;
+    if (!s->model)
+        return;
+    if (enabled && s->model->start)
+        s->model->start(s);
+    else if (!enabled && s->model->stop)
+        s->model->stop(s);
+}
+
+void pio_sm_restart(PIO pio, uint sm)
+{
+    sim_pio_sm_t *s = sm_of(pio, sm);
+    if (s->enabled && s->model) {
+        if (s->model->stop)
+            s->model->stop(s);
+        if (s->model->start)
+            s->model->start(s);
+    }
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm)
+{
+    sm_of(pio, sm)->rx_level = 0;
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out)
+{
+    (void)sm;
+    (void)pio;
+    for (uint pin = pin_base; pin < pin_base + pin_count; ++pin)
+        sim_gpio_pio_drive(pin, is_out, false);
+}
+
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask)
+{
+    (void)pio;
+    (void)sm;
+    for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) {
+        if (pin_mask & (1u << pin))
+            sim_gpio_pio_drive(pin, sim_gpio_is_output(pin), (pin_values >> pin) & 1);
+    }
+}
+
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask)
+{
+    (void)pio;
+    (void)sm;
+    for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) {
+        if (pin_mask & (1u << pin))
+            sim_gpio_pio_drive(pin, (pin_dirs >> pin) & 1, false);
+    }
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div)
+{
+    sm_of(pio, sm)->cfg.clkdiv = div;
+}
+
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac)
+{
+    sm_of(pio, sm)->cfg.clkdiv = div_int + div_frac / 256.0f;
+}
+
+void pio_gpio_init(PIO pio, uint pin)
+{
+    gpio_set_function(pin, pio_get_index(pio) ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data)
+{
+    sim_pio_sm_t *s = sm_of(pio, sm);
+    if (s->model && s->model->tx)
+        s->model->tx(s, data);
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm)
+{
+    sim_pio_sm_t *s = sm_of(pio, sm);
+    if (!s->rx_level)
+        return 0;
+    uint32_t w = s->rx_fifo[0];
+    memmove(s->rx_fifo, s->rx_fifo + 1, --s->rx_level * sizeof(uint32_t));
+    return w;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm)
+{
+    while (pio_sm_is_rx_fifo_empty(pio, sm))
+        tight_loop_contents();
+    return pio_sm_get(pio, sm);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm)
+{
+    sim_advance_ns(8);
+    return sm_of(pio, sm)->rx_level == 0;
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm)
+{
+    (void)pio;
+    (void)sm;
+    return false;
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm)
+{
+    return sm_of(pio, sm)->rx_level;
+}
+
+void pio_sm_exec(PIO pio, uint sm, uint instr)
+{
+    (void)pio;
+    (void)sm;
+    (void)instr;
+}
+
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled)
+{
+    (void)pio;
+    (void)source;
+    (void)enabled;
+}
+
+void pio_set_irq1_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled)
+{
+    (void)pio;
+    (void)source;
+    (void)enabled;
+}
+
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num)
+{
+    pio->irq &= ~(1u << pio_interrupt_num);
+}
+
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num)
+{
+    return (pio->irq & (1u << pio_interrupt_num)) != 0;
+}
+
+uint pio_encode_set(uint dest, uint value) { return 0xe000u | (dest << 5) | value; }
+uint pio_encode_jmp(uint addr) { return addr; }
+uint pio_encode_pull(bool if_empty, bool block) { return 0x8080u | (if_empty << 6) | (block << 5); }
+uint pio_encode_mov(uint dest, uint src) { return 0xa000u | (dest << 5) | src; }
+uint pio_encode_out(uint dest, uint count) { return 0x6000u | (dest << 5) | (count & 31); }
+uint pio_encode_push(bool if_full, bool block) { return 0x8000u | (if_full << 6) | (block << 5); }
+uint pio_encode_nop(void) { return 0xa042u; }
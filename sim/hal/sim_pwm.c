@@ -0,0 +1,203 @@
+#include "sim.h"
+#include <math.h>
+#include <string.h>
+
+/*
+ * PWM slices
+ * ----------
+ * Register state only: the output frequency of a slice is derived from
+ * clk_sys, DIV and TOP when asked (VCLK reporting, DMA pacing). Counter
+ * values are computed from virtual time so pwm_get_counter() stays sensible.
+ *
+ * The wrap DREQ is latched as on hardware: raised when the counter wraps,
+ * cleared by a write to CC. Wraps are counted from virtual time at the rate
+ * the slice had since its last DIV/TOP/CSR write, so a paced DMA channel
+ * started with the DREQ still raised from an old wrap fires at once, and one
+ * started after a CC write waits for the next wrap. DIV writes that do not
+ * come through pwm_set_clkdiv_int_frac() (DMA, hw_* helpers) are staged
+ * swaps; those landing past the first counter step of a period are counted,
+ * as on hardware they stretch or cut the running VCLK phase.
+ */
+
+static pwm_hw_t pwm_regs;
+pwm_hw_t *pwm_hw = &pwm_regs;
+
+static uint64_t enabled_at[NUM_PWM_SLICES];
+static double wrap_pos[NUM_PWM_SLICES];   ///< Wraps counted up to pos_at, the fraction is the period phase
+static uint64_t pos_at[NUM_PWM_SLICES];
+static double wrap_hz[NUM_PWM_SLICES];    ///< Wrap rate since pos_at
+static uint64_t cc_wrap[NUM_PWM_SLICES];  ///< Whole wraps counted at the last CC write
+static sim_pwm_stats_t stats;
+
+static double slice_div(uint slice)
+{
+    uint32_t div = pwm_hw->slice[slice].div;
+    double d = (div >> PWM_CH0_DIV_INT_LSB & 0xFF) + (div & 0xF) / 16.0;
+    return d > 0 ? d : 256.0; // INT=0 means 256
+}
+
+double sim_pwm_freq_hz(uint slice)
+{
+    const pwm_slice_hw_t *s = &pwm_hw->slice[slice];
+    if (!(s->csr & PWM_CH0_CSR_EN_BITS))
+        return 0;
+    double period = (double)(s->top + 1) * ((s->csr & PWM_CH0_CSR_PH_CORRECT_BITS) ? 2 : 1);
+    return clock_get_hz(clk_sys) / slice_div(slice) / period;
+}
+
+static double wraps_now(uint slice)
+{
+    return wrap_pos[slice] + (sim_now_ns() - pos_at[slice]) * 1e-9 * wrap_hz[slice];
+}
+
+/**
+ * @brief Fold the wraps counted at the old rate before a DIV/TOP/CSR write takes effect.
+ */
+static void rate_changed(uint slice)
+{
+    wrap_pos[slice] = wraps_now(slice);
+    pos_at[slice] = sim_now_ns();
+    wrap_hz[slice] = sim_pwm_freq_hz(slice);
+}
+
+uint64_t sim_pwm_dreq_ns(uint slice)
+{
+    if (wrap_hz[slice] <= 0)
+        return SIM_NEVER;
+    double w = wraps_now(slice);
+    if ((uint64_t)w > cc_wrap[slice])
+        return sim_now_ns();
+    // One nanosecond past the wrap, so rounding never lands the transfer just before it
+    return sim_now_ns() + (uint64_t)((floor(w) + 1 - w) * 1e9 / wrap_hz[slice]) + 1;
+}
+
+const sim_pwm_stats_t *sim_pwm_stats(void)
+{
+    return &stats;
+}
+
+void sim_pwm_reg_written(volatile void *addr)
+{
+    uintptr_t a = (uintptr_t)addr, base = (uintptr_t)pwm_hw->slice;
+    if (a < base || a >= base + sizeof(pwm_hw->slice))
+        return;
+    uint slice = (uint)((a - base) / sizeof(pwm_slice_hw_t));
+    pwm_slice_hw_t *s = &pwm_hw->slice[slice];
+
+    if (addr == &s->cc) {
+        cc_wrap[slice] = (uint64_t)wraps_now(slice);
+        return;
+    }
+    if (addr == &s->div) {
+        // Phase in counter steps: a period is (TOP + 1) steps, twice that in phase-correct mode
+        double w = wraps_now(slice);
+        double steps = (double)(s->top + 1) * ((s->csr & PWM_CH0_CSR_PH_CORRECT_BITS) ? 2 : 1);
+        stats.div_swaps++;
+        if ((w - floor(w)) * steps >= 1)
+            stats.div_swaps_off_wrap++;
+    }
+    if (addr == &s->div || addr == &s->top || addr == &s->csr)
+        rate_changed(slice);
+}
+
+static void slice_write_masked(io_rw_32 *reg, uint32_t value, uint32_t mask)
+{
+    hw_write_masked(reg, value, mask);
+}
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract)
+{
+    // Set up through the SDK, not a staged swap: only the wrap rate needs updating
+    pwm_hw->slice[slice_num].div = ((uint32_t)integer << PWM_CH0_DIV_INT_LSB) | (fract & 0xF);
+    rate_changed(slice_num);
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider)
+{
+    uint8_t i = (uint8_t)divider;
+    pwm_set_clkdiv_int_frac(slice_num, i, (uint8_t)((divider - i) * 16));
+}
+
+void pwm_set_clkdiv_mode(uint slice_num, enum pwm_clkdiv_mode mode)
+{
+    slice_write_masked(&pwm_hw->slice[slice_num].csr, (uint32_t)mode << PWM_CH0_CSR_DIVMODE_LSB, 3u << PWM_CH0_CSR_DIVMODE_LSB);
+}
+
+void pwm_set_phase_correct(uint slice_num, bool phase_correct)
+{
+    slice_write_masked(&pwm_hw->slice[slice_num].csr, phase_correct ? PWM_CH0_CSR_PH_CORRECT_BITS : 0, PWM_CH0_CSR_PH_CORRECT_BITS);
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap)
+{
+    pwm_hw->slice[slice_num].top = wrap;
+    sim_reg_written(&pwm_hw->slice[slice_num].top);
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level)
+{
+    uint lsb = chan ? PWM_CH0_CC_B_LSB : PWM_CH0_CC_A_LSB;
+    slice_write_masked(&pwm_hw->slice[slice_num].cc, (uint32_t)level << lsb, 0xFFFFu << lsb);
+}
+
+void pwm_set_both_levels(uint slice_num, uint16_t level_a, uint16_t level_b)
+{
+    pwm_hw->slice[slice_num].cc = ((uint32_t)level_b << PWM_CH0_CC_B_LSB) | level_a;
+    sim_reg_written(&pwm_hw->slice[slice_num].cc);
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level)
+{
+    pwm_set_chan_level(pwm_gpio_to_slice_num(gpio), pwm_gpio_to_channel(gpio), level);
+}
+
+void pwm_set_output_polarity(uint slice_num, bool a, bool b)
+{
+    slice_write_masked(&pwm_hw->slice[slice_num].csr,
+                       (a ? PWM_CH0_CSR_A_INV_BITS : 0) | (b ? PWM_CH0_CSR_B_INV_BITS : 0),
+                       PWM_CH0_CSR_A_INV_BITS | PWM_CH0_CSR_B_INV_BITS);
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled)
+{
+    if (enabled && !(pwm_hw->slice[slice_num].csr & PWM_CH0_CSR_EN_BITS))
+        enabled_at[slice_num] = sim_now_ns();
+    slice_write_masked(&pwm_hw->slice[slice_num].csr, enabled ? PWM_CH0_CSR_EN_BITS : 0, PWM_CH0_CSR_EN_BITS);
+    pwm_hw->en = enabled ? pwm_hw->en | (1u << slice_num) : pwm_hw->en & ~(1u << slice_num);
+}
+
+void pwm_set_mask_enabled(uint32_t mask)
+{
+    for (uint s = 0; s < NUM_PWM_SLICES; ++s)
+        pwm_set_enabled(s, (mask >> s) & 1);
+}
+
+void pwm_set_counter(uint slice_num, uint16_t c)
+{
+    pwm_hw->slice[slice_num].ctr = c;
+    enabled_at[slice_num] = sim_now_ns();
+}
+
+uint16_t pwm_get_counter(uint slice_num)
+{
+    const pwm_slice_hw_t *s = &pwm_hw->slice[slice_num];
+    if (!(s->csr & PWM_CH0_CSR_EN_BITS))
+        return (uint16_t)s->ctr;
+    double ticks = (sim_now_ns() - enabled_at[slice_num]) * 1e-9 * clock_get_hz(clk_sys) / slice_div(slice_num);
+    return (uint16_t)((uint64_t)(ticks + s->ctr) % (s->top + 1));
+}
+
+void pwm_clear_irq(uint slice_num)
+{
+    pwm_hw->intr &= ~(1u << slice_num);
+}
+
+void pwm_set_irq_enabled(uint slice_num, bool enabled)
+{
+    pwm_hw->inte = enabled ? pwm_hw->inte | (1u << slice_num) : pwm_hw->inte & ~(1u << slice_num);
+}
+
+uint32_t pwm_get_irq_status_mask(void)
+{
+    return pwm_hw->ints;
+}
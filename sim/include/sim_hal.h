@@ -0,0 +1,583 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+/*
+ * Host stand-in for the parts of the Pico SDK used by the firmware
+ * ----------------------------------------------------------------
+ * Every pico/... and hardware/... header in sim/include forwards here. The
+ * API mirrors the SDK closely enough that the src/ files compile unchanged; the
+ * behaviour lives in sim/hal, driven by a virtual clock (sim_core.c).
+ * Register blocks the firmware touches directly (clocks, DMA, I2C, PIO,
+ * PWM) are plain RAM structs that the models keep up to date.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define KHZ 1000
+#define MHZ 1000000
+#define _u(x) x##u
+
+#define PICO_OK            0
+#define PICO_ERROR_TIMEOUT (-1)
+#define PICO_ERROR_GENERIC (-2)
+#define PICO_ERROR_NOT_PERMITTED (-4)
+#define PICO_DEFAULT_LED_PIN 25
+#define NUM_CORES 2
+
+// Flash is a host array; XIP_BASE is a pointer so XIP_BASE + offset stays an address constant
+#define PICO_FLASH_SIZE_BYTES (2u * 1024 * 1024)
+#define FLASH_PAGE_SIZE       256u
+#define FLASH_SECTOR_SIZE     4096u
+extern uint8_t sim_flash_image[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uint8_t *)sim_flash_image)
+
+#define XOSC_HZ  12000000u
+#ifndef PLL_SYS_REFDIV
+#define PLL_SYS_REFDIV 1 ///< Reference divider set_sys_clock_pll() uses, as in the SDK
+#endif
+#define XOSC_KHZ 12000u
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
+#define __no_inline_not_in_flash_func(func_name) func_name
+#define __unused __attribute__((unused))
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define hard_assert(x) do { if (!(x)) sim_panic("hard_assert failed: %s (%s:%d)", #x, __FILE__, __LINE__); } while (0)
+
+void sim_panic(const char *fmt, ...) __attribute__((noreturn, format(printf, 1, 2)));
+#define panic sim_panic
+
+/* ---- address mapped registers ------------------------------------------ */
+
+typedef volatile uint32_t io_rw_32;
+typedef volatile uint32_t io_ro_32;
+typedef volatile uint32_t io_wo_32;
+
+void sim_reg_written(volatile void *addr);
+
+static inline void hw_set_bits(io_rw_32 *addr, uint32_t mask) { *addr |= mask; sim_reg_written(addr); }
+static inline void hw_clear_bits(io_rw_32 *addr, uint32_t mask) { *addr &= ~mask; sim_reg_written(addr); }
+static inline void hw_xor_bits(io_rw_32 *addr, uint32_t mask) { *addr ^= mask; sim_reg_written(addr); }
+static inline void hw_write_masked(io_rw_32 *addr, uint32_t values, uint32_t write_mask)
+{
+    *addr = (*addr & ~write_mask) | (values & write_mask);
+    sim_reg_written(addr);
+}
+
+/* ---- sync / platform ----------------------------------------------------- */
+
+void __wfe(void);
+void __sev(void);
+void __wfi(void);
+#define __dmb() __sync_synchronize()
+#define __dsb() __sync_synchronize()
+#define __isb() __sync_synchronize()
+#define __compiler_memory_barrier() __asm__ volatile("" ::: "memory")
+void tight_loop_contents(void);
+uint get_core_num(void);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+void restore_interrupts_from_disabled(uint32_t status);
+void busy_wait_at_least_cycles(uint32_t cycles);
+
+typedef volatile uint32_t spin_lock_t;
+int spin_lock_claim_unused(bool required);
+spin_lock_t *spin_lock_instance(uint lock_num);
+uint32_t spin_lock_blocking(spin_lock_t *lock);
+void spin_unlock(spin_lock_t *lock, uint32_t saved_irq);
+
+/* ---- time ------------------------------------------------------------------ */
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+void busy_wait_us_32(uint32_t delay_us);
+void busy_wait_us(uint64_t delay_us);
+void busy_wait_ms(uint32_t delay_ms);
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+
+/** Timer block; every access through timer_hw sees the calling core's current time. */
+typedef struct
+{
+    io_rw_32 timehw, timelw;
+    io_ro_32 timehr, timelr;
+    io_rw_32 alarm[4];
+    io_rw_32 armed;
+    io_ro_32 timerawh, timerawl;
+    io_rw_32 dbgpause, pause, intr, inte, intf;
+    io_ro_32 ints;
+} timer_hw_t;
+timer_hw_t *sim_timer_hw(void);
+#define timer_hw (sim_timer_hw())
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+static inline absolute_time_t from_us_since_boot(uint64_t us) { return us; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return time_us_64() + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return time_us_64() + ms * 1000ull; }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) { return t + ms * 1000ull; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+static inline bool time_reached(absolute_time_t t) { return time_us_64() >= t; }
+
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t alarm_id);
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+struct repeating_timer
+{
+    int64_t delay_us;
+    alarm_id_t alarm_id;
+    repeating_timer_callback_t callback;
+    void *user_data;
+};
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+bool cancel_repeating_timer(repeating_timer_t *timer);
+
+/* ---- stdio ------------------------------------------------------------------ */
+
+bool stdio_init_all(void);
+bool stdio_usb_connected(void);
+int getchar_timeout_us(uint32_t timeout_us);
+void stdio_flush(void);
+
+/* ---- irq ---------------------------------------------------------------------- */
+
+enum irq_num_rp2040
+{
+    TIMER_IRQ_0 = 0, TIMER_IRQ_1, TIMER_IRQ_2, TIMER_IRQ_3,
+    PWM_IRQ_WRAP, USBCTRL_IRQ, XIP_IRQ,
+    PIO0_IRQ_0, PIO0_IRQ_1, PIO1_IRQ_0, PIO1_IRQ_1,
+    DMA_IRQ_0, DMA_IRQ_1, IO_IRQ_BANK0, IO_IRQ_QSPI,
+    SIO_IRQ_PROC0, SIO_IRQ_PROC1, CLOCKS_IRQ, SPI0_IRQ, SPI1_IRQ,
+    UART0_IRQ, UART1_IRQ, ADC_IRQ_FIFO, I2C0_IRQ, I2C1_IRQ, RTC_IRQ,
+    NUM_IRQS = 32
+};
+typedef void (*irq_handler_t)(void);
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+#define PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY 0xff
+#define PICO_HIGHEST_IRQ_PRIORITY 0x00
+#define PICO_DEFAULT_IRQ_PRIORITY 0x80
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
+void irq_set_priority(uint num, uint8_t hardware_priority);
+
+/* ---- multicore ------------------------------------------------------------------ */
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1(void);
+
+/* ---- flash / watchdog ------------------------------------------------------------ */
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+bool flash_safe_execute_core_init(void);
+bool flash_safe_execute_core_deinit(void);
+
+typedef struct
+{
+    bool (*core_init_deinit)(bool init);
+    int (*enter_safe_zone_timeout_ms)(uint32_t timeout_ms);
+    int (*exit_safe_zone_timeout_ms)(uint32_t timeout_ms);
+} flash_safety_helper_t;
+flash_safety_helper_t *get_flash_safety_helper(void);  ///< Weak, the firmware may replace it
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+bool watchdog_caused_reboot(void);
+
+/* ---- gpio ------------------------------------------------------------------------ */
+
+enum gpio_function
+{
+    GPIO_FUNC_XIP = 0, GPIO_FUNC_SPI = 1, GPIO_FUNC_UART = 2, GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4, GPIO_FUNC_SIO = 5, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_GPCK = 8, GPIO_FUNC_USB = 9, GPIO_FUNC_NULL = 0x1f
+};
+#define GPIO_OUT 1
+#define GPIO_IN  0
+#define NUM_BANK0_GPIOS 30
+enum gpio_irq_level
+{
+    GPIO_IRQ_LEVEL_LOW = 0x1u, GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u, GPIO_IRQ_EDGE_RISE = 0x8u
+};
+enum gpio_drive_strength { GPIO_DRIVE_STRENGTH_2MA, GPIO_DRIVE_STRENGTH_4MA, GPIO_DRIVE_STRENGTH_8MA, GPIO_DRIVE_STRENGTH_12MA };
+enum gpio_slew_rate { GPIO_SLEW_RATE_SLOW, GPIO_SLEW_RATE_FAST };
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_deinit(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+enum gpio_function gpio_get_function(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+bool gpio_get_dir(uint gpio);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+uint32_t gpio_get_all(void);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+void gpio_set_dir_masked(uint32_t mask, uint32_t value);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+void gpio_set_input_enabled(uint gpio, bool enabled);
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive);
+void gpio_set_slew_rate(uint gpio, enum gpio_slew_rate slew);
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_callback(gpio_irq_callback_t callback);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler);
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask);
+uint32_t gpio_get_irq_event_mask(uint gpio);
+
+/* ---- clocks / pll ----------------------------------------------------------------- */
+
+enum clock_index
+{
+    clk_gpout0 = 0, clk_gpout1, clk_gpout2, clk_gpout3,
+    clk_ref, clk_sys, clk_peri, clk_usb, clk_adc, clk_rtc,
+    CLK_COUNT
+};
+typedef struct
+{
+    io_rw_32 ctrl;
+    io_rw_32 div;
+    io_ro_32 selected;
+} clock_hw_t;
+typedef struct
+{
+    clock_hw_t clk[CLK_COUNT];
+} clocks_hw_t;
+extern clocks_hw_t *clocks_hw;
+
+#define CLOCKS_CLK_GPOUT0_CTRL_ENABLE_BITS 0x00000800u
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_BITS 0x000001e0u
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_LSB  5
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS  0x0u
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_GPIN0    0x1u
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_GPIN1    0x2u
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB  0x3u
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_ROSC_CLKSRC     0x4u
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_XOSC_CLKSRC     0x5u
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_SYS         0x6u
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_USB         0x7u
+#define CLOCKS_CLK_GPOUT0_DIV_INT_LSB 8
+#define CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX    0x1u
+#define CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS     0x0u
+#define CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB     0x1u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS           0x0u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS    0x1u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB    0x2u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_XOSC_CLKSRC       0x4u
+#define CLOCKS_CLK_USB_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB     0x0u
+#define CLOCKS_CLK_USB_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS     0x1u
+#define CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB     0x0u
+#define CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS     0x1u
+#define CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_XOSC_CLKSRC        0x3u
+#define CLOCKS_CLK_RTC_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB     0x0u
+#define CLOCKS_CLK_RTC_CTRL_AUXSRC_VALUE_XOSC_CLKSRC        0x3u
+
+typedef struct pll_hw pll_hw_t;
+typedef pll_hw_t *PLL;
+extern PLL pll_sys;
+extern PLL pll_usb;
+
+void pll_init(PLL pll, uint ref_div, uint vco_freq, uint post_div1, uint post_div2);
+void pll_deinit(PLL pll);
+bool set_sys_clock_pll(uint32_t vco_freq, uint post_div1, uint post_div2);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq);
+void clock_stop(enum clock_index clk_index);
+uint32_t clock_get_hz(enum clock_index clk_index);
+void clock_gpio_init(uint gpio, uint src, float div);
+void clock_gpio_init_int_frac(uint gpio, uint src, uint32_t div_int, uint8_t div_frac);
+
+/* ---- pwm ---------------------------------------------------------------------------- */
+
+enum pwm_clkdiv_mode { PWM_DIV_FREE_RUNNING = 0, PWM_DIV_B_HIGH = 1, PWM_DIV_B_RISING = 2, PWM_DIV_B_FALLING = 3 };
+enum pwm_chan { PWM_CHAN_A = 0, PWM_CHAN_B = 1 };
+#define NUM_PWM_SLICES 8
+typedef struct
+{
+    io_rw_32 csr;
+    io_rw_32 div;
+    io_rw_32 ctr;
+    io_rw_32 cc;
+    io_rw_32 top;
+} pwm_slice_hw_t;
+typedef struct
+{
+    pwm_slice_hw_t slice[NUM_PWM_SLICES];
+    io_rw_32 en, intr, inte, intf, ints;
+} pwm_hw_t;
+extern pwm_hw_t *pwm_hw;
+#define PWM_CH0_CSR_EN_BITS          0x00000001u
+#define PWM_CH0_CSR_PH_CORRECT_BITS  0x00000002u
+#define PWM_CH0_CSR_A_INV_BITS       0x00000004u
+#define PWM_CH0_CSR_B_INV_BITS       0x00000008u
+#define PWM_CH0_CSR_DIVMODE_LSB      4
+#define PWM_CH0_DIV_INT_LSB          4
+#define PWM_CH0_DIV_FRAC_LSB         0
+#define PWM_CH0_CC_A_LSB             0
+#define PWM_CH0_CC_B_LSB             16
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1u) & 7u; }
+static inline uint pwm_gpio_to_channel(uint gpio) { return gpio & 1u; }
+static inline uint pwm_get_dreq(uint slice_num) { return 24 + slice_num; }
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract);
+void pwm_set_clkdiv(uint slice_num, float divider);
+void pwm_set_clkdiv_mode(uint slice_num, enum pwm_clkdiv_mode mode);
+void pwm_set_phase_correct(uint slice_num, bool phase_correct);
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level);
+void pwm_set_both_levels(uint slice_num, uint16_t level_a, uint16_t level_b);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+void pwm_set_output_polarity(uint slice_num, bool a, bool b);
+void pwm_set_enabled(uint slice_num, bool enabled);
+void pwm_set_mask_enabled(uint32_t mask);
+void pwm_set_counter(uint slice_num, uint16_t c);
+uint16_t pwm_get_counter(uint slice_num);
+void pwm_clear_irq(uint slice_num);
+void pwm_set_irq_enabled(uint slice_num, bool enabled);
+uint32_t pwm_get_irq_status_mask(void);
+
+/* ---- i2c ------------------------------------------------------------------------------ */
+
+typedef struct
+{
+    io_rw_32 con, tar, sar, _pad0, data_cmd;
+    io_rw_32 ss_scl_hcnt, ss_scl_lcnt, fs_scl_hcnt, fs_scl_lcnt, _pad1[2];
+    io_ro_32 intr_stat;
+    io_rw_32 intr_mask;
+    io_ro_32 raw_intr_stat;
+    io_rw_32 rx_tl, tx_tl;
+    io_ro_32 clr_intr, clr_rx_under, clr_rx_over, clr_tx_over, clr_rd_req, clr_tx_abrt;
+    io_ro_32 clr_rx_done, clr_activity, clr_stop_det, clr_start_det, clr_gen_call;
+    io_rw_32 enable;
+    io_ro_32 status, txflr, rxflr;
+    io_rw_32 sda_hold;
+    io_ro_32 tx_abrt_source;
+    io_rw_32 slv_data_nack_only, dma_cr, dma_tdlr, dma_rdlr;
+} i2c_hw_t;
+typedef struct i2c_inst
+{
+    i2c_hw_t *hw;
+    bool restart_on_next;
+} i2c_inst_t;
+extern i2c_inst_t i2c0_inst, i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+#define I2C_IC_DATA_CMD_STOP_BITS          0x00000200u
+#define I2C_IC_DATA_CMD_RESTART_BITS       0x00000400u
+#define I2C_IC_DATA_CMD_CMD_BITS           0x00000100u
+#define I2C_IC_STATUS_ACTIVITY_BITS        0x00000001u
+#define I2C_IC_STATUS_TFNF_BITS            0x00000002u
+#define I2C_IC_STATUS_TFE_BITS             0x00000004u
+#define I2C_IC_DMA_CR_TDMAE_BITS           0x00000002u
+#define I2C_IC_DMA_CR_RDMAE_BITS           0x00000001u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS  0x00000040u
+#define I2C_IC_RAW_INTR_STAT_STOP_DET_BITS 0x00000200u
+
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) { return i2c->hw; }
+static inline uint i2c_hw_index(i2c_inst_t *i2c) { return i2c == i2c1 ? 1 : 0; }
+static inline uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) { return 32 + 2 * i2c_hw_index(i2c) + (is_tx ? 0 : 1); }
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+/* ---- dma ------------------------------------------------------------------------------- */
+
+#define NUM_DMA_CHANNELS 12
+#define NUM_DMA_TIMERS   4
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+typedef struct
+{
+    uint32_t ctrl;
+} dma_channel_config;
+typedef struct
+{
+    io_rw_32 read_addr, write_addr, transfer_count, ctrl_trig;
+    io_rw_32 al1_ctrl, al1_read_addr, al1_write_addr, al1_transfer_count_trig;
+    io_rw_32 al2_ctrl, al2_transfer_count, al2_read_addr, al2_write_addr_trig;
+    io_rw_32 al3_ctrl, al3_write_addr, al3_transfer_count, al3_read_addr_trig;
+} dma_channel_hw_t;
+typedef struct
+{
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+    io_rw_32 intr, inte0, intf0, ints0, _pad0, inte1, intf1, ints1;
+    io_rw_32 timer[NUM_DMA_TIMERS];
+    io_wo_32 multi_channel_trigger;
+} dma_hw_t;
+extern dma_hw_t *dma_hw;
+#define DREQ_PIO0_TX0   0
+#define DREQ_PIO0_RX0   4
+#define DREQ_PIO1_TX0   8
+#define DREQ_PIO1_RX0   12
+#define DREQ_PWM_WRAP0  24
+#define DREQ_I2C0_TX    32
+#define DREQ_I2C0_RX    33
+#define DREQ_DMA_TIMER0 59
+#define DREQ_FORCE      63
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_claim(uint channel);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits);
+void channel_config_set_irq_quiet(dma_channel_config *c, bool irq_quiet);
+void channel_config_set_enable(dma_channel_config *c, bool enable);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count);
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void *write_addr, uint32_t transfer_count);
+void dma_channel_start(uint channel);
+void dma_start_channel_mask(uint32_t chan_mask);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+bool dma_channel_get_irq1_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+void dma_channel_acknowledge_irq1(uint channel);
+int dma_claim_unused_timer(bool required);
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator);
+static inline uint dma_get_timer_dreq(uint timer_num) { return DREQ_DMA_TIMER0 + timer_num; }
+static inline dma_channel_hw_t *dma_channel_hw_addr(uint channel) { return &dma_hw->ch[channel]; }
+
+/* ---- pio -------------------------------------------------------------------------------- */
+
+#define NUM_PIOS 2
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+typedef struct
+{
+    io_rw_32 ctrl;
+    io_ro_32 fstat;
+    io_rw_32 fdebug;
+    io_ro_32 flevel;
+    io_wo_32 txf[NUM_PIO_STATE_MACHINES];
+    io_ro_32 rxf[NUM_PIO_STATE_MACHINES];
+    io_rw_32 irq;
+    io_wo_32 irq_force;
+} pio_hw_t;
+typedef pio_hw_t *PIO;
+extern pio_hw_t sim_pio_hw[NUM_PIOS];
+#define pio0 (&sim_pio_hw[0])
+#define pio1 (&sim_pio_hw[1])
+
+typedef struct pio_program
+{
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+    const char *name; ///< sim only: selects the behavioural model
+} pio_program_t;
+
+typedef struct
+{
+    float clkdiv;
+    uint wrap_target, wrap;
+    uint in_base, out_base, out_count, set_base, set_count, sideset_base, jmp_pin;
+    bool in_shift_right, autopush, out_shift_right, autopull;
+    uint push_threshold, pull_threshold;
+    uint fifo_join;
+} pio_sm_config;
+
+enum pio_fifo_join { PIO_FIFO_JOIN_NONE = 0, PIO_FIFO_JOIN_TX = 1, PIO_FIFO_JOIN_RX = 2 };
+enum pio_interrupt_source
+{
+    pis_interrupt0 = 8, pis_interrupt1, pis_interrupt2, pis_interrupt3,
+    pis_sm0_tx_fifo_not_full = 4, pis_sm1_tx_fifo_not_full, pis_sm2_tx_fifo_not_full, pis_sm3_tx_fifo_not_full,
+    pis_sm0_rx_fifo_not_empty = 0, pis_sm1_rx_fifo_not_empty, pis_sm2_rx_fifo_not_empty, pis_sm3_rx_fifo_not_empty
+};
+
+static inline uint pio_get_index(PIO pio) { return pio == pio1 ? 1 : 0; }
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx)
+{
+    return (pio_get_index(pio) ? DREQ_PIO1_TX0 : DREQ_PIO0_TX0) + (is_tx ? 0 : 4) + sm;
+}
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_sm_unclaim(PIO pio, uint sm);
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
+pio_sm_config pio_get_default_sm_config(void);
+void sm_config_set_in_pins(pio_sm_config *c, uint in_base);
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count);
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count);
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base);
+void sm_config_set_jmp_pin(pio_sm_config *c, uint pin);
+void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold);
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold);
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join);
+void sm_config_set_clkdiv(pio_sm_config *c, float div);
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac);
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac);
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled);
+void pio_set_irq1_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled);
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num);
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num);
+uint pio_encode_set(uint dest, uint value);
+uint pio_encode_jmp(uint addr);
+uint pio_encode_pull(bool if_empty, bool block);
+uint pio_encode_mov(uint dest, uint src);
+uint pio_encode_out(uint dest, uint count);
+uint pio_encode_push(bool if_full, bool block);
+uint pio_encode_nop(void);
+enum pio_src_dest
+{
+    pio_pins = 0u, pio_x = 1u, pio_y = 2u, pio_null = 3u, pio_pindirs = 4u,
+    pio_exec_mov = 4u, pio_status = 5u, pio_pc = 5u, pio_isr = 6u, pio_osr = 7u
+};
+
+#endif // SIM_HAL_H
@@ -0,0 +1,430 @@
+#include "models.h"
+#include "setup.h"
+#include <string.h>
+
+/*
+ * Console
+ * -------
+ * Boot: the 68000 runs once MCLK is up and !VRES is released. On a TMSS
+ * console the boot ROM reads the cart header TMSS_PEEK_NS in (the cart is
+ * mapped and !CART_CE pulses low), unmaps it again and shows the licence
+ * screen for TMSS_SCREEN_NS before mapping the cart for good. A 68000 reset
+ * leaves the mapping alone, so a reset that lands during the header read
+ * restarts straight into the cart. A running game touches the cart (and
+ * !CART_CE) within a few bus cycles of leaving reset.
+ *
+ * Pad polling: every video frame the running game drives SELECT through
+ * one or more read sequences: one low/high pair for a 3-button read, four
+ * pairs for a 6-button read, idling high in between. The poll profile sets
+ * the pairs, the reads per frame, the time between edges (2 us for tight
+ * assembly, longer for compiled code) and how far the VBlank handler's
+ * latency moves each read. Frames are skipped while the firmware itself
+ * drives SELECT (polling mode), as the console and the firmware would
+ * otherwise fight over the line.
+ *
+ * Reset button: the VDP pulls !VRES low for as long as the button is held.
+ *
+ * Responses: every change the firmware makes to !VRES, !HALT and the
+ * region jumpers is timed against the stimulus that caused it (a pad
+ * press, a reset button tap, the TMSS header read, power-on) and can be logged with
+ * the stimuli as CSV (time_ns,actor,signal,value).
+ */
+
+#define POWER_ON_CHECK_NS   SIM_NS_PER_MS          ///< How often a powered-off console checks MCLK
+#define TMSS_PEEK_NS        (1500 * SIM_NS_PER_US) ///< Boot ROM start to cart header read
+#define TMSS_PEEK_LEN_NS    (2 * SIM_NS_PER_US)    ///< Cart mapped for the header read
+#define TMSS_SCREEN_NS      (2500 * SIM_NS_PER_MS) ///< Licence screen
+#define CART_FETCH_NS       600                    ///< Reset release to first cart bus cycle
+#define CART_CE_PULSE_NS    250
+#define VSYNC_PULSE_NS      (192 * SIM_NS_PER_US)  ///< Three lines of vertical sync
+
+typedef enum
+{
+    BOOT_OFF,       ///< No MCLK yet
+    BOOT_RESET,     ///< !VRES held low
+    BOOT_TMSS,      ///< Boot ROM running, licence screen
+    BOOT_GAME       ///< Cart mapped and running
+} boot_state_t;
+
+typedef struct
+{
+    const char *name;
+    uint8_t pairs;        ///< SELECT low/high pairs per read
+    uint8_t reads;        ///< Reads per frame, spread evenly over it
+    uint32_t step_ns;     ///< Time between SELECT edges
+    uint32_t jitter_ns;   ///< Largest delay of a read past its slot
+} poll_profile_t;
+
+static const poll_profile_t profiles[POLL_KIND_COUNT] = {
+    [POLL_NONE]          = {"none", 0, 0, 0, 0},
+    [POLL_3BUTTON]       = {"3-button", 1, 1, 2 * SIM_NS_PER_US, 0},
+    [POLL_6BUTTON]       = {"6-button", 4, 1, 2 * SIM_NS_PER_US, 0},
+    [POLL_3BUTTON_TWICE] = {"3-button twice a frame", 1, 2, 3 * SIM_NS_PER_US, 40 * SIM_NS_PER_US},
+    [POLL_6BUTTON_SLOW]  = {"6-button slow", 4, 1, 12 * SIM_NS_PER_US, 40 * SIM_NS_PER_US},
+};
+
+static sim_poll_kind_t poll;
+static uint64_t frame_ns;
+static uint32_t frames;
+static uint32_t edges;
+static uint edges_left;
+static uint32_t jitter_seed = 1;
+
+static bool tmss;
+static boot_state_t boot_state;
+static bool cart_mapped;
+static sim_event_t *boot_ev;
+static uint32_t game_starts;
+static uint32_t tmss_screens;
+static sim_console_stats_t stats;
+static uint64_t halted_since;
+
+static FILE *event_log;
+static sim_console_latency_t latency;
+static bool button_held;
+static uint64_t peek_ns;         ///< TMSS header read in progress since (0: none)
+static uint64_t pad_press_ns;    ///< Pad press not answered yet (0: none)
+static uint64_t tap_ns;          ///< Latest reset button press (0: none)
+static uint64_t switch_tap_ns;   ///< Tap that switched the region, until the cart runs again
+
+/* ---- response recording ---- */
+
+static void log_event(const char *actor, const char *signal, const char *value)
+{
+    if (event_log)
+        fprintf(event_log, "%llu,%s,%s,%s\n", (unsigned long long)sim_now_ns(), actor, signal, value);
+}
+
+static void log_level(const char *actor, const char *signal, bool level)
+{
+    log_event(actor, signal, level ? "1" : "0");
+}
+
+static void latency_add(sim_latency_t *l, uint64_t ns)
+{
+    if (!l->count || ns < l->min_ns)
+        l->min_ns = ns;
+    if (ns > l->max_ns)
+        l->max_ns = ns;
+    l->total_ns += ns;
+    l->count++;
+}
+
+/**
+ * @brief A firmware !VRES or !HALT assertion: charge it to the pad press it answers.
+ */
+static void hotkey_response(void)
+{
+    if (!pad_press_ns)
+        return;
+    uint64_t waited = sim_now_ns() - pad_press_ns;
+    latency_add(&latency.hotkey, waited > HOTKEY_HOLD_US * SIM_NS_PER_US ? waited - HOTKEY_HOLD_US * SIM_NS_PER_US : 0);
+    pad_press_ns = 0;
+}
+
+static void on_jumper(uint pin, bool level, void *arg)
+{
+    (void)arg;
+    log_level("firmware", pin == GPIO_STANDARD_PIN ? "STANDARD" : "REGION", level);
+    // Both jumpers may change for one switch; the first one times it
+    if (tap_ns && switch_tap_ns != tap_ns) {
+        latency_add(&latency.region_jumpers, sim_now_ns() - tap_ns);
+        switch_tap_ns = tap_ns;
+    }
+}
+
+void console_model_pad_changed(pad_mask_t old, pad_mask_t now)
+{
+    char names[96];
+    sim_format_buttons(now, names, sizeof(names));
+    log_event("pad", "buttons", names);
+    // The latest press starts a hotkey hold; any release ends it
+    if (old & ~now)
+        pad_press_ns = 0;
+    else if (now & ~old)
+        pad_press_ns = sim_now_ns();
+}
+
+void console_model_log_to(FILE *out)
+{
+    event_log = out;
+    if (out)
+        fprintf(out, "time_ns,actor,signal,value\n");
+}
+
+const sim_console_latency_t *console_model_latency(void)
+{
+    return &latency;
+}
+
+/* ---- boot ---- */
+
+static void cart_ce(bool level)
+{
+    sim_gpio_drive(GPIO_CART_CE_PIN, level);
+}
+
+static void cart_ce_pulse_start(void *arg)
+{
+    (void)arg;
+    cart_ce(0);
+}
+
+static void cart_ce_pulse_end(void *arg)
+{
+    (void)arg;
+    cart_ce(1);
+}
+
+static void game_start(void)
+{
+    boot_state = BOOT_GAME;
+    cart_mapped = true;
+    game_starts++;
+    log_event("console", "game", "start");
+    if (switch_tap_ns) {
+        latency_add(&latency.region_restart, sim_now_ns() - switch_tap_ns);
+        switch_tap_ns = 0;
+    }
+    // Reset vector fetch from the cart
+    sim_schedule(sim_now_ns() + CART_FETCH_NS, SIM_MODEL, cart_ce_pulse_start, NULL);
+    sim_schedule(sim_now_ns() + CART_FETCH_NS + CART_CE_PULSE_NS, SIM_MODEL, cart_ce_pulse_end, NULL);
+    sim_log("console: game running");
+}
+
+static void tmss_step(void *arg);
+
+static void boot_schedule(uint64_t delay_ns, void *stage)
+{
+    boot_ev = sim_schedule(sim_now_ns() + delay_ns, SIM_MODEL, tmss_step, stage);
+}
+
+/**
+ * @brief Boot ROM progress: header read start, header read end, licence screen end.
+ */
+static void tmss_step(void *arg)
+{
+    uintptr_t stage = (uintptr_t)arg;
+    boot_ev = NULL;
+    switch (stage) {
+    case 0:
+        cart_mapped = true;
+        peek_ns = sim_now_ns();
+        log_event("console", "tmss", "header read");
+        cart_ce(0);
+        boot_schedule(TMSS_PEEK_LEN_NS, (void *)1);
+        break;
+    case 1:
+        cart_ce(1);
+        cart_mapped = false;
+        peek_ns = 0;
+        tmss_screens++;
+        sim_log("console: TMSS licence screen");
+        boot_schedule(TMSS_SCREEN_NS, (void *)2);
+        break;
+    default:
+        game_start();
+        break;
+    }
+}
+
+static void boot(void *arg)
+{
+    (void)arg;
+    boot_ev = NULL;
+    if (!sim_gpio_level(GPIO_VRES_PIN)) {
+        boot_state = BOOT_RESET;
+        return;
+    }
+    if (!sim_mclk_hz()) {
+        boot_state = BOOT_OFF;
+        boot_ev = sim_schedule(sim_now_ns() + POWER_ON_CHECK_NS, SIM_MODEL, boot, NULL);
+        return;
+    }
+    if (cart_mapped || !tmss) {
+        game_start();
+        return;
+    }
+    boot_state = BOOT_TMSS;
+    boot_schedule(TMSS_PEEK_NS, (void *)0);
+}
+
+static void on_vres(uint pin, bool level, void *arg)
+{
+    (void)pin;
+    (void)arg;
+    if (boot_ev) {
+        sim_cancel(boot_ev);
+        boot_ev = NULL;
+    }
+    log_level(button_held ? "button" : "firmware", "VRES", level);
+    if (!level && !button_held) {
+        if (peek_ns)
+            latency_add(&latency.tmss_skip, sim_now_ns() - peek_ns);
+        else
+            hotkey_response();
+        if (boot_state == BOOT_GAME)
+            stats.game_resets++;
+    }
+    peek_ns = 0;
+    if (level && !button_held && !latency.boot.count)
+        latency_add(&latency.boot, sim_now_ns());
+    if (!level) {
+        // The 68000 stops; whatever the boot ROM had mapped stays mapped
+        stats.resets++;
+        boot_state = BOOT_RESET;
+        cart_ce(1);
+        return;
+    }
+    boot(NULL);
+}
+
+static void on_halt(uint pin, bool level, void *arg)
+{
+    (void)pin;
+    (void)arg;
+    log_level("firmware", "HALT", level);
+    if (!level) {
+        hotkey_response();
+        stats.halts++;
+        halted_since = sim_now_ns();
+    } else {
+        stats.halted_ns += sim_now_ns() - halted_since;
+    }
+}
+
+static void reset_button_release(void *arg)
+{
+    (void)arg;
+    sim_gpio_drive(GPIO_VRES_PIN, 1);
+    button_held = false;
+}
+
+void console_model_press_reset(uint64_t hold_ns)
+{
+    stats.button_presses++;
+    button_held = true;
+    tap_ns = sim_now_ns();
+    sim_gpio_drive(GPIO_VRES_PIN, 0);
+    sim_schedule(sim_now_ns() + hold_ns, SIM_MODEL, reset_button_release, NULL);
+}
+
+/* ---- pad polling ---- */
+
+static void select_step(void *arg)
+{
+    (void)arg;
+    bool level = !sim_gpio_level(GPIO_PIN_SELECT);
+    sim_gpio_drive(GPIO_PIN_SELECT, level);
+    edges++;
+    if (--edges_left)
+        sim_schedule(sim_now_ns() + profiles[poll].step_ns, SIM_MODEL, select_step, NULL);
+}
+
+static void read_start(void *arg)
+{
+    (void)arg;
+    // No pad reads while the 68000 is halted or in reset
+    if (boot_state != BOOT_GAME || !sim_gpio_level(GPIO_HALT_PIN) || poll == POLL_NONE || sim_gpio_is_output(GPIO_PIN_SELECT))
+        return;
+    edges_left = 2u * profiles[poll].pairs;
+    select_step(NULL);
+}
+
+/**
+ * @brief Pseudo-random read delay, the same sequence on every run.
+ */
+static uint64_t read_jitter_ns(void)
+{
+    if (!profiles[poll].jitter_ns)
+        return 0;
+    jitter_seed ^= jitter_seed << 13;
+    jitter_seed ^= jitter_seed >> 17;
+    jitter_seed ^= jitter_seed << 5;
+    return jitter_seed % profiles[poll].jitter_ns;
+}
+
+static void vsync_end(void *arg)
+{
+    (void)arg;
+    sim_gpio_drive(GPIO_VSYNC_PIN, 1);
+}
+
+static void frame_start(void *arg)
+{
+    (void)arg;
+    uint64_t now = sim_now_ns();
+    sim_schedule(now + frame_ns, SIM_MODEL, frame_start, NULL);
+    frames++;
+
+    // The VDP keeps /VSYNC going whenever it has a clock, reset or not
+    if (sim_mclk_hz()) {
+        sim_gpio_drive(GPIO_VSYNC_PIN, 0);
+        sim_schedule(now + VSYNC_PULSE_NS, SIM_MODEL, vsync_end, NULL);
+    }
+
+    const poll_profile_t *p = &profiles[poll];
+    for (uint r = 0; r < p->reads; ++r) {
+        uint64_t at = now + r * frame_ns / p->reads + read_jitter_ns();
+        if (at == now)
+            read_start(NULL);
+        else
+            sim_schedule(at, SIM_MODEL, read_start, NULL);
+    }
+}
+
+void console_model_init(sim_poll_kind_t kind, double frame_hz, bool has_tmss)
+{
+    poll = kind;
+    frame_ns = (uint64_t)(1e9 / frame_hz);
+    frames = edges = 0;
+    tmss = has_tmss;
+    cart_mapped = false;
+    game_starts = tmss_screens = 0;
+    memset(&stats, 0, sizeof(stats));
+    memset(&latency, 0, sizeof(latency));
+    button_held = false;
+    peek_ns = pad_press_ns = tap_ns = switch_tap_ns = 0;
+
+    // The console's pull-ups and bus idle levels
+    sim_gpio_drive(GPIO_PIN_SELECT, 1);
+    sim_gpio_drive(GPIO_VRES_PIN, 1);
+    sim_gpio_drive(GPIO_HALT_PIN, 1);
+    sim_gpio_drive(GPIO_VSYNC_PIN, 1);
+    cart_ce(1);
+    sim_gpio_watch(GPIO_VRES_PIN, on_vres, NULL);
+    sim_gpio_watch(GPIO_HALT_PIN, on_halt, NULL);
+    sim_gpio_watch(GPIO_STANDARD_PIN, on_jumper, NULL);
+    sim_gpio_watch(GPIO_REGION_PIN, on_jumper, NULL);
+
+    boot_state = BOOT_OFF;
+    boot_ev = sim_schedule(0, SIM_MODEL, boot, NULL);
+    sim_schedule(frame_ns, SIM_MODEL, frame_start, NULL);
+}
+
+void console_model_set_poll(sim_poll_kind_t kind)
+{
+    poll = kind;
+}
+
+uint32_t console_model_frames(void)
+{
+    return frames;
+}
+
+uint32_t console_model_select_edges(void)
+{
+    return edges;
+}
+
+const sim_console_stats_t *console_model_stats(void)
+{
+    stats.game_starts = game_starts;
+    stats.tmss_screens = tmss_screens;
+    return &stats;
+}
+
+const char *console_model_poll_name(sim_poll_kind_t kind)
+{
+    return profiles[kind].name;
+}
@@ -0,0 +1,95 @@
+#ifndef SIM_MODELS_H
+#define SIM_MODELS_H
+
+/*
+ * Console-side models driven by the simulation: the controller in port 1,
+ * the game polling it, the OLED panel on the I2C bus, and the behavioural
+ * stand-ins for the firmware's PIO programs.
+ */
+
+#include "sim.h"
+#include "structs.h"
+
+typedef enum
+{
+    PAD_NONE,
+    PAD_3BUTTON,
+    PAD_6BUTTON
+} sim_pad_kind_t;
+
+typedef enum
+{
+    POLL_NONE,           ///< Game never touches SELECT
+    POLL_3BUTTON,        ///< One SELECT low/high pair per frame
+    POLL_6BUTTON,        ///< Four pairs per frame, as 6-button aware games do
+    POLL_3BUTTON_TWICE,  ///< Two 3-button reads per frame, half a frame apart, start jittered
+    POLL_6BUTTON_SLOW,   ///< 6-button reads from compiled code: 12 us between edges, start jittered
+    POLL_KIND_COUNT
+} sim_poll_kind_t;
+
+/* pad_model.c */
+void pad_model_init(sim_pad_kind_t kind);
+void pad_model_set_kind(sim_pad_kind_t kind);
+void pad_model_set_buttons(pad_mask_t mask);
+pad_mask_t pad_model_buttons(void);
+const char *pad_model_kind_name(sim_pad_kind_t kind);
+uint32_t pad_model_lines(sim_pad_kind_t kind, pad_mask_t buttons, uint phase, bool select);
+
+/* console_model.c: boot (TMSS) and the game's pad reads */
+void console_model_init(sim_poll_kind_t poll, double frame_hz, bool has_tmss);
+void console_model_set_poll(sim_poll_kind_t poll);
+void console_model_press_reset(uint64_t hold_ns);
+uint32_t console_model_frames(void);
+uint32_t console_model_select_edges(void);
+typedef struct
+{
+    uint32_t game_starts;   ///< Times the 68000 started running the cart
+    uint32_t tmss_screens;  ///< Licence screens shown (TMSS skip missed or disabled)
+    uint32_t resets;        ///< !VRES assertions, by anyone
+    uint32_t game_resets;   ///< !VRES assertions by the firmware while the cart ran
+    uint32_t button_presses; ///< Reset button presses
+    uint32_t halts;         ///< !HALT assertions
+    uint64_t halted_ns;     ///< Total time the 68000 spent halted
+} sim_console_stats_t;
+const sim_console_stats_t *console_model_stats(void);
+const char *console_model_poll_name(sim_poll_kind_t poll);
+
+/* console_model.c: the firmware's responses, timed against the stimuli that caused them */
+typedef struct
+{
+    uint32_t count;
+    uint64_t min_ns, max_ns, total_ns;
+} sim_latency_t;
+typedef struct
+{
+    sim_latency_t hotkey;          ///< Pad press to !VRES or !HALT, less HOTKEY_HOLD_US
+    sim_latency_t tmss_skip;       ///< TMSS header read (!CART_CE fall) to !VRES
+    sim_latency_t region_jumpers;  ///< Reset button tap to the region jumpers changing
+    sim_latency_t region_restart;  ///< Reset button tap to the 68000 running the cart in the new region
+    sim_latency_t boot;            ///< Power-on to the firmware first releasing !VRES
+} sim_console_latency_t;
+void console_model_pad_changed(pad_mask_t old, pad_mask_t now);
+void console_model_log_to(FILE *out);
+const sim_console_latency_t *console_model_latency(void);
+
+/* oled_model.c */
+typedef struct
+{
+    uint32_t transactions;
+    uint32_t command_bytes;
+    uint32_t data_bytes;
+    bool display_on;
+} sim_oled_stats_t;
+void oled_model_init(uint8_t addr);
+const sim_oled_stats_t *oled_model_stats(void);
+void oled_model_dump(FILE *out);
+const uint8_t *oled_model_gddram(void);
+
+/* pio_models.c */
+void pio_models_register(void);
+
+/* helpers shared by the driver */
+pad_mask_t sim_parse_buttons(char *const *names, int count, bool *ok);
+void sim_format_buttons(pad_mask_t mask, char *buf, size_t len);
+
+#endif // SIM_MODELS_H
@@ -0,0 +1,158 @@
+#include "models.h"
+#include <string.h>
+
+/*
+ * SSD1306 panel
+ * -------------
+ * Decodes what arrives on the bus: a control byte (0x00 command stream,
+ * 0x40 data stream, 0x80/0xC0 single command/data byte) followed by
+ * commands or GDDRAM data. Command parsing carries across transactions, as
+ * the controller's does, since the library sends arguments one transaction
+ * at a time. GDDRAM writes follow the column/page window in horizontal
+ * addressing mode, which is the only mode the firmware uses.
+ */
+
+#define OLED_COLS  128
+#define OLED_PAGES 8
+
+static uint8_t gddram[OLED_PAGES * OLED_COLS];
+static sim_oled_stats_t stats;
+
+static struct
+{
+    uint8_t cmd;           ///< Command awaiting arguments
+    uint8_t args[6];
+    uint8_t nargs, want;
+    uint8_t col0, col1, page0, page1;
+    uint8_t col, page;
+} st;
+
+static uint8_t arg_count(uint8_t cmd)
+{
+    switch (cmd) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22:
+        return 2;
+    case 0x26: case 0x27:
+        return 6;
+    case 0x29: case 0x2A:
+        return 5;
+    default:
+        return 0;
+    }
+}
+
+static void run_command(void)
+{
+    switch (st.cmd) {
+    case 0x21:
+        st.col0 = st.col = st.args[0] & 0x7F;
+        st.col1 = st.args[1] & 0x7F;
+        break;
+    case 0x22:
+        st.page0 = st.page = st.args[0] & 0x07;
+        st.page1 = st.args[1] & 0x07;
+        break;
+    case 0xAE:
+    case 0xAF:
+        stats.display_on = st.cmd & 1;
+        break;
+    default:
+        break;
+    }
+}
+
+static void command_byte(uint8_t b)
+{
+    stats.command_bytes++;
+    if (st.want) {
+        st.args[st.nargs++] = b;
+        if (st.nargs == st.want) {
+            st.want = 0;
+            run_command();
+        }
+        return;
+    }
+    st.cmd = b;
+    st.nargs = 0;
+    st.want = arg_count(b);
+    if (!st.want)
+        run_command();
+}
+
+static void data_byte(uint8_t b)
+{
+    stats.data_bytes++;
+    gddram[st.page * OLED_COLS + st.col] = b;
+    if (st.col++ == st.col1) {
+        st.col = st.col0;
+        st.page = st.page == st.page1 ? st.page0 : st.page + 1;
+    }
+}
+
+static void on_transaction(const uint8_t *bytes, size_t len, void *arg)
+{
+    (void)arg;
+    stats.transactions++;
+    size_t i = 0;
+    while (i < len) {
+        uint8_t control = bytes[i++];
+        bool data = control & 0x40;
+        bool single = control & 0x80; // Co=1: one byte, then another control byte
+        for (; i < len; ++i) {
+            if (data)
+                data_byte(bytes[i]);
+            else
+                command_byte(bytes[i]);
+            if (single) {
+                ++i;
+                break;
+            }
+        }
+    }
+}
+
+void oled_model_init(uint8_t addr)
+{
+    memset(gddram, 0, sizeof(gddram));
+    memset(&stats, 0, sizeof(stats));
+    memset(&st, 0, sizeof(st));
+    st.col1 = OLED_COLS - 1;
+    st.page1 = OLED_PAGES - 1;
+    sim_i2c_attach(addr, on_transaction, NULL);
+}
+
+const sim_oled_stats_t *oled_model_stats(void)
+{
+    return &stats;
+}
+
+const uint8_t *oled_model_gddram(void)
+{
+    return gddram;
+}
+
+void oled_model_dump(FILE *out)
+{
+    // Two pixel rows per character cell with half blocks
+    static const char *cells[4] = {" ", "▀", "▄", "█"};
+    fprintf(out, "+");
+    for (int x = 0; x < OLED_COLS; ++x)
+        fputc('-', out);
+    fprintf(out, "+\n");
+    for (int y = 0; y < OLED_PAGES * 8; y += 2) {
+        fputc('|', out);
+        for (int x = 0; x < OLED_COLS; ++x) {
+            uint8_t col = gddram[(y / 8) * OLED_COLS + x];
+            int top = (col >> (y % 8)) & 1;
+            int bottom = (col >> (y % 8 + 1)) & 1;
+            fputs(cells[top | bottom << 1], out);
+        }
+        fprintf(out, "|\n");
+    }
+    fprintf(out, "+");
+    for (int x = 0; x < OLED_COLS; ++x)
+        fputc('-', out);
+    fprintf(out, "+\n");
+}
@@ -0,0 +1,154 @@
+#include "models.h"
+#include "setup.h"
+#include <string.h>
+#include <strings.h>
+
+/*
+ * Genesis/Mega Drive pad
+ * ----------------------
+ * Drives the six data lines from the button state and the SELECT (TH) level
+ * the console applies. A 6-button pad counts SELECT edges: phases 0-4 look
+ * like a 3-button pad, phase 5 (SELECT=0) pulls all four directions low as
+ * its ID, phase 6 (SELECT=1) puts Z/Y/X/MODE on the direction lines and
+ * phase 7 (SELECT=0) returns the directions high. The count resets when
+ * SELECT has been idle for ~1.5 ms. Outputs are active low.
+ */
+
+#define SIX_BUTTON_RESET_NS (1500 * SIM_NS_PER_US)
+
+static const uint data_pins[6] = {GPIO_PIN_UP, GPIO_PIN_DOWN, GPIO_PIN_LEFT, GPIO_PIN_RIGHT, GPIO_PIN_B, GPIO_PIN_C};
+
+static sim_pad_kind_t kind;
+static pad_mask_t buttons;
+static uint phase;
+static uint64_t last_edge_ns;
+
+/**
+ * @brief Data line levels for a button state and read phase.
+ * @return Lines as the sniffer samples them: bit n = data_pins[n], active low.
+ */
+uint32_t pad_model_lines(sim_pad_kind_t k, pad_mask_t mask, uint p, bool select)
+{
+    // Nothing plugged in: the console's pull-ups hold the lines high
+    if (k == PAD_NONE)
+        return 0x3F;
+
+    bool pressed[6];
+    if (k != PAD_6BUTTON)
+        p = select ? 0 : 1;
+#define HELD(bit) ((mask & (bit)) != 0)
+    if (select) {
+        bool ext = p == 6;
+        pressed[0] = ext ? HELD(PAD_BTN_Z) : HELD(PAD_BTN_UP);
+        pressed[1] = ext ? HELD(PAD_BTN_Y) : HELD(PAD_BTN_DOWN);
+        pressed[2] = ext ? HELD(PAD_BTN_X) : HELD(PAD_BTN_LEFT);
+        pressed[3] = ext ? HELD(PAD_BTN_MODE) : HELD(PAD_BTN_RIGHT);
+        pressed[4] = HELD(PAD_BTN_B);
+        pressed[5] = HELD(PAD_BTN_C);
+    } else {
+        bool id = p == 5, release = p == 7;
+        pressed[0] = id || (!release && HELD(PAD_BTN_UP));
+        pressed[1] = id || (!release && HELD(PAD_BTN_DOWN));
+        pressed[2] = !release; // Left/Right read low while SELECT is low
+        pressed[3] = !release;
+        pressed[4] = HELD(PAD_BTN_A);
+        pressed[5] = HELD(PAD_BTN_START);
+    }
+#undef HELD
+
+    uint32_t lines = 0;
+    for (int i = 0; i < 6; ++i)
+        lines |= (uint32_t)!pressed[i] << i;
+    return lines;
+}
+
+static void drive_lines(void)
+{
+    uint32_t lines = pad_model_lines(kind, buttons, phase, sim_gpio_level(GPIO_PIN_SELECT));
+    for (int i = 0; i < 6; ++i)
+        sim_gpio_drive(data_pins[i], (lines >> i) & 1);
+}
+
+static void on_select(uint pin, bool level, void *arg)
+{
+    (void)pin;
+    (void)arg;
+    uint64_t now = sim_now_ns();
+    if (now - last_edge_ns > SIX_BUTTON_RESET_NS)
+        phase = level ? 0 : 1;
+    else
+        phase = (phase + 1) & 7;
+    last_edge_ns = now;
+    drive_lines();
+}
+
+void pad_model_init(sim_pad_kind_t k)
+{
+    kind = k;
+    buttons = 0;
+    phase = 0;
+    last_edge_ns = 0;
+    sim_gpio_watch(GPIO_PIN_SELECT, on_select, NULL);
+    drive_lines();
+}
+
+void pad_model_set_kind(sim_pad_kind_t k)
+{
+    kind = k;
+    phase = 0;
+    drive_lines();
+}
+
+void pad_model_set_buttons(pad_mask_t mask)
+{
+    buttons = mask;
+    drive_lines();
+}
+
+pad_mask_t pad_model_buttons(void)
+{
+    return buttons;
+}
+
+const char *pad_model_kind_name(sim_pad_kind_t k)
+{
+    return k == PAD_6BUTTON ? "6-button" : k == PAD_3BUTTON ? "3-button" : "none";
+}
+
+static const struct
+{
+    const char *name;
+    pad_mask_t bit;
+} button_names[] = {
+    {"UP", PAD_BTN_UP}, {"DOWN", PAD_BTN_DOWN}, {"LEFT", PAD_BTN_LEFT}, {"RIGHT", PAD_BTN_RIGHT},
+    {"A", PAD_BTN_A}, {"B", PAD_BTN_B}, {"C", PAD_BTN_C}, {"START", PAD_BTN_START},
+    {"X", PAD_BTN_X}, {"Y", PAD_BTN_Y}, {"Z", PAD_BTN_Z}, {"MODE", PAD_BTN_MODE},
+};
+
+pad_mask_t sim_parse_buttons(char *const *names, int count, bool *ok)
+{
+    pad_mask_t mask = 0;
+    *ok = true;
+    for (int i = 0; i < count; ++i) {
+        size_t b = 0;
+        while (b < sizeof(button_names) / sizeof(button_names[0]) && strcasecmp(names[i], button_names[b].name) != 0)
+            ++b;
+        if (b == sizeof(button_names) / sizeof(button_names[0]))
+            *ok = false;
+        else
+            mask |= button_names[b].bit;
+    }
+    return mask;
+}
+
+void sim_format_buttons(pad_mask_t mask, char *buf, size_t len)
+{
+    size_t used = 0;
+    buf[0] = '\0';
+    for (size_t b = 0; b < sizeof(button_names) / sizeof(button_names[0]); ++b) {
+        if (mask & button_names[b].bit)
+            used += snprintf(buf + used, used < len ? len - used : 0, "%s%s", used ? " " : "", button_names[b].name);
+    }
+    if (!mask)
+        snprintf(buf, len, "-");
+}
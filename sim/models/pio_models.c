@@ -0,0 +1,381 @@
+#include "models.h"
+#include <stdlib.h>
+
+/*
+ * Behavioural stand-ins for the firmware's PIO programs, matched by
+ * .program name. Each reproduces the program's pin/FIFO behaviour and
+ * timing in SM cycles, not its instructions.
+ */
+
+/*
+ * pad_sniffer: for each SELECT level in turn, a "jmp pin" loop that counts
+ * X down every two cycles until the level is seen, then "in x, 25 [31];
+ * in pins, 7; push noblock". A sample is taken 32 SM cycles after the edge
+ * is seen; the wait for the opposite level starts two cycles later, so an
+ * edge arriving during the settle delay is picked up only once that wait
+ * runs. X is modelled as virtual time in two-cycle ticks, settle included.
+ */
+typedef struct
+{
+    bool expect;        ///< SELECT level the program is waiting for
+    bool busy;          ///< In the settle delay / IN / PUSH
+    uint32_t edge_x;    ///< X when the edge was seen
+    sim_event_t *ev;
+} sniffer_state_t;
+
+static void sniffer_arm(sim_pio_sm_t *sm);
+
+static uint sniffer_select_pin(const sim_pio_sm_t *sm)
+{
+    return sm->cfg.in_base + 6;
+}
+
+static void sniffer_ready(void *arg)
+{
+    sim_pio_sm_t *sm = arg;
+    sniffer_state_t *s = sm->state;
+    s->busy = false;
+    s->ev = NULL;
+    sniffer_arm(sm);
+}
+
+static void sniffer_sample(void *arg)
+{
+    sim_pio_sm_t *sm = arg;
+    sniffer_state_t *s = sm->state;
+    uint32_t sample = (s->edge_x & 0x1FFFFFFu) << 7;
+    for (uint i = 0; i < 7; ++i)
+        sample |= (uint32_t)sim_gpio_level(sm->cfg.in_base + i) << i;
+    sim_pio_push(sm, sample);
+    s->expect = !s->expect;
+    s->ev = sim_schedule(sim_now_ns() + sim_pio_cycles_to_ns(sm, 2), SIM_MODEL, sniffer_ready, sm);
+}
+
+/**
+ * @brief Run the WAIT: start a capture if SELECT is already at the awaited level.
+ */
+static void sniffer_arm(sim_pio_sm_t *sm)
+{
+    sniffer_state_t *s = sm->state;
+    if (!sm->enabled || s->busy || sim_gpio_level(sniffer_select_pin(sm)) != s->expect)
+        return;
+    s->busy = true;
+    s->edge_x = -(uint32_t)(sim_pio_ns_to_cycles(sm, sim_now_ns()) / 2);
+    s->ev = sim_schedule(sim_now_ns() + sim_pio_cycles_to_ns(sm, 32), SIM_MODEL, sniffer_sample, sm);
+}
+
+static void sniffer_on_select(uint pin, bool level, void *arg)
+{
+    (void)pin;
+    (void)level;
+    sniffer_arm(arg);
+}
+
+static void sniffer_start(sim_pio_sm_t *sm)
+{
+    if (!sm->state) {
+        sm->state = calloc(1, sizeof(sniffer_state_t));
+        sim_gpio_watch(sniffer_select_pin(sm), sniffer_on_select, sm);
+    }
+    sniffer_state_t *s = sm->state;
+    s->expect = true; // .wrap_target waits for SELECT=1 first
+    s->busy = false;
+    sniffer_arm(sm);
+}
+
+static void sniffer_stop(sim_pio_sm_t *sm)
+{
+    sniffer_state_t *s = sm->state;
+    if (s && s->ev) {
+        sim_cancel(s->ev);
+        s->ev = NULL;
+    }
+    if (s)
+        s->busy = false;
+}
+
+static const sim_pio_model_t pad_sniffer_model = {"pad_sniffer", sniffer_start, sniffer_stop, NULL};
+
+/*
+ * tmss_skip: holds !VRES (SET pin) low until the pulse length arrives on
+ * the TX FIFO, releases it, asserts it again 3 cycles (2 synchroniser + 1)
+ * after !CART_CE (IN/JMP pin) falls, holds it for X+2 cycles, then counts
+ * 2-cycle loops until !CART_CE is low again and pushes ~count.
+ */
+enum
+{
+    TMSS_WAIT_ARM,
+    TMSS_WAIT_CART,
+    TMSS_PULSE,
+    TMSS_COUNT,
+    TMSS_DONE
+};
+
+typedef struct
+{
+    int stage;
+    uint32_t pulse_cycles;
+    uint64_t released_at;
+    sim_event_t *ev;
+} tmss_state_t;
+
+static void tmss_cart_check(sim_pio_sm_t *sm);
+
+static void tmss_vres(sim_pio_sm_t *sm, bool assert)
+{
+    sim_gpio_pio_drive(sm->cfg.set_base, assert, false);
+}
+
+static void tmss_step(void *arg)
+{
+    sim_pio_sm_t *sm = arg;
+    tmss_state_t *s = sm->state;
+    s->ev = NULL;
+    switch (s->stage) {
+    case TMSS_WAIT_ARM: // pull/mov/set done
+        tmss_vres(sm, false);
+        s->stage = TMSS_WAIT_CART;
+        tmss_cart_check(sm);
+        break;
+    case TMSS_WAIT_CART: // wait satisfied, set pindirs 1
+        tmss_vres(sm, true);
+        s->stage = TMSS_PULSE;
+        s->ev = sim_schedule(sim_now_ns() + sim_pio_cycles_to_ns(sm, s->pulse_cycles + 2), SIM_MODEL, tmss_step, sm);
+        break;
+    case TMSS_PULSE:
+        tmss_vres(sm, false);
+        s->released_at = sim_now_ns();
+        s->stage = TMSS_COUNT;
+        tmss_cart_check(sm);
+        break;
+    default:
+        break;
+    }
+}
+
+static void tmss_cart_check(sim_pio_sm_t *sm)
+{
+    tmss_state_t *s = sm->state;
+    if (!sm->enabled || s->ev || sim_gpio_level(sm->cfg.in_base))
+        return;
+    if (s->stage == TMSS_WAIT_CART) {
+        s->ev = sim_schedule(sim_now_ns() + sim_pio_cycles_to_ns(sm, 3), SIM_MODEL, tmss_step, sm);
+    } else if (s->stage == TMSS_COUNT) {
+        // Seen through the 2-cycle input synchroniser
+        uint64_t cycles = sim_pio_ns_to_cycles(sm, sim_now_ns() - s->released_at) + 2;
+        sim_pio_push(sm, ~(uint32_t)(1 + cycles / 2));
+        s->stage = TMSS_DONE;
+    }
+}
+
+static void tmss_on_cart(uint pin, bool level, void *arg)
+{
+    (void)pin;
+    (void)level;
+    tmss_cart_check(arg);
+}
+
+static void tmss_start(sim_pio_sm_t *sm)
+{
+    if (!sm->state) {
+        sm->state = calloc(1, sizeof(tmss_state_t));
+        sim_gpio_watch(sm->cfg.in_base, tmss_on_cart, sm);
+    }
+    tmss_state_t *s = sm->state;
+    s->stage = TMSS_WAIT_ARM;
+    s->ev = NULL;
+}
+
+static void tmss_stop(sim_pio_sm_t *sm)
+{
+    tmss_state_t *s = sm->state;
+    if (s && s->ev) {
+        sim_cancel(s->ev);
+        s->ev = NULL;
+    }
+}
+
+static void tmss_tx(sim_pio_sm_t *sm, uint32_t word)
+{
+    tmss_state_t *s = sm->state;
+    if (s->stage != TMSS_WAIT_ARM || s->ev)
+        return;
+    s->pulse_cycles = word;
+    s->ev = sim_schedule(sim_now_ns() + sim_pio_cycles_to_ns(sm, 3), SIM_MODEL, tmss_step, sm);
+}
+
+static const sim_pio_model_t tmss_skip_model = {"tmss_skip", tmss_start, tmss_stop, tmss_tx};
+
+/*
+ * logic_analyzer: "in pins, 16" every SM cycle, autopush at 32 with the
+ * earlier sample in the low half. Rather than one event per sample, words
+ * are pushed in batches of a FIFO's worth; a change on a sampled pin first
+ * pushes every sample taken before it, so each sample carries the level it
+ * would have had on hardware.
+ */
+#define LA_MODEL_PINS  16
+#define LA_MODEL_BATCH 8   ///< Words per batch event (joined RX FIFO depth)
+
+typedef struct
+{
+    uint16_t levels;      ///< Pin levels since the last change
+    uint64_t start_ns;    ///< Time of sample 0
+    uint64_t samples;     ///< Samples taken so far
+    uint32_t word;        ///< Low half waiting for its partner
+    sim_event_t *ev;
+} la_model_state_t;
+
+/**
+ * @brief Take every sample due before @p until_ns with the current levels.
+ */
+static void la_model_catch_up(sim_pio_sm_t *sm, uint64_t until_ns)
+{
+    la_model_state_t *s = sm->state;
+    double period = sim_pio_cycles_to_ns(sm, 1000000) / 1e6;
+    while (s->start_ns + (uint64_t)(s->samples * period) < until_ns) {
+        if (s->samples++ & 1)
+            sim_pio_push(sm, s->word | (uint32_t)s->levels << 16);
+        else
+            s->word = s->levels;
+    }
+}
+
+static void la_model_batch(void *arg)
+{
+    sim_pio_sm_t *sm = arg;
+    la_model_state_t *s = sm->state;
+    la_model_catch_up(sm, sim_now_ns() + 1);
+    s->ev = sim_schedule(sim_now_ns() + sim_pio_cycles_to_ns(sm, 2 * LA_MODEL_BATCH), SIM_MODEL, la_model_batch, sm);
+}
+
+static void la_model_on_pin(uint pin, bool level, void *arg)
+{
+    sim_pio_sm_t *sm = arg;
+    la_model_state_t *s = sm->state;
+    if (!sm->enabled)
+        return;
+    la_model_catch_up(sm, sim_now_ns());
+    uint16_t bit = (uint16_t)(1u << (pin - sm->cfg.in_base));
+    s->levels = level ? (s->levels | bit) : (s->levels & ~bit);
+}
+
+static void la_model_start(sim_pio_sm_t *sm)
+{
+    if (!sm->state) {
+        sm->state = calloc(1, sizeof(la_model_state_t));
+        for (uint i = 0; i < LA_MODEL_PINS; ++i)
+            sim_gpio_watch(sm->cfg.in_base + i, la_model_on_pin, sm);
+    }
+    la_model_state_t *s = sm->state;
+    s->levels = 0;
+    for (uint i = 0; i < LA_MODEL_PINS; ++i)
+        s->levels |= (uint16_t)(sim_gpio_level(sm->cfg.in_base + i) << i);
+    s->start_ns = sim_now_ns();
+    s->samples = 0;
+    s->ev = sim_schedule(sim_now_ns(), SIM_MODEL, la_model_batch, sm);
+}
+
+static void la_model_stop(sim_pio_sm_t *sm)
+{
+    la_model_state_t *s = sm->state;
+    if (s && s->ev) {
+        sim_cancel(s->ev);
+        s->ev = NULL;
+    }
+}
+
+static const sim_pio_model_t logic_analyzer_model = {"logic_analyzer", la_model_start, la_model_stop, NULL};
+
+/*
+ * frame_sync: after seeing the input high, a falling edge is looked at again
+ * 32 cycles later; if still low, X counts down, ~X is pushed and IRQ 0
+ * raised, then the pin is ignored for the 1024-cycle hold-off.
+ */
+typedef struct
+{
+    bool armed;           ///< Seen high since the last pulse or hold-off
+    bool busy;            ///< Filter delay or hold-off running
+    uint32_t x;
+    sim_event_t *ev;
+} frame_sync_state_t;
+
+static void frame_sync_arm(sim_pio_sm_t *sm);
+
+static void frame_sync_ready(void *arg)
+{
+    sim_pio_sm_t *sm = arg;
+    frame_sync_state_t *s = sm->state;
+    s->busy = false;
+    s->ev = NULL;
+    frame_sync_arm(sm);
+}
+
+static void frame_sync_check(void *arg)
+{
+    sim_pio_sm_t *sm = arg;
+    frame_sync_state_t *s = sm->state;
+    uint32_t cycles = 1;   // jmp pin
+    if (!sim_gpio_level(sm->cfg.in_base)) {
+        sim_pio_push(sm, ~--s->x);
+        sim_pio_raise_irq(sm, 0);
+        cycles = 1024;
+    }
+    s->ev = sim_schedule(sim_now_ns() + sim_pio_cycles_to_ns(sm, cycles), SIM_MODEL, frame_sync_ready, sm);
+}
+
+/**
+ * @brief Run the WAITs: note a high level, start the filter delay on a low one.
+ */
+static void frame_sync_arm(sim_pio_sm_t *sm)
+{
+    frame_sync_state_t *s = sm->state;
+    if (!sm->enabled || s->busy)
+        return;
+    if (sim_gpio_level(sm->cfg.in_base)) {
+        s->armed = true;
+    } else if (s->armed) {
+        s->armed = false;
+        s->busy = true;
+        s->ev = sim_schedule(sim_now_ns() + sim_pio_cycles_to_ns(sm, 32), SIM_MODEL, frame_sync_check, sm);
+    }
+}
+
+static void frame_sync_on_pin(uint pin, bool level, void *arg)
+{
+    (void)pin;
+    (void)level;
+    frame_sync_arm(arg);
+}
+
+static void frame_sync_start(sim_pio_sm_t *sm)
+{
+    if (!sm->state) {
+        sm->state = calloc(1, sizeof(frame_sync_state_t));
+        sim_gpio_watch(sm->cfg.in_base, frame_sync_on_pin, sm);
+    }
+    frame_sync_state_t *s = sm->state;
+    s->armed = false;
+    s->busy = false;
+    frame_sync_arm(sm);
+}
+
+static void frame_sync_stop(sim_pio_sm_t *sm)
+{
+    frame_sync_state_t *s = sm->state;
+    if (s && s->ev) {
+        sim_cancel(s->ev);
+        s->ev = NULL;
+    }
+    if (s)
+        s->busy = false;
+}
+
+static const sim_pio_model_t frame_sync_model = {"frame_sync", frame_sync_start, frame_sync_stop, NULL};
+
+void pio_models_register(void)
+{
+    sim_pio_register_model(&pad_sniffer_model);
+    sim_pio_register_model(&tmss_skip_model);
+    sim_pio_register_model(&logic_analyzer_model);
+    sim_pio_register_model(&frame_sync_model);
+}
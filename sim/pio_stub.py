@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Generate a host-side <name>.pio.h for the simulation.
+
+The header has the same shape as pioasm's C-SDK output (program struct,
+wrap constants, default config, and the "% c-sdk" block copied verbatim),
+but carries the .program name instead of instruction encodings: the
+simulated PIO runs a behavioural model per program, not the instructions.
+Only the instruction count matters for PIO memory allocation.
+"""
+
+import re
+import sys
+
+
+def parse(text):
+    programs = []
+    prog = None
+    in_c_sdk = False
+    for raw in text.splitlines():
+        if in_c_sdk:
+            if raw.strip() == "%}":
+                in_c_sdk = False
+            else:
+                prog["c_sdk"].append(raw)
+            continue
+        line = raw.split(";", 1)[0].strip()
+        if not line:
+            continue
+        if line.startswith("% c-sdk"):
+            in_c_sdk = True
+            continue
+        if line.startswith(".program"):
+            prog = {"name": line.split()[1], "length": 0, "origin": -1,
+                    "wrap_target": 0, "wrap": None, "c_sdk": []}
+            programs.append(prog)
+            continue
+        if prog is None:
+            continue
+        if line.startswith(".wrap_target"):
+            prog["wrap_target"] = prog["length"]
+        elif line.startswith(".wrap"):
+            prog["wrap"] = prog["length"] - 1
+        elif line.startswith(".origin"):
+            prog["origin"] = int(line.split()[1], 0)
+        elif line.startswith("."):
+            continue  # .side_set, .define, ...
+        elif re.fullmatch(r"[A-Za-z_]\w*:", line):
+            continue  # label
+        else:
+            prog["length"] += 1
+    for p in programs:
+        if p["wrap"] is None:
+            p["wrap"] = p["length"] - 1
+    return programs
+
+
+def emit(programs, out):
+    out.write("// Generated by sim/pio_stub.py for the host simulation -- do not edit\n")
+    out.write("#pragma once\n\n#include \"hardware/pio.h\"\n")
+    for p in programs:
+        n = p["name"]
+        out.write(f"""
+#define {n}_wrap_target {p['wrap_target']}
+#define {n}_wrap {p['wrap']}
+
+static const uint16_t {n}_program_instructions[{p['length']}] = {{0}};
+
+static const struct pio_program {n}_program = {{
+    .instructions = {n}_program_instructions,
+    .length = {p['length']},
+    .origin = {p['origin']},
+    .name = "{n}",
+}};
+
+static inline pio_sm_config {n}_program_get_default_config(uint offset)
+{{
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + {n}_wrap_target, offset + {n}_wrap);
+    return c;
+}}
+""")
+        if p["c_sdk"]:
+            out.write("\n" + "\n".join(p["c_sdk"]) + "\n")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: pio_stub.py <input.pio> <output.pio.h>")
+    with open(sys.argv[1]) as f:
+        programs = parse(f.read())
+    if not programs:
+        sys.exit(f"{sys.argv[1]}: no .program found")
+    with open(sys.argv[2], "w") as out:
+        emit(programs, out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,742 @@
+#include "sim.h"
+#include "models.h"
+#include "setup.h"
+#include "display.h"
+#include "sega_logo.h"
+#include "pico-ssd1306/ssd1306.h"
+#include "pad_channel.h"
+#include "pad_sniffer.h"
+#include "pad_decoder.h"
+#include "config_store.h"
+#include "tmss_skip.h"
+#include "trace.h"
+#include "scheduler.h"
+#include "clock_control.h"
+#include "structs.h"
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Open Heart host simulation
+ * --------------------------
+ * Runs the unmodified firmware (main.c and everything it pulls in) against
+ * the mock HAL, with a pad, a game polling it and an OLED panel modelled
+ * around it. Virtual time runs as fast as the host allows, so hours of
+ * scripted input take seconds. --bench instead times the firmware's hot
+ * paths on the host, for use under perf/valgrind.
+ */
+
+#define DEFAULT_RUN_NS  (10000 * SIM_NS_PER_MS)
+#define DEFAULT_FRAME_HZ 59.92 ///< NTSC: 53.693175 MHz / (3420 * 262)
+#define OLED_ADDRESS    0x3C
+#define MAX_ARGS        12
+
+extern int openheart_main(void);
+extern system_status_t system_status;
+
+typedef struct
+{
+    uint64_t at_ns;
+    int line;
+    int argc;
+    char *argv[MAX_ARGS];
+} scenario_step_t;
+
+static struct
+{
+    uint64_t run_ns;
+    const char *scenario;
+    const char *flash;
+    sim_pad_kind_t pad;
+    sim_poll_kind_t poll;
+    double frame_hz;
+    bool no_tmss;
+    bool dump_oled;
+    bool bench;
+    const char *events;
+    int clock_mode;         ///< clock_mode_t, or -1 for MCLK_CLOCK_MODE
+} opt = {DEFAULT_RUN_NS, NULL, NULL, PAD_6BUTTON, POLL_6BUTTON, DEFAULT_FRAME_HZ, false, false, false, NULL, -1};
+
+static int expect_failures;
+static int expect_checks;
+
+/* ---- helpers ---- */
+
+static bool parse_duration(const char *s, uint64_t *ns)
+{
+    char *end;
+    double v = strtod(s, &end);
+    if (end == s || v < 0)
+        return false;
+    if (!*end || strcmp(end, "ms") == 0)
+        *ns = (uint64_t)(v * SIM_NS_PER_MS);
+    else if (strcmp(end, "s") == 0)
+        *ns = (uint64_t)(v * 1e9);
+    else if (strcmp(end, "us") == 0)
+        *ns = (uint64_t)(v * SIM_NS_PER_US);
+    else if (strcmp(end, "min") == 0)
+        *ns = (uint64_t)(v * 60e9);
+    else if (strcmp(end, "h") == 0)
+        *ns = (uint64_t)(v * 3600e9);
+    else
+        return false;
+    return true;
+}
+
+static bool parse_pad_kind(const char *s, sim_pad_kind_t *kind)
+{
+    if (strcmp(s, "3") == 0)
+        *kind = PAD_3BUTTON;
+    else if (strcmp(s, "6") == 0)
+        *kind = PAD_6BUTTON;
+    else if (strcmp(s, "none") == 0)
+        *kind = PAD_NONE;
+    else
+        return false;
+    return true;
+}
+
+static bool parse_region(const char *s, region_t *region)
+{
+    static const char *const names[] = {"JPN", "USA", "EUR", "BRA"};
+    for (int i = 0; i < 4; ++i) {
+        if (strcmp(s, names[i]) == 0) {
+            *region = (region_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_clock_mode(const char *s, int *mode)
+{
+    if (strcmp(s, "relock") == 0)
+        *mode = CLOCK_MODE_RELOCK;
+    else if (strcmp(s, "prelocked") == 0)
+        *mode = CLOCK_MODE_PRELOCKED;
+    else if (strcmp(s, "decoupled") == 0)
+        *mode = CLOCK_MODE_DECOUPLED;
+    else
+        return false;
+    return true;
+}
+
+static bool parse_poll_kind(const char *s, sim_poll_kind_t *kind)
+{
+    if (strcmp(s, "3") == 0)
+        *kind = POLL_3BUTTON;
+    else if (strcmp(s, "6") == 0)
+        *kind = POLL_6BUTTON;
+    else if (strcmp(s, "3x2") == 0)
+        *kind = POLL_3BUTTON_TWICE;
+    else if (strcmp(s, "6slow") == 0)
+        *kind = POLL_6BUTTON_SLOW;
+    else if (strcmp(s, "none") == 0)
+        *kind = POLL_NONE;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief Console response metric by scenario name.
+ */
+static const sim_latency_t *latency_by_name(const char *s)
+{
+    const sim_console_latency_t *l = console_model_latency();
+    if (strcmp(s, "hotkey") == 0)
+        return &l->hotkey;
+    if (strcmp(s, "tmss") == 0)
+        return &l->tmss_skip;
+    if (strcmp(s, "jumpers") == 0)
+        return &l->region_jumpers;
+    if (strcmp(s, "restart") == 0)
+        return &l->region_restart;
+    if (strcmp(s, "boot") == 0)
+        return &l->boot;
+    return NULL;
+}
+
+static double host_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ---- scenario ---- */
+
+/**
+ * @brief Execute one scenario line at its virtual time.
+ */
+static void scenario_step(void *arg)
+{
+    scenario_step_t *step = arg;
+    const char *cmd = step->argv[0];
+    char **args = step->argv + 1;
+    int nargs = step->argc - 1;
+    bool ok = true;
+
+    if (strcmp(cmd, "press") == 0) {
+        pad_mask_t old = pad_model_buttons();
+        pad_model_set_buttons(old | sim_parse_buttons(args, nargs, &ok));
+        console_model_pad_changed(old, pad_model_buttons());
+    } else if (strcmp(cmd, "release") == 0) {
+        pad_mask_t old = pad_model_buttons();
+        pad_mask_t mask = nargs ? sim_parse_buttons(args, nargs, &ok) : (pad_mask_t)~0u;
+        pad_model_set_buttons(old & ~mask);
+        console_model_pad_changed(old, pad_model_buttons());
+    } else if (strcmp(cmd, "pad") == 0 && nargs == 1) {
+        sim_pad_kind_t kind;
+        if ((ok = parse_pad_kind(args[0], &kind)))
+            pad_model_set_kind(kind);
+    } else if (strcmp(cmd, "game") == 0 && nargs == 1) {
+        sim_poll_kind_t kind;
+        if ((ok = parse_poll_kind(args[0], &kind)))
+            console_model_set_poll(kind);
+    } else if (strcmp(cmd, "reset") == 0 && nargs <= 1) {
+        uint64_t hold_ns = 100 * SIM_NS_PER_MS;
+        if (nargs == 0 || (ok = parse_duration(args[0], &hold_ns)))
+            console_model_press_reset(hold_ns);
+    } else if (strcmp(cmd, "expect") == 0 && nargs == 2 && strcmp(args[0], "region") == 0) {
+        // The firmware's idea of the region and the jumpers it drives must agree
+        region_t want;
+        if ((ok = parse_region(args[1], &want))) {
+            bool ntsc = sim_gpio_level(GPIO_STANDARD_PIN), export = sim_gpio_level(GPIO_REGION_PIN);
+            bool jumpers_ok = ntsc == (want != REGION_EUR) && export == (want != REGION_JPN);
+            expect_checks++;
+            if (system_status.region != want || !jumpers_ok) {
+                printf("[%10.3f ms] line %d: expected region %s, firmware has %d (jumpers %s/%s)\n", sim_now_ns() / 1e6, step->line,
+                       args[1], system_status.region, ntsc ? "NTSC" : "PAL", export ? "export" : "Japan");
+                expect_failures++;
+            }
+        }
+    } else if (strcmp(cmd, "expect") == 0 && (nargs == 2 || nargs == 3) && strcmp(args[0], "vclk") == 0) {
+        // VCLK must be MCLK/div within 0.1%, or the given tolerance where the PWM divider
+        // runs from another PLL than MCLK and only has its 4-bit fraction to follow it
+        char *end, *tol_end = NULL;
+        double div = strtod(args[1], &end);
+        double tol = nargs == 3 ? strtod(args[2], &tol_end) / 100 : 0.001;
+        if ((ok = end != args[1] && !*end && div > 0 && (nargs == 2 || (tol_end != args[2] && strcmp(tol_end, "%") == 0)))) {
+            double vclk = sim_pwm_freq_hz(pwm_gpio_to_slice_num(GPIO_VCLK_PIN));
+            double seen = vclk > 0 ? sim_mclk_hz() / vclk : 0;
+            expect_checks++;
+            if (seen < div * (1 - tol) || seen > div * (1 + tol)) {
+                printf("[%10.3f ms] line %d: expected VCLK = MCLK/%s, firmware has MCLK/%.3f\n", sim_now_ns() / 1e6, step->line, args[1], seen);
+                expect_failures++;
+            }
+        }
+    } else if (strcmp(cmd, "expect") == 0 && nargs == 2 && strcmp(args[0], "resets") == 0) {
+        // Resets the firmware issued while the cart ran: in-game resets and region switches
+        char *end;
+        unsigned long want = strtoul(args[1], &end, 10);
+        if ((ok = end != args[1] && !*end)) {
+            uint32_t seen = console_model_stats()->game_resets;
+            expect_checks++;
+            if (seen != want) {
+                printf("[%10.3f ms] line %d: expected %s firmware resets, console saw %u\n", sim_now_ns() / 1e6, step->line, args[1], seen);
+                expect_failures++;
+            }
+        }
+    } else if (strcmp(cmd, "expect") == 0 && nargs == 1 && strcmp(args[0], "vclk_swaps") == 0) {
+        // Every staged divider swap so far landed on a wrap by DMA: none mid-phase, none forced
+        const sim_pwm_stats_t *pw = sim_pwm_stats();
+        expect_checks++;
+        if (!pw->div_swaps || pw->div_swaps_off_wrap || system_status.vclk_swap_timeouts) {
+            printf("[%10.3f ms] line %d: expected VCLK swaps on the wrap, %u staged, %u off the wrap, %u forced\n", sim_now_ns() / 1e6,
+                   step->line, pw->div_swaps, pw->div_swaps_off_wrap, system_status.vclk_swap_timeouts);
+            expect_failures++;
+        }
+    } else if (strcmp(cmd, "expect") == 0 && nargs == 1 && strcmp(args[0], "clk_peri") == 0) {
+        // clk_peri must run at the rate the SDK recorded, or UART/SPI baud rates are off
+        double real = sim_clk_peri_hz(), told = clock_get_hz(clk_peri);
+        expect_checks++;
+        if (real < told * 0.999 || real > told * 1.001) {
+            printf("[%10.3f ms] line %d: expected clk_peri at the recorded %.3f MHz, it runs at %.3f MHz\n", sim_now_ns() / 1e6,
+                   step->line, told / 1e6, real / 1e6);
+            expect_failures++;
+        }
+    } else if (strcmp(cmd, "expect") == 0 && nargs == 2 && strcmp(args[0], "led") == 0) {
+        // Which half of the DMA-fed bi-color LED is lit right now: LED1 on channel A, LED2 on channel B
+        static const char *const colors[] = {"off", "led1", "led2", "both"};
+        uint32_t cc = pwm_hw->slice[pwm_gpio_to_slice_num(GPIO_LED1_PIN)].cc;
+        const char *seen = colors[((cc & 0xFFFF) ? 1 : 0) | ((cc >> 16) ? 2 : 0)];
+        ok = false;
+        for (size_t i = 0; i < sizeof(colors) / sizeof(colors[0]); ++i)
+            ok |= strcmp(args[1], colors[i]) == 0;
+        if (ok) {
+            expect_checks++;
+            if (strcmp(args[1], seen) != 0) {
+                printf("[%10.3f ms] line %d: expected LED %s, firmware shows %s (LED1 %u, LED2 %u)\n", sim_now_ns() / 1e6, step->line,
+                       args[1], seen, cc & 0xFFFF, cc >> 16);
+                expect_failures++;
+            }
+        }
+    } else if (strcmp(cmd, "expect") == 0 && nargs >= 1 && strcmp(args[0], "pad") == 0) {
+        pad_mask_t want = (nargs == 2 && strcmp(args[1], "-") == 0) ? 0 : sim_parse_buttons(args + 1, nargs - 1, &ok);
+        pad_mask_t seen = pad_mask_from_state(&system_status.pad);
+        expect_checks++;
+        if (ok && seen != want) {
+            char w[96], s[96];
+            sim_format_buttons(want, w, sizeof(w));
+            sim_format_buttons(seen, s, sizeof(s));
+            printf("[%10.3f ms] line %d: expected pad '%s', firmware has '%s'\n", sim_now_ns() / 1e6, step->line, w, s);
+            expect_failures++;
+        }
+    } else if (strcmp(cmd, "expect") == 0 && nargs == 3 && strcmp(args[0], "latency") == 0) {
+        // Every response of that kind so far, and at least one, within the limit
+        const sim_latency_t *l = latency_by_name(args[1]);
+        uint64_t limit_ns;
+        if ((ok = l && parse_duration(args[2], &limit_ns))) {
+            expect_checks++;
+            if (!l->count || l->max_ns > limit_ns) {
+                printf("[%10.3f ms] line %d: expected %s latency within %s, firmware took %.3f us at worst over %u\n", sim_now_ns() / 1e6,
+                       step->line, args[1], args[2], l->max_ns / 1e3, l->count);
+                expect_failures++;
+            }
+        }
+    } else if (strcmp(cmd, "oled") == 0) {
+        printf("[%10.3f ms] panel:\n", sim_now_ns() / 1e6);
+        oled_model_dump(stdout);
+    } else if (strcmp(cmd, "stop") == 0) {
+        sim_stop();
+    } else {
+        ok = false;
+    }
+
+    if (!ok)
+        sim_panic("scenario line %d: cannot parse '%s'", step->line, cmd);
+    sim_log("scenario line %d: %s", step->line, cmd);
+}
+
+/**
+ * @brief Load a scenario file and schedule its steps.
+ *        Each line is "<time> <command> [args]"; times are absolute and take
+ *        us/ms/s/min/h suffixes (ms when omitted). '#' starts a comment.
+ */
+static bool scenario_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+
+        scenario_step_t *step = calloc(1, sizeof(*step));
+        char *save, *tok = strtok_r(line, " \t\r\n", &save);
+        if (!tok) {
+            free(step);
+            continue;
+        }
+        if (!parse_duration(tok, &step->at_ns)) {
+            fprintf(stderr, "%s:%d: bad time '%s'\n", path, line_no, tok);
+            fclose(f);
+            return false;
+        }
+        while ((tok = strtok_r(NULL, " \t\r\n", &save)) && step->argc < MAX_ARGS)
+            step->argv[step->argc++] = strdup(tok);
+        if (!step->argc) {
+            fprintf(stderr, "%s:%d: missing command\n", path, line_no);
+            fclose(f);
+            return false;
+        }
+        step->line = line_no;
+        sim_schedule(step->at_ns, SIM_MODEL, scenario_step, step);
+    }
+    fclose(f);
+    return true;
+}
+
+/* ---- report ---- */
+
+static void report(uint64_t ran_ns, double host_s)
+{
+    const sim_clock_stats_t *clk = sim_clock_stats();
+    const sim_flash_stats_t *fl = sim_flash_stats();
+    const sim_oled_stats_t *oled = oled_model_stats();
+    const tmss_stats_t *tmss = tmss_skip_stats();
+    const sim_console_stats_t *con = console_model_stats();
+    const trace_stats_t *tr = trace_stats();
+    char model[96], seen[96];
+
+    sim_format_buttons(pad_model_buttons(), model, sizeof(model));
+    sim_format_buttons(pad_mask_from_state(&system_status.pad), seen, sizeof(seen));
+
+    printf("virtual time   %.3f s in %.3f s host (%.0fx real time)\n", ran_ns / 1e9, host_s, ran_ns / 1e9 / (host_s > 0 ? host_s : 1e-9));
+    printf("cpu            core0 busy %.3f ms, core1 busy %.3f ms\n", sim_core_busy_ns(0) / 1e6, sim_core_busy_ns(1) / 1e6);
+    printf("console        %s, %u game starts, %u licence screens, %u resets (%u by button, %u in game), %u halts (%.3f ms halted)\n",
+           opt.no_tmss ? "no TMSS" : "TMSS", con->game_starts, con->tmss_screens, con->resets, con->button_presses, con->game_resets,
+           con->halts, con->halted_ns / 1e6);
+    printf("               TMSS skip armed %u, landed %u, missed %u, last %u ns\n",
+           tmss->armed, tmss->landed, tmss->missed, tmss->last_latency_ns);
+    printf("pad            %s pad, game polls %s, %u frames, %u SELECT edges\n",
+           pad_model_kind_name(opt.pad), console_model_poll_name(opt.poll), console_model_frames(), console_model_select_edges());
+    printf("               held: %s / firmware sees: %s\n", model, seen);
+    printf("               channel dropped %u, sniffer overruns %u\n", pad_channel_dropped(), pad_sniffer_overruns());
+    printf("display        %u bytes queued, %u on the bus, %u transactions, %u data bytes, panel %s\n",
+           display_get_bus_bytes(), sim_i2c_bytes(), oled->transactions, oled->data_bytes, oled->display_on ? "on" : "off");
+    printf("clocks         MCLK %.6f MHz, VCLK %.6f MHz, clk_sys %.3f MHz, clk_peri %.3f MHz (recorded %.3f)\n",
+           sim_mclk_hz() / 1e6, sim_pwm_freq_hz(pwm_gpio_to_slice_num(GPIO_VCLK_PIN)) / 1e6, clock_get_hz(clk_sys) / 1e6,
+           sim_clk_peri_hz() / 1e6, clock_get_hz(clk_peri) / 1e6);
+    printf("               %u PLL locks, %u GPOUT stops, %u live switches, %u live relocks, MCLK down %.3f ms\n",
+           clk->pll_locks, clk->gpout_stops, clk->live_switches, clk->relocks_live, clk->mclk_down_ns / 1e6);
+    printf("               %u VCLK swaps staged, %u off the wrap, %u forced after a timeout\n",
+           sim_pwm_stats()->div_swaps, sim_pwm_stats()->div_swaps_off_wrap, system_status.vclk_swap_timeouts);
+    printf("flash          %u sector erases, %u page programs, %u safe executes, %.3f ms stalled\n",
+           fl->erases, fl->programs, fl->safe_executes, fl->stall_ns / 1e6);
+    printf("trace          %u/%u events recorded (core 0/1), %u/%u dropped, %u sent to the host\n",
+           tr->recorded[0], tr->recorded[1], tr->dropped[0], tr->dropped[1], tr->drained);
+    bool first = true;
+    for (unsigned core = 0; core < NUM_CORES; ++core) {
+        for (uint8_t i = 0; i < sched_task_count(core); ++i, first = false) {
+            const sched_stats_t *st = sched_stats(core, i);
+            printf("%-14s core%u %-9s %6u runs, %u missed, late avg %.1f us max %u us, run max %u us\n", first ? "scheduler" : "",
+                   core, sched_task(core, i)->name, st->runs, st->misses, st->runs ? (double)st->total_late_us / st->runs : 0.0,
+                   st->max_late_us, st->max_run_us);
+        }
+    }
+    static const char *const metrics[] = {"hotkey", "tmss", "jumpers", "restart", "boot"};
+    for (size_t i = 0; i < sizeof(metrics) / sizeof(metrics[0]); ++i) {
+        const sim_latency_t *l = latency_by_name(metrics[i]);
+        if (l->count)
+            printf("%-14s %-8s n %u, min %.3f us, avg %.3f us, max %.3f us\n", i ? "" : "latency", metrics[i], l->count,
+                   l->min_ns / 1e3, l->total_ns / 1e3 / l->count, l->max_ns / 1e3);
+    }
+    if (expect_checks)
+        printf("expectations   %d checked, %d failed\n", expect_checks, expect_failures);
+}
+
+/* ---- bench ---- */
+
+#define BENCH_SAMPLES_PER_POLL 128
+#define BENCH_DECODER_FRAMES   (1u << 18)
+#define BENCH_DECODER_PASSES   8
+#define BENCH_SCREENS          20000
+
+static void bench_print(const char *name, double host_s, uint64_t ops, const char *unit)
+{
+    printf("%-28s %10.1f ns/%s  (%llu %ss)\n", name, host_s * 1e9 / (double)ops, unit, (unsigned long long)ops, unit);
+}
+
+/**
+ * @brief A canned stream of console reads for the decoder: 6-button,
+ *        3-button and cut-short cycles, one per frame, with random buttons.
+ */
+typedef struct
+{
+    uint32_t *samples;
+    uint32_t *times_us;
+    uint32_t *frame_end;   ///< Index after each frame's last sample
+    pad_mask_t *want;      ///< Buttons each frame must decode to
+    size_t count;
+} bench_stream_t;
+
+static volatile pad_mask_t bench_sink; ///< Keeps the timed decode loop from being optimised away
+
+static void bench_stream_build(bench_stream_t *st)
+{
+    // Full 6-button, 3-button, stops after X/Y/Z/MODE, stops before the ID, stops right after the ID
+    static const uint8_t edges[] = {8, 2, 6, 4, 5, 8, 2, 6};
+    st->samples = malloc(BENCH_DECODER_FRAMES * 8 * sizeof(uint32_t));
+    st->times_us = malloc(BENCH_DECODER_FRAMES * 8 * sizeof(uint32_t));
+    st->frame_end = malloc(BENCH_DECODER_FRAMES * sizeof(uint32_t));
+    st->want = malloc(BENCH_DECODER_FRAMES * sizeof(pad_mask_t));
+    st->count = 0;
+
+    uint32_t seed = 1, time_us = 0;
+    pad_mask_t buttons = 0, ext = 0;
+    bool ext_read = false;
+    for (uint32_t f = 0; f < BENCH_DECODER_FRAMES; ++f) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        if (seed & 0x100) {
+            // A d-pad can't press opposite directions: Up+Down would read as the 6-button ID
+            buttons = (pad_mask_t)(seed >> 16) & 0x0FFF;
+            if ((buttons & (PAD_BTN_UP | PAD_BTN_DOWN)) == (PAD_BTN_UP | PAD_BTN_DOWN))
+                buttons &= ~PAD_BTN_DOWN;
+            if ((buttons & (PAD_BTN_LEFT | PAD_BTN_RIGHT)) == (PAD_BTN_LEFT | PAD_BTN_RIGHT))
+                buttons &= ~PAD_BTN_RIGHT;
+        }
+        uint n = edges[seed & 7];
+        // Edges 2 us apart starting from idle high: low, high, low, ...
+        for (uint e = 0; e < n; ++e) {
+            bool select = e & 1;
+            st->samples[st->count] = pad_model_lines(PAD_6BUTTON, buttons, e + 1, select) | (select ? PAD_SAMPLE_SELECT_BIT : 0);
+            st->times_us[st->count++] = time_us + 2 * e;
+        }
+        // X/Y/Z/MODE: read this frame, kept from a full cycle, or cleared after any other
+        if (n >= 6)
+            ext = buttons & 0x0F00;
+        else if (!ext_read)
+            ext = 0;
+        ext_read = n >= 6;
+        st->frame_end[f] = (uint32_t)st->count;
+        st->want[f] = (buttons & 0x00FF) | ext;
+        time_us += 16683;
+    }
+}
+
+/**
+ * @brief Time the firmware hot paths on the host. Runs as core 0.
+ *        Virtual time only advances where the firmware needs the models
+ *        (sniffer samples, I2C transfers); the host timer covers only the
+ *        firmware calls themselves.
+ */
+static void bench_entry(void)
+{
+    // Sniffer decode: one game frame's worth of 6-button reads per sample group
+    pad_sniffer_init();
+    joypad_state_t pad = {0};
+    double t = 0;
+    uint64_t samples = 0;
+    for (int round = 0; round < 2000; ++round) {
+        pad_model_set_buttons(round & 1 ? PAD_BTN_A | PAD_BTN_X : PAD_BTN_UP | PAD_BTN_MODE);
+        for (int e = 0; e < BENCH_SAMPLES_PER_POLL; ++e) {
+            sim_gpio_drive(GPIO_PIN_SELECT, e & 1);
+            sleep_us(2);
+        }
+        double t0 = host_seconds();
+        pad_sniffer_poll(&pad);
+        t += host_seconds() - t0;
+        samples += BENCH_SAMPLES_PER_POLL;
+    }
+    bench_print("pad_sniffer_poll", t, samples, "sample");
+
+    // Decoder alone over a canned stream, checked frame by frame outside the timing
+    bench_stream_t st;
+    bench_stream_build(&st);
+    pad_decoder_t dec;
+    pad_decoder_init(&dec, PAD_CYCLE_GAP_US);
+    uint32_t wrong = 0;
+    for (uint32_t f = 0, i = 0; f < BENCH_DECODER_FRAMES; ++f) {
+        for (; i < st.frame_end[f]; ++i)
+            pad_decoder_feed(&dec, st.samples[i], st.times_us[i]);
+        wrong += dec.mask != st.want[f];
+    }
+    pad_mask_t sink = 0;
+    t = host_seconds();
+    for (int pass = 0; pass < BENCH_DECODER_PASSES; ++pass)
+        for (size_t i = 0; i < st.count; ++i)
+            sink ^= pad_decoder_feed(&dec, st.samples[i], st.times_us[i]);
+    t = host_seconds() - t;
+    bench_sink = sink;
+    bench_print("pad_decoder_feed", t, (uint64_t)st.count * BENCH_DECODER_PASSES, "sample");
+    printf("%-28s %10.1f M samples/s, %u of %u frames decoded wrong\n", "", st.count * BENCH_DECODER_PASSES / t / 1e6, wrong,
+           BENCH_DECODER_FRAMES);
+    free(st.samples);
+    free(st.times_us);
+    free(st.frame_end);
+    free(st.want);
+
+    // Pad channel round trip
+    pad_snapshot_t snap;
+    double t0 = host_seconds();
+    for (uint32_t i = 0; i < 1000000; ++i) {
+        pad_channel_publish((pad_mask_t)i, i);
+        pad_channel_pop(&snap);
+    }
+    bench_print("pad_channel publish+pop", host_seconds() - t0, 1000000, "pair");
+
+    // Status screen: alternate between two pad states so every call redraws
+    display_init();
+    t = 0;
+    for (int i = 0; i < 5000; ++i) {
+        joypad_state_t p = {.a = i & 1, .up = !(i & 1), .start = (i & 3) == 0};
+        double t1 = host_seconds();
+        display_update_status(REGION_USA, (i & 8) ? 10740 : 0, p);
+        t += host_seconds() - t1;
+        while (display_busy())
+            sleep_us(100);
+    }
+    bench_print("display_update_status", t, 5000, "call");
+
+    // Full-screen image: RLE expanded into the back buffer
+    t0 = host_seconds();
+    for (int i = 0; i < 100000; ++i)
+        display_draw_image(&sega_logo, 0, 0, 0);
+    bench_print("display_draw_image (logo)", host_seconds() - t0, 100000, "frame");
+
+    // Full screen of text, 21 characters per line: the library's pixel path against the blits
+    static const char line[] = "A+B+C+START 10.74MHz!";
+    static uint8_t ref_buffer[1 + 128 * 8], blank[128 * 8], pattern[128 * 8];
+    for (size_t i = 0; i < sizeof(pattern); ++i)
+        pattern[i] = (uint8_t)(i * 37);
+    ssd1306_t ref = {.width = 128, .height = 64, .pages = 8, .bufsize = 128 * 8, .buffer = ref_buffer + 1};
+    t0 = host_seconds();
+    for (int i = 0; i < BENCH_SCREENS; ++i) {
+        ssd1306_clear(&ref);
+        for (uint32_t page = 0; page < 8; ++page)
+            ssd1306_draw_string(&ref, 0, page * 8, 1, line);
+    }
+    bench_print("ssd1306_draw_string (screen)", host_seconds() - t0, BENCH_SCREENS, "frame");
+    t0 = host_seconds();
+    for (int i = 0; i < BENCH_SCREENS; ++i)
+        for (uint8_t page = 0; page < 8; ++page)
+            display_draw_text(0, page * 8, line);
+    bench_print("display_draw_text (screen)", host_seconds() - t0, BENCH_SCREENS, "frame");
+    t0 = host_seconds();
+    for (int i = 0; i < BENCH_SCREENS; ++i)
+        for (uint8_t band = 0; band < 7; ++band)
+            display_draw_text(3, band * 8 + 3, line);
+    bench_print("display_draw_text (y+3)", host_seconds() - t0, BENCH_SCREENS, "frame");
+    t0 = host_seconds();
+    for (int i = 0; i < BENCH_SCREENS; ++i)
+        display_draw_bitmap(pattern, 128, 7, 0, 3);
+    bench_print("display_draw_bitmap (y+3)", host_seconds() - t0, BENCH_SCREENS, "frame");
+
+    // The unaligned blits must land exactly where the library puts the pixels
+    display_draw_bitmap(blank, 128, 8, 0, 0);
+    ssd1306_clear(&ref);
+    for (uint8_t band = 0; band < 7; ++band) {
+        display_draw_text(3, band * 8 + 3, line);
+        ssd1306_draw_string(&ref, 3, band * 8 + 3, 1, line);
+    }
+    while (!display_present())
+        sleep_us(100);
+    while (display_busy())
+        sleep_us(100);
+    printf("%-28s %s\n", "", memcmp(oled_model_gddram(), ref.buffer, 128 * 8) ? "unaligned text DIFFERS from the library" : "unaligned text matches the library");
+
+    // Config log append (flash is a host array, so this is the record search + copy)
+    config_t cfg = {CONFIG_MAGIC, REGION_JPN, false, 0};
+    t0 = host_seconds();
+    for (int i = 0; i < 2000; ++i) {
+        cfg.region = (region_t)(i % 3);
+        save_config(&cfg);
+    }
+    bench_print("save_config", host_seconds() - t0, 2000, "save");
+
+    t0 = host_seconds();
+    for (int i = 0; i < 100000; ++i)
+        load_config(&cfg);
+    bench_print("load_config", host_seconds() - t0, 100000, "load");
+
+    sim_stop();
+}
+
+/* ---- main ---- */
+
+static void firmware_entry(void)
+{
+    openheart_main();
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -t, --time <dur>       virtual time to run (default 10s; us/ms/s/min/h)\n"
+            "  -s, --scenario <file>  scripted input, see sim/scenarios/\n"
+            "      --pad 3|6|none     controller in port 1 (default 6)\n"
+            "      --game 3|6|3x2|6slow|none\n"
+            "                         how the game reads it (default 6; 3x2 reads twice a\n"
+            "                         frame, 6slow with compiled-code timing, both jittered)\n"
+            "      --frame-hz <hz>    console frame rate (default %.2f)\n"
+            "      --no-tmss          console without TMSS (boots straight into the cart)\n"
+            "      --clock-mode relock|prelocked|decoupled\n"
+            "                         MCLK clocking mode (default from setup.h)\n"
+            "      --flash <file>     load the flash image from, and save it back to, <file>\n"
+            "      --dump-oled        print the panel contents at the end\n"
+            "      --events <file>    log stimuli and firmware responses as CSV\n"
+            "      --bench            time the firmware hot paths on the host\n"
+            "  -v, --verbose          log model and clock events\n",
+            argv0, DEFAULT_FRAME_HZ);
+}
+
+int main(int argc, char **argv)
+{
+    enum { OPT_PAD = 256, OPT_GAME, OPT_FRAME_HZ, OPT_NO_TMSS, OPT_CLOCK_MODE, OPT_FLASH, OPT_DUMP_OLED, OPT_EVENTS, OPT_BENCH };
+    static const struct option long_opts[] = {
+        {"time", required_argument, NULL, 't'},
+        {"scenario", required_argument, NULL, 's'},
+        {"pad", required_argument, NULL, OPT_PAD},
+        {"game", required_argument, NULL, OPT_GAME},
+        {"frame-hz", required_argument, NULL, OPT_FRAME_HZ},
+        {"no-tmss", no_argument, NULL, OPT_NO_TMSS},
+        {"clock-mode", required_argument, NULL, OPT_CLOCK_MODE},
+        {"flash", required_argument, NULL, OPT_FLASH},
+        {"dump-oled", no_argument, NULL, OPT_DUMP_OLED},
+        {"events", required_argument, NULL, OPT_EVENTS},
+        {"bench", no_argument, NULL, OPT_BENCH},
+        {"verbose", no_argument, NULL, 'v'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int c;
+    bool ok = true;
+    while ((c = getopt_long(argc, argv, "t:s:vh", long_opts, NULL)) != -1) {
+        switch (c) {
+        case 't': ok = parse_duration(optarg, &opt.run_ns); break;
+        case 's': opt.scenario = optarg; break;
+        case OPT_PAD: ok = parse_pad_kind(optarg, &opt.pad); break;
+        case OPT_GAME: ok = parse_poll_kind(optarg, &opt.poll); break;
+        case OPT_FRAME_HZ: opt.frame_hz = atof(optarg); ok = opt.frame_hz > 0; break;
+        case OPT_NO_TMSS: opt.no_tmss = true; break;
+        case OPT_CLOCK_MODE: ok = parse_clock_mode(optarg, &opt.clock_mode); break;
+        case OPT_FLASH: opt.flash = optarg; break;
+        case OPT_DUMP_OLED: opt.dump_oled = true; break;
+        case OPT_EVENTS: opt.events = optarg; break;
+        case OPT_BENCH: opt.bench = true; break;
+        case 'v': sim_verbose = true; break;
+        default: usage(argv[0]); return c == 'h' ? 0 : 2;
+        }
+        if (!ok) {
+            fprintf(stderr, "bad value for option: %s\n", optarg);
+            return 2;
+        }
+    }
+
+    sim_init();
+    sim_gpio_reset();
+    sim_dma_reset();
+    sim_pio_reset();
+    sim_clocks_reset();
+    sim_flash_reset();
+    pio_models_register();
+    if (opt.flash && !sim_flash_load(opt.flash))
+        fprintf(stderr, "note: %s not loaded, starting from erased flash\n", opt.flash);
+
+    pad_model_init(opt.pad);
+    oled_model_init(OLED_ADDRESS);
+    if (!opt.bench)
+        console_model_init(opt.poll, opt.frame_hz, !opt.no_tmss);
+    FILE *events = NULL;
+    if (opt.events && !opt.bench) {
+        if (!(events = fopen(opt.events, "w"))) {
+            fprintf(stderr, "cannot write events to %s\n", opt.events);
+            return 2;
+        }
+        console_model_log_to(events);
+    }
+    if (opt.clock_mode >= 0)
+        set_clock_mode((clock_mode_t)opt.clock_mode);
+    if (opt.scenario && !scenario_load(opt.scenario)) {
+        fprintf(stderr, "cannot load scenario %s\n", opt.scenario);
+        return 2;
+    }
+
+    sim_start_core0(opt.bench ? bench_entry : firmware_entry);
+    double host_start = host_seconds();
+    sim_run(opt.bench ? SIM_NEVER : opt.run_ns);
+    double host_s = host_seconds() - host_start;
+
+    if (!opt.bench)
+        report(sim_now_ns(), host_s);
+    if (opt.dump_oled)
+        oled_model_dump(stdout);
+    if (opt.flash && !sim_flash_save(opt.flash))
+        fprintf(stderr, "cannot save flash image to %s\n", opt.flash);
+    if (events)
+        fclose(events);
+    return expect_failures ? 1 : 0;
+}
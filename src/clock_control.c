@@ -1,8 +1,11 @@
 #include "hardware/clocks.h"
+#include "hardware/dma.h"
 #include "hardware/gpio.h"
 #include "hardware/pll.h"
 #include "hardware/pwm.h"
+#include "hardware/xosc.h"
 #include "clock_control.h"
+#include "clock_plan.h"
 #include "setup.h"
 
 /**
@@ -10,20 +13,118 @@
  */
 typedef struct
 {
-    uint32_t pll_sys_hz; ///< PLL system frequency in Hz
-    uint8_t postdiv1;    ///< First post-divider
-    uint8_t postdiv2;    ///< Second post-divider
+    uint32_t vco_hz;      ///< PLL VCO frequency in Hz (reference divider CLOCK_PLAN_REFDIV)
+    uint8_t postdiv1;     ///< First post-divider
+    uint8_t postdiv2;     ///< Second post-divider
+    uint8_t prelocked_src; ///< GPOUT0 aux source feeding MCLK when both PLLs are pre-locked
 } region_clock_t;
 
-// Table of region clock settings (PLL in Hz and dividers)
-// These values are chosen to generate frequencies as close as possible to video standards
+#define CLOCK_PLAN(std) CLOCK_PLAN_##std##_VCO_HZ, CLOCK_PLAN_##std##_POSTDIV1, CLOCK_PLAN_##std##_POSTDIV2
+
+// Table of region clock settings, from the generated clock plan (tools/clock_plan.py).
+// In CLOCK_MODE_PRELOCKED PLL_SYS holds the NTSC plan and PLL_USB the PAL plan. There is
+// no third PLL for PAL-M, so BRA runs on the NTSC clock there (53.7 MHz, +0.12% against
+// PAL-M's 53.634 MHz, closer than PAL's 53.2 MHz); its PAL-M plan is used by the other modes.
 static const region_clock_t region_clocks[] = {
-    [REGION_JPN] = {1074 * MHZ, 5, 2}, // 53.700000 MHz (NTSC/JPN/USA)
-    [REGION_USA] = {1074 * MHZ, 5, 2}, // 53.700000 MHz (NTSC/JPN/USA)
-    [REGION_EUR] = {1596 * MHZ, 3, 5}, // 53.200000 MHz (PAL/EUR)
-    [REGION_BRA] = {1075 * MHZ, 5, 2}, // 53.800000 MHz (BR)
+    [REGION_JPN] = {CLOCK_PLAN(NTSC), CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS},
+    [REGION_USA] = {CLOCK_PLAN(NTSC), CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS},
+    [REGION_EUR] = {CLOCK_PLAN(PAL), CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB},
+    [REGION_BRA] = {CLOCK_PLAN(PALM), CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS}, // NTSC when pre-locked
 };
 
+// The plan is checked here rather than trusted: a VCO that is not a whole multiple of the
+// reference is silently truncated by pll_init(), which is how BRA once ran on the NTSC clock.
+#define PLAN_REF_HZ (XOSC_HZ / CLOCK_PLAN_REFDIV)
+#define PLAN_PLL_OK(vco, pd1, pd2)                                                        \
+    ((vco) >= 750 * MHZ && (vco) <= 1600 * MHZ && (vco) % PLAN_REF_HZ == 0 &&            \
+     (vco) / PLAN_REF_HZ >= 16 && (vco) / PLAN_REF_HZ <= 320 && PLAN_REF_HZ >= 5 * MHZ && \
+     (pd1) >= 1 && (pd1) <= 7 && (pd2) >= 1 && (pd2) <= 7)
+#define MCLK_PPM(src, std)                                                                \
+    (((int64_t)CLOCK_PLAN_##src##_VCO_HZ * 1000000 /                                      \
+      (CLOCK_PLAN_##src##_POSTDIV1 * CLOCK_PLAN_##src##_POSTDIV2 * CLOCK_PLAN_##src##_GPOUT_DIV) - \
+      (int64_t)CLOCK_PLAN_##std##_TARGET_HZ * 1000000) / CLOCK_PLAN_##std##_TARGET_HZ)
+#define PLAN_PPM(std) MCLK_PPM(std, std)
+#define PLAN_OK(std)                                                                      \
+    (PLAN_PLL_OK(CLOCK_PLAN_##std##_VCO_HZ, CLOCK_PLAN_##std##_POSTDIV1, CLOCK_PLAN_##std##_POSTDIV2) && \
+     PLAN_PPM(std) <= CLOCK_PLAN_MAX_PPM && PLAN_PPM(std) >= -CLOCK_PLAN_MAX_PPM)
+
+_Static_assert(PLAN_OK(NTSC), "NTSC clock plan outside the PLL limits or CLOCK_PLAN_MAX_PPM");
+_Static_assert(PLAN_OK(PAL), "PAL clock plan outside the PLL limits or CLOCK_PLAN_MAX_PPM");
+_Static_assert(PLAN_OK(PALM), "PAL-M clock plan outside the PLL limits or CLOCK_PLAN_MAX_PPM");
+// GPOUT0 keeps its divider when CLOCK_MODE_PRELOCKED swaps its source
+_Static_assert(CLOCK_PLAN_NTSC_GPOUT_DIV == CLOCK_PLAN_PAL_GPOUT_DIV &&
+               CLOCK_PLAN_NTSC_GPOUT_DIV == CLOCK_PLAN_PALM_GPOUT_DIV, "clock plans need one GPOUT divider");
+#define MCLK_GPOUT_DIV CLOCK_PLAN_NTSC_GPOUT_DIV
+// The MCLK each region actually gets, from the plan of the PLL it runs on in MCLK_CLOCK_MODE
+#define REGION_PPM(std, prelocked_std) \
+    (MCLK_CLOCK_MODE == CLOCK_MODE_PRELOCKED ? MCLK_PPM(prelocked_std, std) : MCLK_PPM(std, std))
+#define REGION_OK(std, prelocked_std) \
+    (REGION_PPM(std, prelocked_std) <= CLOCK_PLAN_MAX_PPM && REGION_PPM(std, prelocked_std) >= -CLOCK_PLAN_MAX_PPM)
+_Static_assert(REGION_OK(NTSC, NTSC), "JPN/USA MCLK outside CLOCK_PLAN_MAX_PPM");
+_Static_assert(REGION_OK(PAL, PAL), "EUR MCLK outside CLOCK_PLAN_MAX_PPM");
+_Static_assert(REGION_OK(PALM, NTSC), "BRA MCLK outside CLOCK_PLAN_MAX_PPM: CLOCK_MODE_PRELOCKED runs it on the NTSC "
+                                      "PLL, ~+1230 ppm off PAL-M; raise CLOCK_PLAN_MAX_PPM to accept that");
+#ifdef PLL_SYS_REFDIV
+// set_sys_clock_pll() always locks PLL_SYS with PLL_SYS_REFDIV
+_Static_assert(PLL_SYS_REFDIV == CLOCK_PLAN_REFDIV, "PLL_SYS_REFDIV does not match the clock plan");
+#endif
+
+// CLOCK_MODE_DECOUPLED: clk_sys fixed at 144 MHz (1440 MHz / 5 / 2), which also divides
+// down to exactly 48 MHz for USB. MCLK is re-locked on PLL_USB alone.
+#define DECOUPLED_SYS_VCO_HZ    (1440 * MHZ)
+#define DECOUPLED_SYS_POSTDIV1  5
+#define DECOUPLED_SYS_POSTDIV2  2
+#define DECOUPLED_SYS_HZ        (144 * MHZ)
+#define USB_CLK_HZ              (48 * MHZ)
+_Static_assert(PLAN_PLL_OK(DECOUPLED_SYS_VCO_HZ, DECOUPLED_SYS_POSTDIV1, DECOUPLED_SYS_POSTDIV2) &&
+               DECOUPLED_SYS_VCO_HZ / (DECOUPLED_SYS_POSTDIV1 * DECOUPLED_SYS_POSTDIV2) == DECOUPLED_SYS_HZ &&
+               DECOUPLED_SYS_HZ % USB_CLK_HZ == 0, "decoupled clk_sys plan");
+
+// VCLK PWM dividers per overclock step, generated for MCLK_CLOCK_MODE from VCLK_DIV_STOCK and
+// VCLK_OC_LADDER. Checked for the clocks vclk_pwm_div() will see (BRA on the NTSC lock when
+// pre-locked), the DIV register's 8.4 range, and the error the PWM fraction leaves: VCLK_MAX_PPM
+// when the PWM shares MCLK's PLL, VCLK_ASYNC_MAX_PPM when it does not (the opt-in modes).
+#define PLAN_OUT_HZ(std) (CLOCK_PLAN_##std##_VCO_HZ / (CLOCK_PLAN_##std##_POSTDIV1 * CLOCK_PLAN_##std##_POSTDIV2))
+#define VCLK_PLAN_SRC_HZ(std, prelocked_std) \
+    (MCLK_CLOCK_MODE == CLOCK_MODE_PRELOCKED ? PLAN_OUT_HZ(prelocked_std) : PLAN_OUT_HZ(std))
+#define VCLK_PLAN_SYS_HZ(std)                                            \
+    (MCLK_CLOCK_MODE == CLOCK_MODE_DECOUPLED   ? DECOUPLED_SYS_HZ       \
+     : MCLK_CLOCK_MODE == CLOCK_MODE_PRELOCKED ? PLAN_OUT_HZ(NTSC)      \
+                                               : PLAN_OUT_HZ(std))
+#define VCLK_PLAN_OK(std, prelocked_std)                                                         \
+    (CLOCK_PLAN_##std##_VCLK_SYS_HZ == VCLK_PLAN_SYS_HZ(std) &&                                  \
+     CLOCK_PLAN_##std##_VCLK_SRC_HZ == VCLK_PLAN_SRC_HZ(std, prelocked_std) &&                   \
+     CLOCK_PLAN_##std##_VCLK_PWM_DIV16_MIN >= 1 << 4 && CLOCK_PLAN_##std##_VCLK_PWM_DIV16_MAX <= 0xFFF && \
+     CLOCK_PLAN_##std##_VCLK_MAX_PPM <=                                                           \
+         (VCLK_PLAN_SYS_HZ(std) == VCLK_PLAN_SRC_HZ(std, prelocked_std) ? VCLK_MAX_PPM : VCLK_ASYNC_MAX_PPM))
+
+_Static_assert(CLOCK_PLAN_VCLK_MODE == MCLK_CLOCK_MODE && CLOCK_PLAN_VCLK_DIV_STOCK == VCLK_DIV_STOCK &&
+               CLOCK_PLAN_VCLK_OC_STEPS == sizeof((uint8_t[])VCLK_OC_LADDER), "clock plan generated for another VCLK setup");
+_Static_assert(VCLK_PLAN_OK(NTSC, NTSC), "NTSC VCLK dividers outside the PWM range or VCLK_MAX_PPM/VCLK_ASYNC_MAX_PPM");
+_Static_assert(VCLK_PLAN_OK(PAL, PAL), "PAL VCLK dividers outside the PWM range or VCLK_MAX_PPM/VCLK_ASYNC_MAX_PPM");
+_Static_assert(VCLK_PLAN_OK(PALM, NTSC), "PAL-M VCLK dividers outside the PWM range or VCLK_MAX_PPM/VCLK_ASYNC_MAX_PPM");
+
+static clock_mode_t clock_mode = MCLK_CLOCK_MODE;
+static bool plls_prelocked = false;
+static bool sys_clock_decoupled = false;
+static uint32_t mclk_src_hz; ///< Frequency feeding GPOUT0 (MCLK_GPOUT_DIV x MCLK)
+static uint32_t sys_clk_hz;  ///< clk_sys as of the last setup_vclk_pwm_div(), for the RAM-resident paths
+static uint32_t vclk_scale;  ///< clk_sys / (2 x MCLK) in 12.20 fixed point
+static uint32_t vclk_pwm_div16; ///< PWM divider currently set for VCLK, in 1/16ths
+static int vclk_dma_chan = -1;  ///< Writes a staged divider on the next VCLK edge
+static uint32_t vclk_staged_div; ///< PWM DIV register value waiting for that edge
+
+/**
+ * @brief PWM divider for a VCLK divider, also recorded for clock_get_vclk_hz().
+ * @param div16 Divider relative to MCLK, in 1/16ths.
+ * @return PWM divider in 1/16ths: div16 * clk_sys / (2 x MCLK), rounded.
+ */
+static inline uint32_t vclk_pwm_div(uint32_t div16)
+{
+    vclk_pwm_div16 = (div16 * vclk_scale + (1u << 19)) >> 20;
+    return vclk_pwm_div16;
+}
+
 /**
  * @brief Get the clock configuration for a given region.
  *        Defaults to NTSC/JPN if region is invalid.
@@ -37,6 +138,120 @@ static inline const region_clock_t *get_region_clock(region_t region)
     return &region_clocks[REGION_JPN];
 }
 
+/**
+ * @brief Output frequency of a region's PLL settings.
+ * @param rc Region clock settings.
+ * @return PLL output frequency in Hz.
+ */
+static inline uint32_t region_pll_out_hz(const region_clock_t *rc)
+{
+    return rc->vco_hz / (rc->postdiv1 * rc->postdiv2);
+}
+
+/**
+ * @brief Frequency of the pre-locked PLL a region's MCLK is taken from.
+ * @param rc Region clock settings.
+ * @return PLL output frequency in Hz.
+ */
+static inline uint32_t prelocked_src_hz(const region_clock_t *rc)
+{
+    if (rc->prelocked_src == CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB)
+        return region_pll_out_hz(&region_clocks[REGION_EUR]);
+    return region_pll_out_hz(&region_clocks[REGION_USA]);
+}
+
+/**
+ * @brief Lock PLL_SYS on the NTSC plan and PLL_USB on the PAL plan, once.
+ *        set_sys_clock_pll() runs clk_sys from PLL_USB while PLL_SYS locks and leaves
+ *        clk_peri on PLL_USB, both assuming 48 MHz, so it runs first. PLL_USB then no
+ *        longer provides 48 MHz: USB is stopped, and clk_peri, ADC and RTC are moved
+ *        off it before it is re-locked.
+ */
+static void prelock_plls(void)
+{
+    const region_clock_t *ntsc = &region_clocks[REGION_USA];
+    const region_clock_t *pal = &region_clocks[REGION_EUR];
+
+    set_sys_clock_pll(ntsc->vco_hz, ntsc->postdiv1, ntsc->postdiv2);
+
+    uint32_t sys_hz = region_pll_out_hz(ntsc);
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS, sys_hz, sys_hz);
+    clock_stop(clk_usb);
+    clock_configure(clk_adc, 0, CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_XOSC_CLKSRC, XOSC_HZ, XOSC_HZ);
+    clock_configure(clk_rtc, 0, CLOCKS_CLK_RTC_CTRL_AUXSRC_VALUE_XOSC_CLKSRC, XOSC_HZ, XOSC_HZ / 256);
+    pll_init(pll_usb, CLOCK_PLAN_REFDIV, pal->vco_hz, pal->postdiv1, pal->postdiv2);
+    plls_prelocked = true;
+}
+
+/**
+ * @brief Stop GPOUT0 (MCLK) cleanly.
+ *        Clearing ENABLE lets the generator finish its current cycle and park low,
+ *        so stopping never produces a runt pulse.
+ */
+static void __not_in_flash_func(gpout_stop)(void)
+{
+    if (!mclk_src_hz)
+        return; // never started
+
+    hw_clear_bits(&clocks_hw->clk[clk_gpout0].ctrl, CLOCKS_CLK_GPOUT0_CTRL_ENABLE_BITS);
+    // The enable takes up to 2 source cycles to propagate; wait 3 to be safe
+    busy_wait_at_least_cycles(3 * (sys_clk_hz / mclk_src_hz + 1));
+}
+
+/**
+ * @brief Move GPOUT0 (MCLK) to another aux source without runt pulses.
+ *        The aux mux itself is not glitchless, so the generator is stopped first,
+ *        the source is swapped while it is idle, and it restarts on the new PLL.
+ *        MCLK is held low for a few cycles instead of the milliseconds a PLL re-lock takes.
+ * @param auxsrc CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_* source.
+ */
+static void __not_in_flash_func(gpout_switch_auxsrc)(uint32_t auxsrc)
+{
+    clock_hw_t *gpout = &clocks_hw->clk[clk_gpout0];
+
+    gpout_stop();
+    hw_write_masked(&gpout->ctrl, auxsrc << CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_LSB, CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_BITS);
+    hw_set_bits(&gpout->ctrl, CLOCKS_CLK_GPOUT0_CTRL_ENABLE_BITS);
+}
+
+/**
+ * @brief Run clk_sys from a fixed PLL_SYS plan and free PLL_USB for MCLK.
+ *        USB is re-sourced from PLL_SYS (144 MHz / 3), clk_peri (which
+ *        set_sys_clock_pll() leaves on PLL_USB) from clk_sys, and the ADC and RTC
+ *        clocks move to the crystal, so later PLL_USB re-locks only affect MCLK.
+ */
+static void decouple_sys_clock(void)
+{
+    set_sys_clock_pll(DECOUPLED_SYS_VCO_HZ, DECOUPLED_SYS_POSTDIV1, DECOUPLED_SYS_POSTDIV2);
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS, DECOUPLED_SYS_HZ, DECOUPLED_SYS_HZ);
+    clock_configure(clk_usb, 0, CLOCKS_CLK_USB_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, DECOUPLED_SYS_HZ, USB_CLK_HZ);
+    clock_configure(clk_adc, 0, CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_XOSC_CLKSRC, XOSC_HZ, XOSC_HZ);
+    clock_configure(clk_rtc, 0, CLOCKS_CLK_RTC_CTRL_AUXSRC_VALUE_XOSC_CLKSRC, XOSC_HZ, XOSC_HZ / 256);
+    sys_clock_decoupled = true;
+}
+
+/**
+ * @brief Re-lock PLL_USB on a region's plan and drive MCLK from it.
+ *        MCLK is parked low while the PLL re-locks; clk_sys is untouched.
+ * @param rc Region clock settings.
+ */
+static void relock_mclk_pll(const region_clock_t *rc)
+{
+    gpout_stop();
+    pll_init(pll_usb, CLOCK_PLAN_REFDIV, rc->vco_hz, rc->postdiv1, rc->postdiv2);
+    mclk_src_hz = region_pll_out_hz(rc);
+    clock_gpio_init(GPIO_MCLK_PIN, CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, MCLK_GPOUT_DIV);
+}
+
+/**
+ * @brief Select how MCLK is produced. Takes effect on the next init_clock_output().
+ * @param mode The clocking mode.
+ */
+void set_clock_mode(clock_mode_t mode)
+{
+    clock_mode = mode;
+}
+
 /**
  * @brief Set the system PLL and output clock for the selected region.
  * @param region The region to configure.
@@ -44,11 +259,20 @@ static inline const region_clock_t *get_region_clock(region_t region)
 void set_clock_region(region_t region)
 {
     const region_clock_t *rc = get_region_clock(region);
-    set_sys_clock_pll(rc->pll_sys_hz, rc->postdiv1, rc->postdiv2);
-    clock_gpio_init(GPIO_MCLK_PIN, CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, 2);
 
-    // Set VCLK (CPU clock for 68000) divider to 7 for all regions
-    setup_vclk_pwm_div(7);
+    if (clock_mode == CLOCK_MODE_PRELOCKED && plls_prelocked) {
+        gpout_switch_auxsrc(rc->prelocked_src);
+        mclk_src_hz = prelocked_src_hz(rc);
+    } else if (clock_mode == CLOCK_MODE_DECOUPLED && sys_clock_decoupled) {
+        relock_mclk_pll(rc);
+    } else {
+        set_sys_clock_pll(rc->vco_hz, rc->postdiv1, rc->postdiv2);
+        mclk_src_hz = region_pll_out_hz(rc);
+        clock_gpio_init(GPIO_MCLK_PIN, CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, MCLK_GPOUT_DIV);
+    }
+
+    // Set VCLK (CPU clock for 68000) to the stock divider for all regions
+    setup_vclk_pwm_div(VCLK_DIV_STOCK);
 }
 
 /**
@@ -60,26 +284,121 @@ void init_clock_output(region_t initial_region)
 {
     gpio_set_drive_strength(GPIO_MCLK_PIN, GPIO_DRIVE_STRENGTH_8MA);
     gpio_set_slew_rate(GPIO_MCLK_PIN, GPIO_SLEW_RATE_FAST);
+
+    if (clock_mode == CLOCK_MODE_PRELOCKED) {
+        const region_clock_t *rc = get_region_clock(initial_region);
+        prelock_plls();
+        mclk_src_hz = prelocked_src_hz(rc);
+        clock_gpio_init(GPIO_MCLK_PIN, rc->prelocked_src, MCLK_GPOUT_DIV);
+        setup_vclk_pwm_div(VCLK_DIV_STOCK);
+        return;
+    }
+
+    if (clock_mode == CLOCK_MODE_DECOUPLED)
+        decouple_sys_clock();
+
     set_clock_region(initial_region);
 }
 
 /**
  * @brief Configure VCLK (CPU clock for Motorola 68000) using PWM.
- *        VCLK is generated with PWM, sourced from pll_sys (the MCLK source).
- *        The wrap value divides by 2 to get MCLK rate, then the divider sets the final CPU clock.
- * @param div Divider value for the PWM clock.
+ *        VCLK is generated with PWM, sourced from clk_sys. The wrap value divides by 2,
+ *        then the divider sets the final CPU clock, using its 4-bit fraction both for
+ *        fractional MCLK dividers and to follow MCLK when it comes from the other PLL.
+ *        Each half period is one counter step, so with a fraction the high and low
+ *        phases differ by at most one clk_sys cycle (~7-9 ns).
+ * @param div16 Divider relative to MCLK, in 1/16ths (VCLK = MCLK * 16 / div16).
  */
-void setup_vclk_pwm_div(uint32_t div)
+void setup_vclk_pwm_div(uint32_t div16)
 {
     gpio_set_function(GPIO_VCLK_PIN, GPIO_FUNC_PWM);
 
     uint32_t slice = pwm_gpio_to_slice_num(GPIO_VCLK_PIN);
 
+    if (vclk_dma_chan < 0) {
+        // One word into the slice's DIV register, paced by the slice's wrap: see stage_vclk_div()
+        vclk_dma_chan = dma_claim_unused_channel(true);
+        dma_channel_config c = dma_channel_get_default_config(vclk_dma_chan);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, pwm_get_dreq(slice));
+        dma_channel_configure(vclk_dma_chan, &c, &pwm_hw->slice[slice].div, &vclk_staged_div, 1, false);
+    }
+    // A swap still pending for the old clock plan must not land on the new one
+    dma_channel_abort(vclk_dma_chan);
+
+    sys_clk_hz = clock_get_hz(clk_sys);
+    vclk_scale = mclk_src_hz ? (uint32_t)(((uint64_t)sys_clk_hz * MCLK_GPOUT_DIV << 19) / mclk_src_hz) : 1u << 20;
+
     // Set up a 50% duty cycle PWM based on the system clock/MCLK speed and the specified divider
-    pwm_set_clkdiv_int_frac(slice, div, 0);
+    uint32_t pwm_div16 = vclk_pwm_div(div16);
+    pwm_set_clkdiv_int_frac(slice, pwm_div16 >> 4, pwm_div16 & 0xF);
     pwm_set_clkdiv_mode(slice, PWM_DIV_FREE_RUNNING);
     pwm_set_phase_correct(slice, false);
     pwm_set_wrap(slice, 1); // Wrap value of 1 gives us PWM at MCLK rate
     pwm_set_chan_level(slice, pwm_gpio_to_channel(GPIO_VCLK_PIN), 1);
     pwm_set_enabled(slice, true);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Stage a new divider for the running VCLK PWM; it takes effect on the next VCLK edge.
+ *        RAM-resident, inline SDK calls only, for use from the console executor;
+ *        setup_vclk_pwm_div() must have run since the last clock plan change.
+ *        A DMA channel paced by the slice's wrap DREQ writes the DIV register a few
+ *        clk_sys cycles after the counter wraps (the rising edge), inside the first
+ *        counter step of the new period. The CPU never writes DIV mid-phase, so
+ *        there is no runt or stretched phase beyond the one that starts the new rate.
+ * @param div16 Divider relative to MCLK, in 1/16ths.
+ */
+void __not_in_flash_func(stage_vclk_div)(uint32_t div16)
+{
+    uint slice = pwm_gpio_to_slice_num(GPIO_VCLK_PIN);
+    uint32_t pwm_div16 = vclk_pwm_div(div16);
+    vclk_staged_div = (pwm_div16 >> 4) << PWM_CH0_DIV_INT_LSB | (pwm_div16 & 0xF) << PWM_CH0_DIV_FRAC_LSB;
+    // The wrap DREQ stays raised until CC is written: rewrite it so the transfer waits for the next wrap
+    uint32_t cc = pwm_hw->slice[slice].cc;
+    pwm_set_both_levels(slice, cc >> PWM_CH0_CC_A_LSB & 0xFFFF, cc >> PWM_CH0_CC_B_LSB);
+    dma_channel_start(vclk_dma_chan);
+}
+
+/**
+ * @brief Whether the divider passed to stage_vclk_div() is in place. RAM-resident.
+ * @return true once the swap has happened.
+ */
+bool __not_in_flash_func(vclk_div_swapped)(void)
+{
+    return !dma_channel_is_busy(vclk_dma_chan);
+}
+
+/**
+ * @brief Put the divider passed to stage_vclk_div() in place now, if the staged
+ *        write has not landed: cancels the DMA transfer and writes DIV directly.
+ *        RAM-resident; only call with the 68000 halted, as the write may land mid-phase.
+ */
+void __not_in_flash_func(force_vclk_div)(void)
+{
+    dma_channel_abort(vclk_dma_chan);
+    pwm_set_clkdiv_int_frac(pwm_gpio_to_slice_num(GPIO_VCLK_PIN), vclk_staged_div >> PWM_CH0_DIV_INT_LSB,
+                            vclk_staged_div >> PWM_CH0_DIV_FRAC_LSB & 0xF);
+}
+
+/**
+ * @brief VCLK as currently generated, fraction included.
+ * @return Frequency in Hz, 0 before VCLK is set up.
+ */
+uint32_t clock_get_vclk_hz(void)
+{
+    // Two PWM counter steps per VCLK period
+    return vclk_pwm_div16 ? (uint32_t)((uint64_t)sys_clk_hz * 8 / vclk_pwm_div16) : 0;
+}
+
+/**
+ * @brief Whether clk_usb runs at the 48 MHz USB needs. Not in CLOCK_MODE_PRELOCKED,
+ *        where PLL_USB holds the PAL plan and clk_usb is stopped.
+ * @return true if USB stdio can be brought up.
+ */
+bool clock_usb_running(void)
+{
+    return clock_get_hz(clk_usb) == USB_CLK_HZ;
+}
@@ -0,0 +1,264 @@
+#include "config_store.h"
+#include "setup.h"
+#include "trace.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include "pico/stdlib.h"
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Log-structured config store
+ * ---------------------------
+ * Each save appends a 16-byte record to a log spread over the last
+ * CONFIG_STORE_SECTORS sectors of flash. A record is written by programming
+ * its page with 0xFF everywhere except the record itself, which leaves the
+ * neighbouring records untouched (NOR programming only clears bits). The
+ * newest record with a valid magic and CRC wins at boot. A sector is erased
+ * only when the log wraps into it, so erases are spread over all sectors
+ * and happen once every CONFIG_RECORDS_PER_SECTOR saves.
+ */
+
+/**
+ * @brief On-flash record layout (16 bytes, never straddles a page).
+ */
+typedef struct
+{
+    uint32_t magic;       ///< CONFIG_MAGIC
+    uint32_t seq;         ///< Save counter, the highest valid one is current
+    uint8_t region;       ///< Saved region setting
+    uint8_t overclocked;  ///< Overclocking enabled/disabled
+    uint8_t oc_step;      ///< Overclock ladder step (0xFF in records saved before the ladder)
+    uint8_t reserved;     ///< Left erased (0xFF) for future fields
+    uint32_t crc;         ///< CRC-32 of the preceding 12 bytes
+} config_record_t;
+
+#define CONFIG_STORE_OFFSET       (PICO_FLASH_SIZE_BYTES - CONFIG_STORE_SECTORS * FLASH_SECTOR_SIZE)
+#define CONFIG_RECORDS_PER_SECTOR (FLASH_SECTOR_SIZE / sizeof(config_record_t))
+#define CONFIG_RECORDS_PER_PAGE   (FLASH_PAGE_SIZE / sizeof(config_record_t))
+#define CONFIG_RECORD_COUNT       (CONFIG_STORE_SECTORS * CONFIG_RECORDS_PER_SECTOR)
+
+_Static_assert(sizeof(config_record_t) == 16, "config record must pack into a page evenly");
+
+static const config_record_t *const log_base = (const config_record_t *)(XIP_BASE + CONFIG_STORE_OFFSET);
+
+static uint32_t next_slot; ///< Slot the next save appends to
+static uint32_t next_seq;  ///< Sequence number of the next save
+static config_record_t last_saved;
+static bool have_last_saved = false;
+static config_t pending;                    ///< Queued by save_config_later()
+static uint64_t pending_due_us = UINT64_MAX; ///< When it is written, UINT64_MAX: none queued
+
+// FLASH stuff lifted from pico examples
+// This function will be called when it's safe to call flash_range_erase
+static void call_flash_range_erase(void *param)
+{
+    uint32_t offset = (uint32_t)(uintptr_t)param;
+    flash_range_erase(offset, FLASH_SECTOR_SIZE);
+}
+
+// This function will be called when it's safe to call flash_range_program
+static void call_flash_range_program(void *param)
+{
+    uint32_t offset = ((uintptr_t *)param)[0];
+    const uint8_t *data = (const uint8_t *)((uintptr_t *)param)[1];
+    flash_range_program(offset, data, FLASH_PAGE_SIZE);
+}
+
+/**
+ * @brief CRC-32 (IEEE, reflected) using a 16-entry nibble table.
+ * @param data Bytes to checksum.
+ * @param len  Number of bytes.
+ * @return CRC value.
+ */
+static uint32_t crc32(const uint8_t *data, size_t len)
+{
+    static const uint32_t nibble_table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ nibble_table[crc & 0xF];
+        crc = (crc >> 4) ^ nibble_table[crc & 0xF];
+    }
+    return ~crc;
+}
+
+static inline uint32_t record_crc(const config_record_t *rec)
+{
+    return crc32((const uint8_t *)rec, offsetof(config_record_t, crc));
+}
+
+static bool record_is_valid(const config_record_t *rec)
+{
+    return rec->magic == CONFIG_MAGIC && rec->crc == record_crc(rec) && rec->region <= REGION_BRA;
+}
+
+static bool words_are_erased(const uint32_t *words, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (words[i] != 0xFFFFFFFFu)
+            return false;
+    }
+    return true;
+}
+
+static inline bool slot_is_erased(uint32_t slot)
+{
+    return words_are_erased((const uint32_t *)&log_base[slot], sizeof(config_record_t) / sizeof(uint32_t));
+}
+
+static inline bool sector_is_erased(uint32_t sector)
+{
+    return words_are_erased((const uint32_t *)&log_base[sector * CONFIG_RECORDS_PER_SECTOR],
+                            FLASH_SECTOR_SIZE / sizeof(uint32_t));
+}
+
+/**
+ * @brief Find the record with the highest sequence number.
+ * @param slot       Set to the record's slot.
+ * @param check_crc  Only consider records that pass record_is_valid(), not just the magic.
+ * @return The record, or NULL if there is none.
+ */
+static const config_record_t *newest_record(uint32_t *slot, bool check_crc)
+{
+    const config_record_t *best = NULL;
+
+    for (uint32_t i = 0; i < CONFIG_RECORD_COUNT; ++i) {
+        const config_record_t *rec = &log_base[i];
+        if (rec->magic != CONFIG_MAGIC || (check_crc && !record_is_valid(rec)))
+            continue;
+        // Sequence numbers wrap, compare by signed distance
+        if (!best || (int32_t)(rec->seq - best->seq) > 0) {
+            best = rec;
+            *slot = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Load the most recent valid configuration from flash.
+ *        Picks the newest record by its magic and sequence number and checks
+ *        only its CRC; if that one was torn by a power loss, the log is scanned
+ *        again for the newest valid record. Remembers where the next save goes.
+ * @param cfg Filled with the newest valid record; untouched if none is found.
+ * @return true if a valid record was found.
+ */
+bool load_config(config_t *cfg)
+{
+    // The console is held in reset until this returns: one CRC in the usual case
+    uint32_t best_slot = 0;
+    const config_record_t *best = newest_record(&best_slot, false);
+    if (best && !record_is_valid(best))
+        best = newest_record(&best_slot, true);
+
+    if (!best) {
+        next_slot = 0;
+        next_seq = 0;
+        return false;
+    }
+
+    next_slot = (best_slot + 1) % CONFIG_RECORD_COUNT;
+    next_seq = best->seq + 1;
+    last_saved = *best;
+    have_last_saved = true;
+
+    cfg->magic = CONFIG_MAGIC;
+    cfg->region = (region_t)best->region;
+    cfg->overclocked = best->overclocked != 0;
+    // Older records only knew MCLK/5, the default step
+    cfg->oc_step = best->oc_step == 0xFF ? VCLK_OC_DEFAULT_STEP : best->oc_step;
+    return true;
+}
+
+/**
+ * @brief Append a configuration record to the flash log.
+ *        Programs a single page; a sector is only erased when the log enters it,
+ *        once every few hundred saves. Saving an unchanged config is a no-op.
+ * @param cfg Configuration to persist.
+ */
+void save_config(const config_t *cfg)
+{
+    config_record_t rec;
+    memset(&rec, 0xFF, sizeof(rec));
+    rec.magic = CONFIG_MAGIC;
+    rec.region = (uint8_t)cfg->region;
+    rec.overclocked = cfg->overclocked ? 1 : 0;
+    rec.oc_step = cfg->oc_step;
+
+    if (have_last_saved && rec.region == last_saved.region && rec.overclocked == last_saved.overclocked &&
+        rec.oc_step == last_saved.oc_step)
+        return;
+
+    rec.seq = next_seq;
+    rec.crc = record_crc(&rec);
+
+    // Skip slots dirtied by a torn write, we can only program erased bytes
+    uint32_t slot = next_slot;
+    while ((slot % CONFIG_RECORDS_PER_SECTOR) != 0 && !slot_is_erased(slot))
+        slot = (slot + 1) % CONFIG_RECORD_COUNT;
+
+    // Entering a sector: recycle it (it holds records from the previous lap)
+    int rc;
+    uint32_t sector = slot / CONFIG_RECORDS_PER_SECTOR;
+    if ((slot % CONFIG_RECORDS_PER_SECTOR) == 0 && !sector_is_erased(sector)) {
+        uint32_t offset = CONFIG_STORE_OFFSET + sector * FLASH_SECTOR_SIZE;
+        trace_begin(TRACE_FLASH, offset);
+        rc = flash_safe_execute(call_flash_range_erase, (void *)(uintptr_t)offset, UINT32_MAX);
+        trace_end(TRACE_FLASH, offset);
+        hard_assert(rc == PICO_OK);
+    }
+
+    // Program the record's page, 0xFF everywhere else leaves other records intact
+    static uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    memcpy(&page[(slot % CONFIG_RECORDS_PER_PAGE) * sizeof(config_record_t)], &rec, sizeof(rec));
+
+    uintptr_t params[] = {CONFIG_STORE_OFFSET + (slot / CONFIG_RECORDS_PER_PAGE) * FLASH_PAGE_SIZE, (uintptr_t)page};
+    trace_begin(TRACE_FLASH, (uint32_t)params[0]);
+    rc = flash_safe_execute(call_flash_range_program, params, UINT32_MAX);
+    trace_end(TRACE_FLASH, (uint32_t)params[0]);
+    hard_assert(rc == PICO_OK);
+
+    next_slot = (slot + 1) % CONFIG_RECORD_COUNT;
+    next_seq++;
+    last_saved = rec;
+    have_last_saved = true;
+}
+
+/**
+ * @brief Queue a configuration to be saved CONFIG_WRITE_BEHIND_US from now.
+ *        A newer one queued before then replaces it and restarts the wait, so a
+ *        run of setting changes costs one save, away from the console line
+ *        changes that made it (a flash write masks core 0's interrupts).
+ * @param cfg Configuration to persist.
+ */
+void save_config_later(const config_t *cfg)
+{
+    pending = *cfg;
+    pending_due_us = time_us_64() + CONFIG_WRITE_BEHIND_US;
+}
+
+/**
+ * @brief Time the queued configuration is due.
+ * @return Absolute time in microseconds, or UINT64_MAX when nothing is queued.
+ */
+uint64_t config_write_due_us(void)
+{
+    return pending_due_us;
+}
+
+/**
+ * @brief Save the queued configuration, if any. Call once it is due.
+ */
+void config_write_behind(void)
+{
+    if (pending_due_us == UINT64_MAX)
+        return;
+    pending_due_us = UINT64_MAX;
+    save_config(&pending);
+}
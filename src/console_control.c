@@ -0,0 +1,321 @@
+#include "console_control.h"
+#include "clock_control.h"
+#include "setup.h"
+#include "structs.h"
+#include "trace.h"
+#include "logic_analyzer.h"
+#include "tmss_skip.h"
+#include "rt_timer.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/time.h"
+
+/*
+ * Console line executor
+ * ---------------------
+ * !VRES and !HALT pulses used to be done inline with sleep_us()/sleep_ms(),
+ * freezing the main loop (and hotkey handling) for up to ~17 ms per reset.
+ * Sequences are now queued and stepped from a timer alarm: each step acts
+ * on a line and names the wait before the next one. The alarm reschedules
+ * itself relative to its previous target, so step timing does not drift
+ * with IRQ latency. Sequences run one after another in request order.
+ *
+ * The console's reset button pulls !VRES low through the VDP. Its edges are
+ * stamped in the GPIO IRQ and queued for the gesture engine; edges of our
+ * own pulses are dropped.
+ *
+ * The step runner and both IRQ callbacks live in SRAM so pulse timing does
+ * not depend on XIP cache misses.
+ */
+
+#define CONSOLE_QUEUE_LEN 4  ///< Sequences waiting behind the running one (power of 2)
+#define BUTTON_RING_LEN   8  ///< Reset button edges buffered for the main loop (power of 2)
+
+typedef struct
+{
+    const console_step_t *steps;
+    void *arg;
+} console_job_t;
+
+static console_job_t queue[CONSOLE_QUEUE_LEN];
+static volatile uint8_t queue_head, queue_tail;          ///< Free-running indices
+static const console_step_t *volatile step = NULL;       ///< Step to run next, NULL when idle
+static void *step_arg;
+static volatile bool vres_asserted = false;
+static uint64_t boot_release_us = 0;
+
+static console_button_event_t button_ring[BUTTON_RING_LEN];
+static volatile uint8_t button_head, button_tail;         ///< Free-running indices
+static bool button_down = false;
+
+static const console_step_t __not_in_flash("console") reset_sequence[] = {
+    {CONSOLE_VRES_ASSERT, CONSOLE_RESET_PULSE_US, NULL},
+    {CONSOLE_VRES_RELEASE, 0, NULL},
+    {CONSOLE_END, 0, NULL},
+};
+
+/**
+ * @brief Swap the VCLK divider on a VCLK edge while !HALT is held.
+ *        The waits are a few microseconds, too short for the alarm, so they are spun here.
+ *        If the staged write has not landed by then, the divider is forced in before
+ *        !HALT is released and the miss is counted in system_status.
+ */
+static void __not_in_flash_func(switch_vclk_div)(void *arg)
+{
+    // !HALT went low in the previous step: let the 68000 finish its bus cycle
+    rt_busy_wait_us(VCLK_SWITCH_HALT_US);
+    stage_vclk_div((uint32_t)(uintptr_t)arg);
+    // The swap lands on the next VCLK edge, well under a microsecond away
+    uint64_t deadline = rt_time_us_64() + VCLK_SWITCH_HALT_US;
+    while (!vclk_div_swapped() && rt_time_us_64() < deadline)
+        tight_loop_contents();
+    if (!vclk_div_swapped()) {
+        // Still halted: a mid-phase write is harmless now, a late one after the release is not
+        force_vclk_div();
+        system_status.vclk_swap_timeouts++;
+    }
+}
+
+static const console_step_t __not_in_flash("console") vclk_sequence[] = {
+    {CONSOLE_HALT_ASSERT, 0, NULL},
+    {CONSOLE_CALL, 0, switch_vclk_div},
+    {CONSOLE_HALT_RELEASE, 0, NULL},
+    {CONSOLE_END, 0, NULL},
+};
+
+/**
+ * @brief Drive an open collector line: low when asserted, input (released) otherwise.
+ * @param pin    GPIO of the line.
+ * @param assert true to pull the line low.
+ */
+static inline void line_set(uint pin, bool assert)
+{
+    gpio_put(pin, false);
+    gpio_set_dir(pin, assert ? GPIO_OUT : GPIO_IN);
+}
+
+/**
+ * @brief Run steps until one asks for a wait, starting queued sequences as needed.
+ *        Called with IRQs disabled or from the alarm callback.
+ * @return Microseconds until the next step, or 0 when there is nothing left to do.
+ */
+static uint32_t __not_in_flash_func(run_steps)(void)
+{
+    while (true) {
+        if (!step) {
+            if (queue_head == queue_tail)
+                return 0;
+            console_job_t *job = &queue[queue_tail++ % CONSOLE_QUEUE_LEN];
+            step = job->steps;
+            step_arg = job->arg;
+        }
+
+        const console_step_t *s = step;
+        trace_mark(TRACE_CONSOLE_STEP, s->op);
+        switch (s->op) {
+        case CONSOLE_HALT_ASSERT:
+            line_set(GPIO_HALT_PIN, true);
+            break;
+        case CONSOLE_HALT_RELEASE:
+            line_set(GPIO_HALT_PIN, false);
+            break;
+        case CONSOLE_VRES_ASSERT:
+            vres_asserted = true;
+            line_set(GPIO_VRES_PIN, true);
+            break;
+        case CONSOLE_VRES_RELEASE:
+            line_set(GPIO_VRES_PIN, false);
+            vres_asserted = false;
+            break;
+        case CONSOLE_CALL:
+            s->fn(step_arg);
+            break;
+        case CONSOLE_END:
+            step = NULL;
+            continue;
+        }
+
+        step = s + 1;
+        if (s->wait_us)
+            return s->wait_us;
+    }
+}
+
+/**
+ * @brief Alarm callback: run the next steps, then re-arm for the following wait.
+ */
+static int64_t __not_in_flash_func(console_alarm_callback)(alarm_id_t id, void *user_data)
+{
+    // The default alarm pool runs on hardware alarm 3
+    trace_begin(TRACE_ISR, TIMER_IRQ_3);
+    uint32_t wait_us = run_steps();
+    trace_end(TRACE_ISR, TIMER_IRQ_3);
+    // Negative: relative to this alarm's target, not to when the IRQ got serviced
+    return wait_us ? -(int64_t)wait_us : 0;
+}
+
+/**
+ * @brief Set up !HALT as an open collector output (released).
+ *        !VRES belongs to the TMSS skip, when enabled, until tmss_skip_poll() reports an outcome;
+ *        otherwise it is held low here until console_boot_release().
+ */
+void console_control_init(void)
+{
+    gpio_init(GPIO_HALT_PIN);
+    line_set(GPIO_HALT_PIN, false);
+    if (!ENABLE_TMSS_SKIP) {
+        gpio_init(GPIO_VRES_PIN);
+        line_set(GPIO_VRES_PIN, true);
+    }
+}
+
+/**
+ * @brief Let the 68000 run for the first time: arm the TMSS skip, or release !VRES.
+ *        Call once MCLK/VCLK run at the stored region's rates.
+ */
+void console_boot_release(void)
+{
+    if (ENABLE_TMSS_SKIP)
+        tmss_skip_arm();
+    else
+        line_set(GPIO_VRES_PIN, false);
+    boot_release_us = time_us_64();
+}
+
+/**
+ * @brief When console_boot_release() let the console go.
+ * @return Microseconds from power-on, 0 before the release.
+ */
+uint64_t console_boot_release_us(void)
+{
+    return boot_release_us;
+}
+
+/**
+ * @brief Queue a step sequence. Returns immediately; steps run from a timer alarm.
+ *        Core 0 only: the alarm fires there and the queue is guarded by masking IRQs.
+ * @param steps Sequence terminated by CONSOLE_END (must stay valid until it ran).
+ * @param arg   Argument passed to CONSOLE_CALL steps.
+ * @return false if the queue is full.
+ */
+bool console_run(const console_step_t *steps, void *arg)
+{
+    uint32_t irq = save_and_disable_interrupts();
+
+    if ((uint8_t)(queue_head - queue_tail) == CONSOLE_QUEUE_LEN) {
+        restore_interrupts(irq);
+        return false;
+    }
+    queue[queue_head++ % CONSOLE_QUEUE_LEN] = (console_job_t){steps, arg};
+
+    // Idle executor: start now, the alarm takes over at the first wait
+    if (!step) {
+        uint32_t wait_us = run_steps();
+        if (wait_us) {
+            alarm_id_t id = add_alarm_in_us(wait_us, console_alarm_callback, NULL, true);
+            hard_assert(id > 0);
+        }
+    }
+
+    restore_interrupts(irq);
+    return true;
+}
+
+/**
+ * @brief Check whether a sequence is running or queued.
+ * @return true while the executor has work.
+ */
+bool console_busy(void)
+{
+    return step != NULL || queue_head != queue_tail;
+}
+
+/**
+ * @brief Check whether the firmware is currently holding !VRES low.
+ *        Lets reset-button counting ignore our own reset pulses.
+ * @return true while a sequence asserts !VRES.
+ */
+bool console_vres_asserted(void)
+{
+    return vres_asserted;
+}
+
+/**
+ * @brief Reset the 68000: !VRES low for CONSOLE_RESET_PULSE_US.
+ * @return false if the queue is full.
+ */
+bool console_reset(void)
+{
+    return console_run(reset_sequence, NULL);
+}
+
+/**
+ * @brief Change the VCLK divider with the 68000 halted around the switch.
+ * @param div16 New VCLK divider relative to MCLK, in 1/16ths.
+ * @return false if the queue is full.
+ */
+bool console_set_vclk_div(uint32_t div16)
+{
+    return console_run(vclk_sequence, (void *)(uintptr_t)div16);
+}
+
+/**
+ * @brief Queue a reset button edge; the oldest edges win when the ring is full.
+ */
+static void __not_in_flash_func(push_button_event)(uint64_t time_us, bool pressed)
+{
+    if ((uint8_t)(button_head - button_tail) == BUTTON_RING_LEN)
+        return;
+    button_ring[button_head % BUTTON_RING_LEN] = (console_button_event_t){time_us, pressed};
+    button_head++;
+}
+
+/**
+ * @brief GPIO IRQ callback for !VRES edges.
+ */
+static void __not_in_flash_func(vres_edge_callback)(uint gpio, uint32_t events)
+{
+    uint64_t now = rt_time_us_64();
+    if (gpio != GPIO_VRES_PIN)
+        return;
+    trace_begin(TRACE_ISR, IO_IRQ_BANK0);
+
+    // Any reset, ours or the button's, stops a running capture
+    if (events & GPIO_IRQ_EDGE_FALL)
+        la_trigger(LA_TRIGGER_RESET);
+
+    // A fall while we hold the line is our own pulse, and so is the rise that ends it
+    if ((events & GPIO_IRQ_EDGE_FALL) && !button_down && !vres_asserted) {
+        push_button_event(now, true);
+        button_down = true;
+    }
+    if (button_down && gpio_get(GPIO_VRES_PIN)) {
+        push_button_event(now, false);
+        button_down = false;
+    }
+    trace_end(TRACE_ISR, IO_IRQ_BANK0);
+}
+
+/**
+ * @brief Start timestamping reset button edges on !VRES (core 0).
+ *        Call once the TMSS skip has handed !VRES back.
+ */
+void console_watch_reset_button(void)
+{
+    gpio_set_irq_enabled_with_callback(GPIO_VRES_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, vres_edge_callback);
+}
+
+/**
+ * @brief Pop the oldest reset button edge.
+ * @param ev Receives the edge.
+ * @return true if an edge was available.
+ */
+bool console_reset_button_pop(console_button_event_t *ev)
+{
+    if (button_tail == button_head)
+        return false;
+    *ev = button_ring[button_tail % BUTTON_RING_LEN];
+    button_tail++;
+    return true;
+}
@@ -1,5 +1,8 @@
 #include "controller.h"
 #include "structs.h"
+#include "pad_decoder.h"
+#include "pad_channel.h"
+#include "rt_timer.h"
 #include "hardware/gpio.h"
 #include "pico/stdlib.h"
 #include <stdint.h>
@@ -18,8 +21,15 @@
  * GPIO_PIN_* macros must be defined in setup.h for each controller line:
  *   GPIO_PIN_UP, GPIO_PIN_DOWN, GPIO_PIN_LEFT, GPIO_PIN_RIGHT,
  *   GPIO_PIN_B, GPIO_PIN_C, GPIO_PIN_SELECT
+ *
+ * Each SELECT phase read is handed to the shared protocol decoder
+ * (pad_decoder.c) as a sample, the same way the sniffer hands over the
+ * console's reads. The read path runs from SRAM and waits on the timer registers, so core 1
+ * keeps reading the pad while core 0 writes flash (see flash_window.c).
  */
 
+static pad_decoder_t decoder;
+
 /**
  * @brief Initialize GPIOs for the Genesis/Mega Drive controller.
  *        Data lines are set as input with pull-ups; select line as output.
@@ -33,13 +43,15 @@ void genesis_controller_gpio_init(void) {
     gpio_init(GPIO_PIN_C);       gpio_set_dir(GPIO_PIN_C, GPIO_IN);       gpio_pull_up(GPIO_PIN_C);
 
     gpio_init(GPIO_PIN_SELECT);  gpio_set_dir(GPIO_PIN_SELECT, GPIO_OUT); gpio_put(GPIO_PIN_SELECT, HIGH);
+
+    pad_decoder_init(&decoder, PAD_CYCLE_GAP_US);
 }
 
 /**
  * @brief Set the SELECT line (pin 9 on DB9 connector).
  * @param value 1 for HIGH, 0 for LOW.
  */
-void set_select_line(int value) {
+void __not_in_flash_func(set_select_line)(int value) {
     gpio_put(GPIO_PIN_SELECT, value ? HIGH : LOW);
 }
 
@@ -47,11 +59,11 @@ void set_select_line(int value) {
  * @brief Pulse the SELECT line: HIGH->LOW with short delay.
  *        Used for 6-button handshake sequence.
  */
-void pulse_select_line(void) {
+void __not_in_flash_func(pulse_select_line)(void) {
     set_select_line(HIGH);
-    sleep_us(10);
+    rt_busy_wait_us(10);
     set_select_line(LOW);
-    sleep_us(10);
+    rt_busy_wait_us(10);
 }
 
 /**
@@ -61,7 +73,7 @@ void pulse_select_line(void) {
  *         All lines are active low (pressed = 1).
  *         bit6 is set if U, D, L, R are all low (pressed) simultaneously.
  */
-uint8_t read_data_lines(void) {
+uint8_t __not_in_flash_func(read_data_lines)(void) {
     uint8_t data = 0;
     bool up    = !gpio_get(GPIO_PIN_UP);
     bool down  = !gpio_get(GPIO_PIN_DOWN);
@@ -81,6 +93,15 @@ uint8_t read_data_lines(void) {
     return data;
 }
 
+/**
+ * @brief Read the data lines and hand them to the decoder as a sample.
+ * @param select SELECT level the lines were read at.
+ */
+static void __not_in_flash_func(feed_sample)(int select) {
+    uint32_t sample = (~read_data_lines() & PAD_SAMPLE_DATA_MASK) | (select ? PAD_SAMPLE_SELECT_BIT : 0);
+    pad_decoder_feed(&decoder, sample, (uint32_t)rt_time_us_64());
+}
+
 /**
  * @brief Read the Genesis/Mega Drive controller and fill the joypad_state_t struct.
  *        Supports both 3-button and 6-button controllers using the official protocol.
@@ -90,44 +111,29 @@ uint8_t read_data_lines(void) {
  *
  * @param pad Pointer to joypad_state_t struct to fill with button states.
  */
-void read_genesis_joypad(joypad_state_t *pad) {
-    uint8_t data;
-    *pad = (joypad_state_t){0}; // Clear all button states
-
-    // 1. SELECT = 1: Read directions, B, C (directions only valid here)
-    set_select_line(HIGH); sleep_us(10);
-    data = read_data_lines();
-    pad->up    = (data & (1 << 0)) != 0;
-    pad->down  = (data & (1 << 1)) != 0;
-    pad->left  = (data & (1 << 2)) != 0;
-    pad->right = (data & (1 << 3)) != 0;
-    pad->b     = (data & (1 << 4)) != 0;
-    pad->c     = (data & (1 << 5)) != 0;
-
-    // 2. SELECT = 0: Read A, START (ignore directions here)
-    set_select_line(LOW); sleep_us(10);
-    data = read_data_lines();
-    pad->a     = (data & (1 << 4)) != 0;
-    pad->start = (data & (1 << 5)) != 0;
-
-    // 3. Handshake: 2 rapid SELECT transitions, then read for 6-button detection
+void __not_in_flash_func(read_genesis_joypad)(joypad_state_t *pad) {
+    // Each call is one complete read cycle
+    pad_decoder_resync(&decoder);
+
+    // 1. SELECT = 1: directions, B, C
+    set_select_line(HIGH); rt_busy_wait_us(10);
+    feed_sample(HIGH);
+
+    // 2. SELECT = 0: A, START
+    set_select_line(LOW); rt_busy_wait_us(10);
+    feed_sample(LOW);
+
+    // 3. Two more SELECT pulses: a 6-button pad shows its ID on the third low phase
     pulse_select_line();
     pulse_select_line();
-    data = read_data_lines();
-    // Use bit 6 from read_data_lines to detect 6-button controller
-    bool six_button = (data & (1 << 6)) != 0;
-
-    // 4. Final SELECT=1: Only now are X/Y/Z/MODE valid (on direction lines)
-    set_select_line(HIGH); sleep_us(10);
-    data = read_data_lines();
-    if (six_button) {
-        pad->z    = (data & (1 << 0)) != 0;
-        pad->y    = (data & (1 << 1)) != 0;
-        pad->x    = (data & (1 << 2)) != 0;
-        pad->mode = (data & (1 << 3)) != 0;
-    } else {
-        pad->x = pad->y = pad->z = pad->mode = false;
-    }
-    set_select_line(LOW); sleep_us(10);
-    set_select_line(HIGH); sleep_us(10);
+    feed_sample(LOW);
+
+    // 4. SELECT = 1: X/Y/Z/MODE after an ID, the directions again otherwise
+    set_select_line(HIGH); rt_busy_wait_us(10);
+    feed_sample(HIGH);
+
+    set_select_line(LOW); rt_busy_wait_us(10);
+    set_select_line(HIGH); rt_busy_wait_us(10);
+
+    *pad = pad_state_from_mask(decoder.mask);
 }
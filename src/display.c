@@ -1,37 +1,470 @@
 #include "setup.h"
 #include "display.h"
+#include "trace.h"
+#include "frame_sync.h"
+#include "hardware/dma.h"
 #include "hardware/i2c.h"
+#include "hardware/irq.h"
 #include "pico/stdlib.h"
 #include "sega_logo.h"
+#include "font.h"
 #include <string.h>
 #include <stdio.h>
 #include "pico-ssd1306/ssd1306.h"
 
 #define I2C_PORT i2c0
 
+#define OLED_WIDTH       128
+#define OLED_HEIGHT      64
+#define OLED_ADDRESS     0x3C
+#define OLED_PAGES       (OLED_HEIGHT / 8)
+#define OLED_FRAME_BYTES (OLED_WIDTH * OLED_PAGES)
+#define OLED_HEADER_WORDS 8 ///< Command control byte, 6 address window bytes, data control byte
+#define OLED_BUFFER_SKEW 4  ///< Back buffer offset that keeps page rows word aligned
+
+// Status screen layout, one text line per SSD1306 page so lines never share a page
+#define STATUS_REGION_PAGE 0
+#define STATUS_OC_PAGE     2
+#define STATUS_PAD_PAGE    3
+#define STATUS_BOOT_PAGE   5
+#define STATUS_FPS_PAGE    7
+
+// DMA_IRQ_0 belongs to core 1 (pad sniffer), core 0 users share DMA_IRQ_1
+#define DISPLAY_DMA_IRQ  DMA_IRQ_1
+
 static ssd1306_t display;
 
+/*
+ * Frame pipeline
+ * --------------
+ * Drawing goes into the back buffer (display.buffer, ours: the library is
+ * only used to draw, never to allocate or send). Presenting
+ * a frame expands it into the front buffer, which is kept directly in I2C
+ * IC_DATA_CMD word form (data byte plus STOP flag), and hands that to a DMA
+ * channel paced by the I2C TX DREQ. Core 0 returns immediately; the DMA
+ * completion IRQ marks the front buffer free again, and times the transfer
+ * when it was a full frame: that is the panel's frame rate limit.
+ */
+static uint8_t back_buffer[OLED_BUFFER_SKEW + OLED_FRAME_BYTES] __attribute__((aligned(4))); ///< Pixels from [OLED_BUFFER_SKEW]
+static uint16_t front_buffer[OLED_PAGES * (OLED_HEADER_WORDS + OLED_WIDTH)];
+static int tx_dma_chan = -1;
+static volatile bool tx_dma_active = false;
+static bool tx_full_frame = false;           ///< The transfer in flight covers every page, every column
+static uint32_t tx_start_us;
+static volatile uint32_t full_frame_us = 0;  ///< Bus time of the last full frame, 0 before one was sent
+static uint32_t bus_bytes = 0;
+
+/*
+ * Retained status screen
+ * ----------------------
+ * Each page remembers the column range touched since the last present. Only
+ * those ranges go over the bus, one address window per dirty page, and a
+ * range that could not be sent because the bus was busy simply stays dirty.
+ */
+static uint8_t dirty_col_min[OLED_PAGES];
+static uint8_t dirty_col_max[OLED_PAGES];
+static bool dirty_any = false;
+static uint8_t line_width[OLED_PAGES]; ///< Pixel width of the text currently drawn on each page
+
+static system_status_t shown;       ///< Status currently on screen
+static uint32_t shown_oc_khz;     ///< 68000 clock shown on the OC line, 0 for off
+static uint32_t shown_fps;
+static uint64_t boot_release_us;   ///< Console release time for the boot line, 0 for none
+static uint64_t shown_boot_us;
+static bool status_shown = false;  ///< false forces a full redraw
+static bool splash_shown = false;  ///< The status screen has to clear the panel first
+
+/*
+ * Blits
+ * -----
+ * Text and bitmaps are drawn as bands of page-format columns: one byte per
+ * column, LSB at the top, 8 rows. A band at a page-aligned Y is a straight
+ * copy into one page row. Otherwise it straddles two pages and each column
+ * byte is split by the row offset, four columns per 32-bit word, with
+ * per-byte masks keeping the other rows of both pages. Nothing is drawn
+ * pixel by pixel.
+ */
+#define BYTE_LANES(b) ((uint32_t)(uint8_t)(b) * 0x01010101u)
+
+static uint8_t text_band[OLED_WIDTH] __attribute__((aligned(4)));  ///< Text rendered for an unaligned Y
+static uint8_t spill_band[OLED_WIDTH] __attribute__((aligned(4))); ///< Rows that fall off the bottom
+
+/**
+ * @brief Copy one 8-row band of page-format columns into the back buffer.
+ * @param src   Column bytes.
+ * @param width Columns.
+ * @param x     First column.
+ * @param y     Top row, any alignment.
+ */
+static void blit_band(const uint8_t *src, uint32_t width, uint32_t x, uint32_t y)
+{
+    uint32_t page = y >> 3, shift = y & 7;
+    uint8_t *lo = &display.buffer[page * OLED_WIDTH + x];
+    if (!shift) {
+        memcpy(lo, src, width);
+        return;
+    }
+
+    // Same word alignment as lo either way, as both rows start word aligned
+    uint8_t *hi = page + 1 < OLED_PAGES ? lo + OLED_WIDTH : &spill_band[x];
+    uint8_t lo_mask = (uint8_t)(0xFF << shift), hi_mask = (uint8_t)(0xFF >> (8 - shift));
+    uint32_t i = 0;
+
+    // Columns up to the first word boundary, then four at a time, then the rest
+    for (; i < width && ((uintptr_t)(lo + i) & 3); ++i) {
+        lo[i] = (lo[i] & ~lo_mask) | (uint8_t)(src[i] << shift);
+        hi[i] = (hi[i] & ~hi_mask) | (uint8_t)(src[i] >> (8 - shift));
+    }
+    for (; i + 4 <= width; i += 4) {
+        uint32_t w = src[i] | (uint32_t)src[i + 1] << 8 | (uint32_t)src[i + 2] << 16 | (uint32_t)src[i + 3] << 24;
+        uint32_t *lw = __builtin_assume_aligned(lo + i, 4);
+        uint32_t *hw = __builtin_assume_aligned(hi + i, 4);
+        *lw = (*lw & ~BYTE_LANES(lo_mask)) | ((w << shift) & BYTE_LANES(lo_mask));
+        *hw = (*hw & ~BYTE_LANES(hi_mask)) | ((w >> (8 - shift)) & BYTE_LANES(hi_mask));
+    }
+    for (; i < width; ++i) {
+        lo[i] = (lo[i] & ~lo_mask) | (uint8_t)(src[i] << shift);
+        hi[i] = (hi[i] & ~hi_mask) | (uint8_t)(src[i] >> (8 - shift));
+    }
+}
+
+/**
+ * @brief Lay out text as page-format columns, whole glyphs at a time.
+ *        Characters outside the font are drawn as spaces; the last glyph is
+ *        cut at the right edge of the panel.
+ * @param dst  Column bytes for the first character.
+ * @param x    Column of the first character on the panel.
+ * @param text Text to lay out.
+ * @return Columns written.
+ */
+static uint32_t render_text(uint8_t *dst, uint32_t x, const char *text)
+{
+    uint32_t col = 0;
+    for (; *text && x + col < OLED_WIDTH; ++text) {
+        char c = *text >= FONT_FIRST_CHAR && *text <= FONT_LAST_CHAR ? *text : ' ';
+        uint32_t n = OLED_WIDTH - (x + col) < FONT_ADVANCE ? OLED_WIDTH - (x + col) : FONT_ADVANCE;
+        memcpy(dst + col, font_5x8[c - FONT_FIRST_CHAR], n);
+        col += n;
+    }
+    return col;
+}
+
+/**
+ * @brief Frame transfer finished: the front buffer may be reused.
+ *        The last bytes can still be in the I2C TX FIFO, display_busy() covers that.
+ */
+static void display_dma_irq_handler(void)
+{
+    if (!dma_channel_get_irq1_status(tx_dma_chan))
+        return;
+
+    trace_begin(TRACE_ISR, DISPLAY_DMA_IRQ);
+    dma_channel_acknowledge_irq1(tx_dma_chan);
+    tx_dma_active = false;
+    if (tx_full_frame)
+        full_frame_us = time_us_32() - tx_start_us;
+    trace_end(TRACE_DISPLAY, 0);
+    trace_end(TRACE_ISR, DISPLAY_DMA_IRQ);
+}
+
 /**
- * @brief Draw a monochrome bitmap (1bpp, 8 pixels per byte, row-major).
- * @param disp   Pointer to the display object.
- * @param x0     X coordinate to start drawing.
- * @param y0     Y coordinate to start drawing.
- * @param w      Width of the bitmap.
- * @param h      Height of the bitmap.
- * @param bitmap Pointer to bitmap data.
- */
-static void ssd1306_draw_bitmap(ssd1306_t *disp, int x0, int y0, int w, int h, const uint8_t *bitmap)
-{
-    for (int y = 0; y < h; ++y) {
-        for (int x = 0; x < w; ++x) {
-            int byte_index = (y * ((w + 7) / 8)) + (x / 8);
-            int bit_index = 7 - (x % 8);
-            uint8_t byte = bitmap[byte_index];
-            int pixel_on = (byte >> bit_index) & 0x1;
-            if (pixel_on)
-                ssd1306_draw_pixel(disp, x0 + x, y0 + y);
+ * @brief Set up the DMA channel that streams the front buffer to the I2C TX FIFO.
+ */
+static void display_dma_init(void)
+{
+    i2c_hw_t *hw = i2c_get_hw(I2C_PORT);
+
+    // The DMA stream addresses a single target; IC_TAR can only change while disabled
+    hw->enable = 0;
+    hw->tar = OLED_ADDRESS;
+    hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS;
+    hw->enable = 1;
+
+    tx_dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(tx_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(I2C_PORT, true));
+    dma_channel_configure(tx_dma_chan, &c, &hw->data_cmd, front_buffer, 0, false);
+
+    dma_channel_set_irq1_enabled(tx_dma_chan, true);
+    irq_add_shared_handler(DISPLAY_DMA_IRQ, display_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DISPLAY_DMA_IRQ, true);
+}
+
+/**
+ * @brief Mark a column range of a page as needing transfer.
+ * @param page Page (8-pixel row band) index.
+ * @param col0 First column.
+ * @param col1 Last column (inclusive).
+ */
+static void mark_dirty(uint8_t page, uint8_t col0, uint8_t col1)
+{
+    if (!dirty_any || dirty_col_min[page] > dirty_col_max[page]) {
+        // First mark for this page since the last present
+        if (!dirty_any) {
+            memset(dirty_col_min, 0xFF, sizeof(dirty_col_min));
+            memset(dirty_col_max, 0x00, sizeof(dirty_col_max));
+            dirty_any = true;
         }
+        dirty_col_min[page] = col0;
+        dirty_col_max[page] = col1;
+        return;
     }
+    if (col0 < dirty_col_min[page])
+        dirty_col_min[page] = col0;
+    if (col1 > dirty_col_max[page])
+        dirty_col_max[page] = col1;
+}
+
+/**
+ * @brief Replace the text on one page and mark the columns that changed.
+ * @param page Page to draw on.
+ * @param text Text to draw from column 0.
+ */
+static void draw_status_line(uint8_t page, const char *text)
+{
+    uint8_t *row = &display.buffer[page * OLED_WIDTH];
+    uint32_t width = render_text(row, 0, text);
+    uint32_t span = width > line_width[page] ? width : line_width[page];
+
+    memset(row + width, 0, OLED_WIDTH - width);
+    line_width[page] = width;
+
+    if (span)
+        mark_dirty(page, 0, span - 1);
+}
+
+/**
+ * @brief Check whether a frame is still being sent.
+ * @return true while the DMA or the I2C controller is busy with the previous frame.
+ */
+bool display_busy(void)
+{
+    if (!ENABLE_OLED_DISPLAY)
+        return false;
+
+    uint32_t status = i2c_get_hw(I2C_PORT)->status;
+    return tx_dma_active || !(status & I2C_IC_STATUS_TFE_BITS) || (status & I2C_IC_STATUS_ACTIVITY_BITS);
+}
+
+/**
+ * @brief Send the dirty parts of the back buffer, one address window per dirty page.
+ *        Never waits for the bus: if the previous transfer is still in flight the
+ *        dirty ranges are kept and go out with the next flush.
+ * @return true if a transfer was queued or nothing was dirty.
+ */
+bool display_flush(void)
+{
+    if (!ENABLE_OLED_DISPLAY || !dirty_any)
+        return true;
+    if (display_busy())
+        return false;
+
+    // A NACK (e.g. no display fitted) leaves the TX FIFO flushed until cleared
+    (void)i2c_get_hw(I2C_PORT)->clr_tx_abrt;
+
+    uint16_t *w = front_buffer;
+    bool full = true;
+    for (uint8_t page = 0; page < OLED_PAGES; ++page) {
+        uint8_t col0 = dirty_col_min[page];
+        uint8_t col1 = dirty_col_max[page];
+        full &= col0 == 0 && col1 == OLED_WIDTH - 1;
+        if (col0 > col1)
+            continue;
+
+        *w++ = 0x00;                                         // Co=0, D/C#=0: command stream
+        *w++ = 0x21; *w++ = col0; *w++ = col1;               // column address window
+        *w++ = 0x22; *w++ = page;
+        *w++ = page | I2C_IC_DATA_CMD_STOP_BITS;             // page address window
+        *w++ = 0x40;                                         // Co=0, D/C#=1: data stream
+        const uint8_t *src = &display.buffer[page * OLED_WIDTH];
+        for (uint32_t col = col0; col <= col1; ++col)
+            *w++ = src[col];
+        w[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    }
+    dirty_any = false;
+
+    bus_bytes += w - front_buffer;
+    trace_begin(TRACE_DISPLAY, w - front_buffer);
+    tx_full_frame = full;
+    tx_start_us = time_us_32();
+    tx_dma_active = true;
+    dma_channel_transfer_from_buffer_now(tx_dma_chan, front_buffer, w - front_buffer);
+    return true;
+}
+
+/**
+ * @brief Mark the whole back buffer dirty and send it.
+ * @return true if the frame was queued.
+ */
+bool display_present(void)
+{
+    if (!ENABLE_OLED_DISPLAY)
+        return false;
+
+    for (uint8_t page = 0; page < OLED_PAGES; ++page)
+        mark_dirty(page, 0, OLED_WIDTH - 1);
+    return display_flush();
+}
+
+/**
+ * @brief Total bytes (including I2C control and address bytes) queued for the panel.
+ * @return Byte count since init.
+ */
+uint32_t display_get_bus_bytes(void)
+{
+    return bus_bytes;
+}
+
+/**
+ * @brief Frames per second the panel link can carry: the inverse of the bus time of
+ *        the last full frame. Partial updates are not counted, so the figure does not
+ *        depend on how often the status screen changes, or on its own line.
+ * @return Frames per second, 0 before a full frame was sent.
+ */
+uint32_t display_get_fps(void)
+{
+    uint32_t us = full_frame_us;
+    return us ? 1000000 / us : 0;
+}
+
+/**
+ * @brief Draw one frame of a page-format image into the back buffer and mark it dirty.
+ *        Whole pages are replaced, so the image is placed on a page boundary.
+ *        The RLE stream is expanded straight into the back buffer: runs become
+ *        memset() and literals memcpy(), split only at the image's row ends.
+ * @param image Image to draw.
+ * @param frame Frame index.
+ * @param x     First column.
+ * @param page  First page.
+ */
+void display_draw_image(const display_image_t *image, uint8_t frame, uint8_t x, uint8_t page)
+{
+    hard_assert(frame < image->frames);
+    hard_assert(x + image->width <= OLED_WIDTH && page + image->pages <= OLED_PAGES);
+
+    const uint8_t *src = image->data + image->offsets[frame];
+    const uint8_t *end = image->data + image->offsets[frame + 1];
+    uint8_t *row = &display.buffer[page * OLED_WIDTH + x];
+    uint32_t col = 0;
+
+    while (src < end) {
+        uint8_t ctrl = *src++;
+        bool run = ctrl & 0x80;
+        uint32_t n = run ? (ctrl & 0x7F) + 2u : ctrl + 1u;
+        uint8_t value = run ? *src++ : 0;
+
+        while (n) {
+            uint32_t chunk = image->width - col < n ? image->width - col : n;
+            if (run) {
+                memset(row + col, value, chunk);
+            } else {
+                memcpy(row + col, src, chunk);
+                src += chunk;
+            }
+            n -= chunk;
+            col += chunk;
+            if (col == image->width) {
+                row += OLED_WIDTH;
+                col = 0;
+            }
+        }
+    }
+
+    for (uint8_t p = page; p < page + image->pages; ++p)
+        mark_dirty(p, x, x + image->width - 1);
+}
+
+/**
+ * @brief Draw text in the 5x8 font and mark it dirty. Glyph cells are
+ *        replaced, including their spacing column; the rest of the band is kept.
+ * @param x    First column.
+ * @param y    Top row, any alignment.
+ * @param text Text to draw; cut at the right edge of the panel.
+ * @return Columns drawn.
+ */
+uint32_t display_draw_text(uint8_t x, uint8_t y, const char *text)
+{
+    hard_assert(x < OLED_WIDTH && y < OLED_HEIGHT);
+
+    uint32_t width;
+    if (y & 7) {
+        width = render_text(text_band, x, text);
+        blit_band(text_band, width, x, y);
+    } else {
+        width = render_text(&display.buffer[(y >> 3) * OLED_WIDTH + x], x, text);
+    }
+
+    if (width) {
+        mark_dirty(y >> 3, x, x + width - 1);
+        if ((y & 7) && (y >> 3) + 1 < OLED_PAGES)
+            mark_dirty((y >> 3) + 1, x, x + width - 1);
+    }
+    return width;
+}
+
+/**
+ * @brief Draw an uncompressed page-format bitmap at any row and mark it dirty.
+ *        Bands that fall off the bottom of the panel are dropped.
+ * @param data  Column bytes, one band of width bytes after the other.
+ * @param width Columns.
+ * @param pages 8-row bands.
+ * @param x     First column.
+ * @param y     Top row, any alignment.
+ */
+void display_draw_bitmap(const uint8_t *data, uint8_t width, uint8_t pages, uint8_t x, uint8_t y)
+{
+    hard_assert(width && x + width <= OLED_WIDTH && y < OLED_HEIGHT);
+
+    for (uint32_t band = 0; band < pages && y + band * 8 < OLED_HEIGHT; ++band)
+        blit_band(data + band * width, width, x, y + band * 8);
+
+    uint32_t last = (y + pages * 8u - 1) >> 3;
+    for (uint32_t p = y >> 3; p <= last && p < OLED_PAGES; ++p)
+        mark_dirty(p, x, x + width - 1);
+}
+
+/**
+ * @brief Send the SSD1306 power-up sequence (pico-ssd1306's, 128x64 on the internal
+ *        charge pump) and point the library's handle at our back buffer.
+ */
+static void panel_init(void)
+{
+    static const uint8_t cmds[] = {
+        SET_DISP,
+        SET_MEM_ADDR, 0x00,
+        SET_DISP_START_LINE,
+        SET_SEG_REMAP | 0x01,
+        SET_MUX_RATIO, OLED_HEIGHT - 1,
+        SET_COM_OUT_DIR | 0x08,
+        SET_DISP_OFFSET, 0x00,
+        SET_COM_PIN_CFG, OLED_WIDTH > 2 * OLED_HEIGHT ? 0x02 : 0x12,
+        SET_DISP_CLK_DIV, 0x80,
+        SET_PRECHARGE, 0xF1,
+        SET_VCOM_DESEL, 0x30,
+        SET_CONTRAST, 0xFF,
+        SET_ENTIRE_ON,
+        SET_NORM_INV,
+        SET_CHARGE_PUMP, 0x14,
+        SET_DISP | 0x01,
+    };
+    for (size_t i = 0; i < sizeof(cmds); ++i) {
+        uint8_t cmd[2] = {0x00, cmds[i]}; // Co=0, D/C#=0: one command byte
+        i2c_write_blocking(I2C_PORT, OLED_ADDRESS, cmd, sizeof(cmd), false);
+    }
+
+    display = (ssd1306_t){
+        .width = OLED_WIDTH,
+        .height = OLED_HEIGHT,
+        .pages = OLED_PAGES,
+        .address = OLED_ADDRESS,
+        .i2c_i = I2C_PORT,
+        .external_vcc = false,
+        .buffer = back_buffer + OLED_BUFFER_SKEW,
+        .bufsize = OLED_FRAME_BYTES,
+    };
 }
 
 /**
@@ -42,56 +475,109 @@ void display_init(void)
     if (!ENABLE_OLED_DISPLAY)
         return;
 
-    // Initialize I2C at 400kHz
-    i2c_init(I2C_PORT, 400 * 1000);
+    // Initialize I2C at 400kHz, or 1MHz Fast-mode Plus
+    i2c_init(I2C_PORT, ENABLE_OLED_FAST_MODE_PLUS ? 1000 * 1000 : 400 * 1000);
     gpio_set_function(OLED_SDA_PIN, GPIO_FUNC_I2C);
     gpio_set_function(OLED_SCL_PIN, GPIO_FUNC_I2C);
     gpio_pull_up(OLED_SDA_PIN);
     gpio_pull_up(OLED_SCL_PIN);
 
-    // Initialize the SSD1306 display (128x64, I2C address 0x3C)
-    ssd1306_init(&display, 128, 64, 0x3C, I2C_PORT);
+    // Initialize the SSD1306 display (128x64, I2C address 0x3C) on our own buffers
+    panel_init();
+
+    display_dma_init();
     ssd1306_clear(&display);
-    ssd1306_show(&display);
+    display_present();
 }
 
 /**
- * @brief Show the SEGA logo bitmap on the display.
+ * @brief Show the SEGA logo bitmap on the display. Returns once the frame is
+ *        queued; it stays up until the next display_update_status().
  */
 void display_show_sega_logo(void)
 {
     if (!ENABLE_OLED_DISPLAY)
         return;
 
-    ssd1306_draw_bitmap(&display, 0, 0, 128, 64, sega_logo_bitmap);
-    ssd1306_show(&display);
-    sleep_ms(2000); // Wait for 2 seconds
     ssd1306_clear(&display);
-    ssd1306_show(&display);
+    display_draw_image(&sega_logo, 0, 0, 0);
+    // A frame still on the bus leaves the logo dirty, the next flush sends it
+    display_present();
+
+    // The status screen has to be redrawn from scratch
+    splash_shown = true;
+    status_shown = false;
+}
+
+/**
+ * @brief Set the console release time shown on the status screen.
+ * @param release_us Microseconds from power-on to the console's release, 0 to leave the line out.
+ */
+void display_set_boot_time(uint64_t release_us)
+{
+    boot_release_us = release_us;
 }
 
 /**
  * @brief Update the display with region, overclock status, and pad inputs.
+ *        Only lines whose value changed since the last call are re-rendered,
+ *        and only their columns are sent to the panel.
  * @param region      The current video region.
- * @param overclocked Overclock status (true if enabled).
+ * @param oc_vclk_khz 68000 clock while overclocked, 0 at stock speed.
  * @param pad         Current joypad state.
  */
-void display_update_status(region_t region, bool overclocked, joypad_state_t pad)
+void display_update_status(region_t region, uint32_t oc_vclk_khz, joypad_state_t pad)
 {
     if (!ENABLE_OLED_DISPLAY)
         return;
 
-    ssd1306_clear(&display);
+    if (splash_shown) {
+        ssd1306_clear(&display);
+        for (uint8_t page = 0; page < OLED_PAGES; ++page)
+            mark_dirty(page, 0, OLED_WIDTH - 1);
+        memset(line_width, 0, sizeof(line_width));
+        splash_shown = false;
+    }
+
+    if (!status_shown || region != shown.region)
+        draw_region_and_subcarrier(region);
+
+    if (!status_shown || oc_vclk_khz != shown_oc_khz) {
+        char oc_buf[24];
+        if (oc_vclk_khz)
+            snprintf(oc_buf, sizeof(oc_buf), "OC: %lu.%02luMHz", (unsigned long)(oc_vclk_khz / 1000),
+                     (unsigned long)(oc_vclk_khz % 1000 / 10));
+        else
+            snprintf(oc_buf, sizeof(oc_buf), "OC: OFF");
+        draw_status_line(STATUS_OC_PAGE, oc_buf);
+    }
+
+    if (!status_shown || memcmp(&pad, &shown.pad, sizeof(pad)) != 0)
+        display_pad_inputs(pad);
 
-    draw_region_and_subcarrier(region);
+    if (!status_shown || boot_release_us != shown_boot_us) {
+        char boot_buf[32] = "";
+        if (boot_release_us)
+            snprintf(boot_buf, sizeof(boot_buf), "BOOT: %lu.%03lums", (unsigned long)(boot_release_us / 1000),
+                     (unsigned long)(boot_release_us % 1000));
+        draw_status_line(STATUS_BOOT_PAGE, boot_buf);
+    }
 
-    char oc_buf[16];
-    snprintf(oc_buf, sizeof(oc_buf), "OC: %s", overclocked ? "ON" : "OFF");
-    ssd1306_draw_string(&display, 0, 20, 1, oc_buf);
+    // The console's frame rate while its vertical sync is counted, else the panel's
+    uint32_t fps_now = frame_sync_locked() ? frame_sync_fps() : display_get_fps();
+    if (!status_shown || fps_now != shown_fps) {
+        char fps_buf[16];
+        snprintf(fps_buf, sizeof(fps_buf), "FPS: %lu", (unsigned long)fps_now);
+        draw_status_line(STATUS_FPS_PAGE, fps_buf);
+    }
 
-    display_pad_inputs(pad);
+    shown = (system_status_t){.region = region, .overclocked = oc_vclk_khz != 0, .pad = pad};
+    shown_oc_khz = oc_vclk_khz;
+    shown_fps = fps_now;
+    shown_boot_us = boot_release_us;
+    status_shown = true;
 
-    ssd1306_show(&display);
+    display_flush();
 }
 
 /**
@@ -107,7 +593,7 @@ void draw_region_and_subcarrier(region_t region)
                             (region == REGION_BRA) ? "PAL-M" : "PAL";
     char line[32];
     snprintf(line, sizeof(line), "%s / %s", region_str, clock_str);
-    ssd1306_draw_string(&display, 0, 0, 1, line);
+    draw_status_line(STATUS_REGION_PAGE, line);
 }
 
 /**
@@ -158,5 +644,5 @@ void display_pad_inputs(joypad_state_t pad)
     {
         snprintf(pad_buf + pad_buf_len, pad_buf_remaining, " (none)");
     }
-    ssd1306_draw_string(&display, 0, 30, 1, pad_buf);
+    draw_status_line(STATUS_PAD_PAGE, pad_buf);
 }
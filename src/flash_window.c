@@ -0,0 +1,105 @@
+#include "flash_window.h"
+#include "rt_timer.h"
+#include "setup.h"
+#include "pico/flash.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+/*
+ * Flash write window
+ * ------------------
+ * The SDK's default flash_safe_execute() helper locks core 1 out for the
+ * whole write: it spins in RAM with interrupts off, so pad decoding stops
+ * for as long as an erase takes. This helper replaces it. Core 1 is asked
+ * to move into a RAM-resident loop that keeps doing its real-time work
+ * (flash_window_service()), and only core 0, the writer, masks its
+ * interrupts. Everything core 1 runs in that loop, code and data, must be
+ * in SRAM (__not_in_flash_func, rt_timer.h).
+ */
+
+static volatile bool core1_joined = false;   ///< Core 1 runs flash_window_service()
+static volatile bool window_requested = false;
+static volatile bool core1_parked = false;
+static uint32_t saved_irq;
+
+static bool window_core_init_deinit(bool init)
+{
+    if (get_core_num() == 1)
+        core1_joined = init;
+    return true;
+}
+
+static int window_enter(uint32_t timeout_ms)
+{
+    if (get_core_num() != 0)
+        return PICO_ERROR_NOT_PERMITTED;
+
+    if (core1_joined) {
+        absolute_time_t deadline = make_timeout_time_ms(timeout_ms);
+        // Core 1 may still be on its way out of the previous window
+        while (core1_parked) {
+            if (time_reached(deadline))
+                return PICO_ERROR_TIMEOUT;
+            tight_loop_contents();
+        }
+        window_requested = true;
+        __dmb();
+        while (!core1_parked) {
+            if (time_reached(deadline)) {
+                window_requested = false;
+                return PICO_ERROR_TIMEOUT;
+            }
+            tight_loop_contents();
+        }
+    }
+
+    // Our own interrupt handlers live in flash
+    saved_irq = save_and_disable_interrupts();
+    return PICO_OK;
+}
+
+static int window_exit(uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    restore_interrupts(saved_irq);
+    __dmb();
+    window_requested = false;
+    return PICO_OK;
+}
+
+static flash_safety_helper_t window_helper = {
+    .core_init_deinit = window_core_init_deinit,
+    .enter_safe_zone_timeout_ms = window_enter,
+    .exit_safe_zone_timeout_ms = window_exit,
+};
+
+/**
+ * @brief Replaces the SDK's default helper used by flash_safe_execute().
+ */
+flash_safety_helper_t *get_flash_safety_helper(void)
+{
+    return &window_helper;
+}
+
+/**
+ * @brief Core 1 side of flash writes: when core 0 is about to write flash,
+ *        acknowledge and keep calling rt_work (which must be RAM-resident)
+ *        until flash is usable again. Returns straight away otherwise.
+ *        Core 1 must have called flash_safe_execute_core_init() first.
+ * @param rt_work Real-time work to keep doing, called every FLASH_WINDOW_POLL_US.
+ */
+void __not_in_flash_func(flash_window_service)(void (*rt_work)(void))
+{
+    if (!window_requested)
+        return;
+
+    core1_parked = true;
+    __dmb();
+    // The caller has just done its work: wait first, and leave right after a pass
+    do {
+        rt_busy_wait_us(FLASH_WINDOW_POLL_US);
+        rt_work();
+    } while (window_requested);
+    __dmb();
+    core1_parked = false;
+}
@@ -0,0 +1,184 @@
+#include "frame_sync.h"
+#include "setup.h"
+#include "trace.h"
+#include "rt_timer.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "pico/time.h"
+#include "frame_sync.pio.h"
+
+/*
+ * Frame-synchronous changes
+ * -------------------------
+ * Region and overclock changes used to land wherever the main loop was,
+ * mid-frame as far as the VDP is concerned. With a vertical sync input a
+ * PIO program counts frames (frame_sync.pio) and raises an interrupt at
+ * the start of each vertical blank. Changes are queued with
+ * frame_sync_defer() and run from that interrupt, while the VDP is not
+ * drawing. Without a signal (input not wired, console off) changes run
+ * straight away, as before, and a change queued just as the signal goes
+ * away runs from a fallback alarm. The frame count also gives the display
+ * and the trace the console's frame rate.
+ */
+
+#define FRAME_SYNC_PIO       pio1
+#define FRAME_SYNC_IRQ       PIO1_IRQ_0
+#define FRAME_SYNC_QUEUE_LEN 4     ///< Different changes waiting for the same vertical blank
+
+static int sync_sm = -1;
+static uint32_t last_count = UINT32_MAX;   ///< Count pushed for the previous frame
+static volatile uint32_t frames = 0;
+static volatile uint32_t last_frame_us = 0;  ///< Low word of the time: atomic, and FRAME_SYNC_LOST_US is short
+
+static void (*pending[FRAME_SYNC_QUEUE_LEN])(void);
+static uint8_t pending_count = 0;
+static alarm_id_t fallback_alarm = 0;
+
+static uint32_t fps = 0;
+static uint32_t fps_window_frames = 0;
+static uint64_t fps_window_start = 0;
+
+/**
+ * @brief Run and clear the queued changes. Called with IRQs disabled or from an IRQ.
+ */
+static void run_pending(void)
+{
+    if (fallback_alarm > 0) {
+        cancel_alarm(fallback_alarm);
+        fallback_alarm = 0;
+    }
+    for (uint8_t i = 0; i < pending_count; ++i)
+        pending[i]();
+    pending_count = 0;
+}
+
+/**
+ * @brief Alarm callback: the sync signal went away with changes queued.
+ */
+static int64_t fallback_callback(alarm_id_t id, void *user_data)
+{
+    (void)id;
+    (void)user_data;
+    fallback_alarm = 0;
+    run_pending();
+    return 0;
+}
+
+/**
+ * @brief PIO IRQ handler: a vertical blank started.
+ */
+static void __not_in_flash_func(frame_irq_handler)(void)
+{
+    if (!pio_interrupt_get(FRAME_SYNC_PIO, 0))
+        return;
+    trace_begin(TRACE_ISR, FRAME_SYNC_IRQ);
+    pio_interrupt_clear(FRAME_SYNC_PIO, 0);
+
+    // The FIFO holds the running count, so a late interrupt loses no frames
+    uint32_t count = last_count;
+    while (!pio_sm_is_rx_fifo_empty(FRAME_SYNC_PIO, sync_sm))
+        count = pio_sm_get(FRAME_SYNC_PIO, sync_sm);
+    frames += count - last_count;
+    last_count = count;
+    last_frame_us = (uint32_t)rt_time_us_64();
+    trace_mark(TRACE_VBLANK, frames);
+
+    run_pending();
+    trace_end(TRACE_ISR, FRAME_SYNC_IRQ);
+}
+
+/**
+ * @brief Start counting frames on GPIO_VSYNC_PIN. Call on core 0: the
+ *        vertical blank interrupt, and the changes it applies, run there.
+ */
+void frame_sync_init(void)
+{
+    if (!ENABLE_FRAME_SYNC)
+        return;
+
+    // Unwired, the input idles high and no frames are counted
+    gpio_init(GPIO_VSYNC_PIN);
+    gpio_set_dir(GPIO_VSYNC_PIN, GPIO_IN);
+    gpio_pull_up(GPIO_VSYNC_PIN);
+
+    sync_sm = pio_claim_unused_sm(FRAME_SYNC_PIO, true);
+    uint offset = pio_add_program(FRAME_SYNC_PIO, &frame_sync_program);
+    pio_interrupt_clear(FRAME_SYNC_PIO, 0);
+    pio_set_irq0_source_enabled(FRAME_SYNC_PIO, pis_interrupt0, true);
+    irq_add_shared_handler(FRAME_SYNC_IRQ, frame_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(FRAME_SYNC_IRQ, true);
+    frame_sync_program_init(FRAME_SYNC_PIO, sync_sm, offset, GPIO_VSYNC_PIN, FRAME_SYNC_FILTER_NS);
+}
+
+/**
+ * @brief Run a clock, divider or region jumper change at the start of the
+ *        next vertical blank, from the frame interrupt. Runs it straight away
+ *        when there is no sync signal, and after FRAME_SYNC_LOST_US if the
+ *        signal goes away in the meantime. A change already waiting is not
+ *        queued twice: it reads the current settings when it runs.
+ * @param fn Change to apply.
+ */
+void frame_sync_defer(void (*fn)(void))
+{
+    if (!frame_sync_locked()) {
+        fn();
+        return;
+    }
+
+    uint32_t irq = save_and_disable_interrupts();
+    uint8_t i = 0;
+    while (i < pending_count && pending[i] != fn)
+        ++i;
+    if (i == FRAME_SYNC_QUEUE_LEN) {
+        // Never drop a change: make room by applying what is waiting now
+        run_pending();
+        i = 0;
+    }
+    if (i == pending_count)
+        pending[pending_count++] = fn;
+    if (!fallback_alarm) {
+        fallback_alarm = add_alarm_in_us(FRAME_SYNC_LOST_US, fallback_callback, NULL, true);
+        hard_assert(fallback_alarm > 0);
+    }
+    restore_interrupts(irq);
+}
+
+/**
+ * @brief Check whether frames are being counted.
+ * @return true if a vertical sync pulse arrived within FRAME_SYNC_LOST_US.
+ */
+bool frame_sync_locked(void)
+{
+    return ENABLE_FRAME_SYNC && frames && time_us_32() - last_frame_us < FRAME_SYNC_LOST_US;
+}
+
+/**
+ * @brief Frames counted since frame_sync_init().
+ * @return Frame count.
+ */
+uint32_t frame_sync_frames(void)
+{
+    return frames;
+}
+
+/**
+ * @brief Console frames per second, measured over ~1 s windows.
+ * @return Frames per second, 0 without a sync signal.
+ */
+uint32_t frame_sync_fps(void)
+{
+    uint64_t now = time_us_64();
+    uint64_t elapsed = now - fps_window_start;
+
+    if (!frame_sync_locked())
+        return 0;
+    if (elapsed >= 1000000) {
+        uint32_t counted = frames;
+        fps = (uint32_t)((uint64_t)(counted - fps_window_frames) * 1000000 / elapsed);
+        fps_window_frames = counted;
+        fps_window_start = now;
+    }
+    return fps;
+}
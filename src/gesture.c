@@ -0,0 +1,150 @@
+#include "gesture.h"
+#include "setup.h"
+#include "trace.h"
+#include "pico/stdlib.h"
+
+/*
+ * Gesture engine
+ * --------------
+ * The original main loop timed hotkey holds by counting sleep_ms(1) passes
+ * and the triple reset tap by bumping a counter once per pass, so every
+ * stall in the loop stretched the gestures. Here every input change carries
+ * the time it was observed (core 1 stamps pad changes, the GPIO IRQ stamps
+ * reset button edges) and gestures are judged on those stamps alone: a hold
+ * is satisfied if no change arrived before press + hold time, however late
+ * the loop gets round to checking. Pad and reset button share one packed
+ * mask and every gesture is evaluated in one pass per change.
+ */
+
+/// Slack for a change stamped on core 1 but not popped yet when a deadline is checked
+#define GESTURE_INPUT_LAG_US (PAD_POLL_INTERVAL_MS * 1000)
+
+typedef struct
+{
+    uint64_t since_us;   ///< HOLD: chord matched since; TAPS: first press of the run
+    uint8_t count;       ///< TAPS: presses in the current run
+    bool active;         ///< HOLD: chord currently matched
+    bool fired;          ///< HOLD: already fired for this press
+} gesture_state_t;
+
+static const gesture_t *gestures;
+static uint8_t gesture_count;
+static gesture_state_t state[GESTURE_MAX];
+static uint16_t buttons;   ///< Current packed input mask
+
+/**
+ * @brief Input bits a chord is compared against.
+ */
+static inline uint16_t chord_group(uint16_t chord)
+{
+    return (chord & GESTURE_BTN_RESET) ? GESTURE_BTN_RESET : GESTURE_PAD_BITS;
+}
+
+/**
+ * @brief Run a gesture's action.
+ */
+static void fire(uint8_t i)
+{
+    trace_mark(TRACE_GESTURE, i);
+    gestures[i].action();
+}
+
+/**
+ * @brief Install a gesture table and clear all gesture state.
+ * @param table Gestures (must stay valid while in use).
+ * @param count Number of entries, at most GESTURE_MAX.
+ */
+void gesture_init(const gesture_t *table, uint8_t count)
+{
+    hard_assert(count <= GESTURE_MAX);
+    gestures = table;
+    gesture_count = count;
+    buttons = 0;
+    for (uint8_t i = 0; i < GESTURE_MAX; ++i)
+        state[i] = (gesture_state_t){0};
+}
+
+/**
+ * @brief Feed a timestamped input change. Changes of each group must arrive in time order.
+ * @param bits    Input bits this change covers (GESTURE_PAD_BITS or GESTURE_BTN_RESET).
+ * @param values  New state of those bits, pressed = 1.
+ * @param time_us When the change was observed.
+ */
+void gesture_input(uint16_t bits, uint16_t values, uint64_t time_us)
+{
+    uint16_t old = buttons;
+    uint16_t now = (uint16_t)((old & ~bits) | (values & bits));
+    if (now == old)
+        return;
+    buttons = now;
+
+    for (uint8_t i = 0; i < gesture_count; ++i) {
+        const gesture_t *g = &gestures[i];
+        gesture_state_t *s = &state[i];
+        uint16_t group = chord_group(g->chord);
+        if (!(group & bits))
+            continue;
+
+        bool was = (old & group) == g->chord;
+        bool is = (now & group) == g->chord;
+        if (was == is)
+            continue;
+
+        if (g->kind == GESTURE_HOLD) {
+            // The deadline passed before this change: the hold counts even if we are late
+            if (was && !s->fired && time_us >= s->since_us + g->time_us)
+                fire(i);
+            s->active = is;
+            s->fired = false;
+            s->since_us = time_us;
+        } else if (is) {
+            if (s->count == 0 || time_us - s->since_us > g->time_us) {
+                s->since_us = time_us;
+                s->count = 0;
+            }
+            if (++s->count >= g->taps) {
+                s->count = 0;
+                fire(i);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Fire every hold whose deadline has passed.
+ * @param now_us Current time_us_64().
+ */
+void gesture_update(uint64_t now_us)
+{
+    if (now_us < GESTURE_INPUT_LAG_US)
+        return;
+    uint64_t horizon = now_us - GESTURE_INPUT_LAG_US;
+
+    for (uint8_t i = 0; i < gesture_count; ++i) {
+        const gesture_t *g = &gestures[i];
+        gesture_state_t *s = &state[i];
+        if (g->kind == GESTURE_HOLD && s->active && !s->fired && horizon >= s->since_us + g->time_us) {
+            s->fired = true;
+            fire(i);
+        }
+    }
+}
+
+/**
+ * @brief Time gesture_update() next has something to do.
+ * @return Absolute time in microseconds, or UINT64_MAX when no hold is pending.
+ */
+uint64_t gesture_next_deadline_us(void)
+{
+    uint64_t next = UINT64_MAX;
+    for (uint8_t i = 0; i < gesture_count; ++i) {
+        const gesture_t *g = &gestures[i];
+        const gesture_state_t *s = &state[i];
+        if (g->kind == GESTURE_HOLD && s->active && !s->fired) {
+            uint64_t due = s->since_us + g->time_us + GESTURE_INPUT_LAG_US;
+            if (due < next)
+                next = due;
+        }
+    }
+    return next;
+}
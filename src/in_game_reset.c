@@ -0,0 +1,10 @@
+#include "in_game_reset.h"
+#include "console_control.h"
+
+/**
+ * @brief Reset the console from the pad (A+B+C+Start hotkey).
+ */
+void handle_ingame_reset(void)
+{
+    console_reset();
+}
@@ -0,0 +1,342 @@
+#include "logic_analyzer.h"
+#include "rt_timer.h"
+#include "trace.h"
+#include "clock_plan.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "logic_analyzer.pio.h"
+#include <stdio.h>
+
+/*
+ * Logic analyzer
+ * --------------
+ * A one-instruction PIO program samples GPIO_PIN_UP and the 15 GPIOs above
+ * it (pad lines, SELECT, !HALT, /VSYNC, the region jumpers, !CART_CE, !VRES) at
+ * LA_SAMPLE_HZ, two samples per word. DMA streams the words into
+ * LA_RING_CHUNKS 32 KB rings, one channel per ring, each chained to the
+ * next. A channel wraps its own write address, so the chain runs forever
+ * without a control channel or the CPU.
+ *
+ * A trigger only shortens the chain: the channel that will write the last
+ * post-trigger word gets a shorter reload and no chain, so the capture stops
+ * on its own about LA_RING_CHUNKS - 1 rings after the trigger, with one ring
+ * of history before it. Once it has stopped, core 0 sends it over USB CDC as
+ * run-length records and re-arms. tools/la_decode.py turns the records into
+ * VCD and replays the SELECT edges through the pad sniffer's decoder.
+ *
+ * Export format, one "%" line each (shares the stdio stream with printf and
+ * the trace export):
+ *
+ *   %LA 1 <sample Hz> <first GPIO> <hex pin mask> <samples> <trigger sample> <la_trigger_t>
+ *   %<hex>      records: 16-bit state (little endian), then run length as LEB128
+ *   %END <records>
+ */
+
+#define LA_PIO              pio1
+#define LA_PIN_BASE         GPIO_PIN_UP
+#define LA_RING_BITS        15                                      ///< log2 of ring size in bytes (DMA maximum)
+#define LA_CHUNK_WORDS      ((1u << LA_RING_BITS) / sizeof(uint32_t))
+#define LA_RING_WORDS       (LA_RING_CHUNKS * LA_CHUNK_WORDS)
+#define LA_RING_SAMPLES     (2 * LA_RING_WORDS)
+#define LA_FIFO_WORDS       8                                       ///< Joined RX FIFO depth
+/// Words after the trigger, short of the FIFO depth so the stop never falls in the running ring
+#define LA_POST_WORDS       ((LA_RING_CHUNKS - 1) * LA_CHUNK_WORDS - LA_FIFO_WORDS)
+#define LA_HANDOVER_WORDS   32                                      ///< A ring this close to its end is left to hand over first
+#define LA_FIND_TRIES       256                                     ///< Passes over the rings before a trigger gives up (a hand-over takes ~16 us)
+#define LA_LINE_BYTES       32                                      ///< Record bytes per export line
+#define LA_RECORD_MAX       7                                       ///< State + 5-byte LEB128 run
+#define LA_EXPORT_LINES     32                                      ///< Lines sent per la_drain() call
+
+#define LA_BIT(gpio)        (1u << ((gpio) - LA_PIN_BASE))
+
+/// Exported lines; the rest (jumpers, OLED bus) would only break up the runs
+#define LA_EXPORT_MASK                                                                                  \
+    (LA_BIT(GPIO_PIN_UP) | LA_BIT(GPIO_PIN_DOWN) | LA_BIT(GPIO_PIN_LEFT) | LA_BIT(GPIO_PIN_RIGHT) |     \
+     LA_BIT(GPIO_PIN_B) | LA_BIT(GPIO_PIN_C) | LA_BIT(GPIO_PIN_SELECT) | LA_BIT(GPIO_HALT_PIN) |        \
+     LA_BIT(GPIO_VSYNC_PIN) | LA_BIT(GPIO_CART_CE_PIN) | LA_BIT(GPIO_VRES_PIN))
+
+_Static_assert(LA_RING_CHUNKS >= 3, "the trigger needs a ring between the running one and the last");
+_Static_assert(GPIO_PIN_SELECT - LA_PIN_BASE < 16 && GPIO_HALT_PIN - LA_PIN_BASE < 16 &&
+                   GPIO_VSYNC_PIN - LA_PIN_BASE < 16 && GPIO_CART_CE_PIN - LA_PIN_BASE < 16 && GPIO_VRES_PIN - LA_PIN_BASE < 16,
+               "logic analyzer lines must lie within 16 GPIOs of GPIO_PIN_UP");
+_Static_assert(CLOCK_PLAN_USB_CLOCK || !ENABLE_LOGIC_ANALYZER, "captures export over USB CDC: use CLOCK_MODE_DECOUPLED or CLOCK_MODE_RELOCK");
+
+typedef enum
+{
+    LA_OFF,
+    LA_ARMED,      ///< Chain running, waiting for a trigger
+    LA_STOPPING,   ///< Triggered, the last ring has not finished yet
+    LA_EXPORT      ///< Stopped, waiting for or talking to a host
+} la_state_t;
+
+// Sized down to nothing when disabled: the rings are most of the RAM
+static uint32_t ring[LA_RING_CHUNKS][ENABLE_LOGIC_ANALYZER ? LA_CHUNK_WORDS : 1]
+    __attribute__((aligned(ENABLE_LOGIC_ANALYZER ? 1u << LA_RING_BITS : 4)));
+
+static int la_sm = -1;
+static uint chans[LA_RING_CHUNKS];
+static dma_channel_config chan_cfg[LA_RING_CHUNKS];
+static uint32_t sample_hz;
+static volatile la_state_t state = LA_OFF;
+static uint64_t armed_us;
+
+/**
+ * @brief The frozen capture, in ring words, and the export cursor.
+ */
+static struct
+{
+    uint32_t first_word;    ///< Oldest word of the capture
+    uint32_t words;         ///< Capture length
+    uint32_t trigger_word;  ///< Word the trigger fell in, relative to first_word
+    uint8_t source;         ///< la_trigger_t
+    uint32_t next;          ///< Next sample to encode, relative to the first
+    uint16_t run_state;     ///< State of the open run
+    uint32_t run;           ///< Length of the open run, 0 before the first sample
+    uint32_t records;       ///< Records sent
+} cap;
+
+/**
+ * @brief Start the chain from ring 0 with empty FIFOs.
+ */
+static void arm(void)
+{
+    pio_sm_set_enabled(LA_PIO, la_sm, false);
+    pio_sm_clear_fifos(LA_PIO, la_sm);
+    pio_sm_restart(LA_PIO, la_sm);
+
+    for (uint i = 0; i < LA_RING_CHUNKS; ++i) {
+        channel_config_set_chain_to(&chan_cfg[i], chans[(i + 1) % LA_RING_CHUNKS]);
+        dma_channel_configure(chans[i], &chan_cfg[i], ring[i], &LA_PIO->rxf[la_sm], LA_CHUNK_WORDS, i == 0);
+    }
+    armed_us = rt_time_us_64();
+    state = LA_ARMED;
+    pio_sm_set_enabled(LA_PIO, la_sm, true);
+}
+
+/**
+ * @brief Start sampling the pad and console lines into the capture rings.
+ *        Claims a PIO state machine and LA_RING_CHUNKS DMA channels. Core 0.
+ */
+void la_init(void)
+{
+    if (!ENABLE_LOGIC_ANALYZER)
+        return;
+
+    // Divider in 1/256ths. Region switches move clk_sys by under 1%, and the reported rate with it
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    uint32_t div256 = (uint32_t)(((uint64_t)sys_hz * 256 + LA_SAMPLE_HZ / 2) / LA_SAMPLE_HZ);
+    if (div256 < 256)
+        div256 = 256;
+    sample_hz = (uint32_t)((uint64_t)sys_hz * 256 / div256);
+
+    la_sm = pio_claim_unused_sm(LA_PIO, true);
+    uint offset = pio_add_program(LA_PIO, &logic_analyzer_program);
+    logic_analyzer_program_init(LA_PIO, la_sm, offset, LA_PIN_BASE, (uint16_t)(div256 >> 8), (uint8_t)div256);
+
+    for (uint i = 0; i < LA_RING_CHUNKS; ++i) {
+        chans[i] = dma_claim_unused_channel(true);
+        dma_channel_config c = dma_channel_get_default_config(chans[i]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_ring(&c, true, LA_RING_BITS);
+        channel_config_set_dreq(&c, pio_get_dreq(LA_PIO, la_sm, false));
+        chan_cfg[i] = c;
+    }
+    arm();
+}
+
+/**
+ * @brief Find the ring whose channel is writing, clear of a chain hand-over.
+ *        Gives up after LA_FIND_TRIES passes: a stalled chain must not hang the caller.
+ * @param ring_out  Receives the ring.
+ * @param remaining Receives the words left in that ring.
+ * @return false if no ring was found.
+ */
+static bool __not_in_flash_func(running_ring)(uint *ring_out, uint32_t *remaining)
+{
+    for (uint tries = 0; tries < LA_FIND_TRIES; ++tries) {
+        for (uint i = 0; i < LA_RING_CHUNKS; ++i) {
+            // About to finish: wait for the next ring to start rather than race the chain
+            uint32_t left = dma_channel_hw_addr(chans[i])->transfer_count;
+            if (dma_channel_is_busy(chans[i]) && left >= LA_HANDOVER_WORDS) {
+                *ring_out = i;
+                *remaining = left;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Stop the running capture LA_RING_CHUNKS - 1 rings from now.
+ *        Ignored unless armed. RAM-resident and safe from IRQs on core 0.
+ * @param source Reason for the trigger, reported with the capture.
+ */
+void __not_in_flash_func(la_trigger)(la_trigger_t source)
+{
+    if (!ENABLE_LOGIC_ANALYZER || state != LA_ARMED)
+        return;
+    uint32_t irq = save_and_disable_interrupts();
+
+    uint c;
+    uint32_t remaining;
+    if (!running_ring(&c, &remaining)) {
+        // The chain is not running: drop the trigger and stay armed
+        restore_interrupts(irq);
+        trace_mark(TRACE_LA_TRIGGER_MISSED, source);
+        return;
+    }
+    // Words still in the FIFO were sampled before the trigger too
+    uint32_t pos = c * LA_CHUNK_WORDS + (LA_CHUNK_WORDS - remaining);
+    uint32_t trigger = (pos + pio_sm_get_rx_fifo_level(LA_PIO, la_sm)) % LA_RING_WORDS;
+    uint32_t end = (trigger + LA_POST_WORDS) % LA_RING_WORDS;
+
+    // The last word falls `to_end` words into the rings from the start of ring c on:
+    // that ring stops there, the ones before it run full and keep their chain
+    uint32_t to_end = (end + LA_RING_WORDS - c * LA_CHUNK_WORDS) % LA_RING_WORDS;
+    if (to_end == 0)
+        to_end = LA_RING_WORDS;
+    uint steps = (to_end - 1) / LA_CHUNK_WORDS;
+    uint last = (c + steps) % LA_RING_CHUNKS;
+    channel_config_set_chain_to(&chan_cfg[last], chans[last]);
+    dma_channel_set_config(chans[last], &chan_cfg[last], false);
+    dma_channel_set_trans_count(chans[last], to_end - steps * LA_CHUNK_WORDS, false);
+    state = LA_STOPPING;
+    uint64_t armed_for_us = rt_time_us_64() - armed_us;
+
+    // The chain is cut; the rest only fills in cap, read once the last ring stops. Later
+    // triggers see LA_STOPPING and return, so it can run with interrupts back on.
+    restore_interrupts(irq);
+
+    // Samples older than the arming are stale
+    uint64_t armed_words = armed_for_us * sample_hz / 2000000u;
+    uint32_t history = LA_RING_WORDS - LA_POST_WORDS;
+    if (armed_words < history + LA_FIFO_WORDS)
+        history = armed_words > LA_FIFO_WORDS ? (uint32_t)armed_words - LA_FIFO_WORDS : 0;
+    cap.first_word = (trigger + LA_RING_WORDS - history) % LA_RING_WORDS;
+    cap.words = history + LA_POST_WORDS;
+    cap.trigger_word = history;
+    cap.source = (uint8_t)source;
+}
+
+/**
+ * @brief Gesture action: trigger a capture from the pad.
+ */
+void handle_la_trigger(void)
+{
+    la_trigger(LA_TRIGGER_PAD);
+}
+
+/**
+ * @brief Append one run-length record.
+ * @return Bytes written, at most LA_RECORD_MAX.
+ */
+static size_t put_record(uint8_t *out, uint16_t value, uint32_t run)
+{
+    size_t n = 0;
+    out[n++] = (uint8_t)value;
+    out[n++] = (uint8_t)(value >> 8);
+    do {
+        uint8_t byte = run & 0x7F;
+        run >>= 7;
+        out[n++] = byte | (run ? 0x80 : 0);
+    } while (run);
+    return n;
+}
+
+/**
+ * @brief Send record bytes as a line of hex.
+ */
+static void send_line(const uint8_t *bytes, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[1 + 2 * LA_LINE_BYTES + 1];
+
+    line[0] = '%';
+    for (size_t i = 0; i < len; ++i) {
+        line[1 + 2 * i] = hex[bytes[i] >> 4];
+        line[2 + 2 * i] = hex[bytes[i] & 0xF];
+    }
+    line[1 + 2 * len] = '\0';
+    puts(line);
+}
+
+/**
+ * @brief Encode up to LA_EXPORT_LINES lines of the frozen capture.
+ * @return true once the whole capture has been sent.
+ */
+static bool export_batch(void)
+{
+    const uint16_t *samples = (const uint16_t *)ring;
+    uint32_t first = 2 * cap.first_word;
+    uint32_t total = 2 * cap.words;
+
+    if (cap.next == 0 && cap.run == 0)
+        printf("%%LA 1 %lu %u %04x %lu %lu %u\n", (unsigned long)sample_hz, LA_PIN_BASE, LA_EXPORT_MASK,
+               (unsigned long)total, (unsigned long)(2 * cap.trigger_word), cap.source);
+
+    for (uint lines = 0; lines < LA_EXPORT_LINES; ++lines) {
+        uint8_t buf[LA_LINE_BYTES];
+        size_t len = 0;
+        while (len + LA_RECORD_MAX <= sizeof(buf) && cap.next < total) {
+            uint16_t value = samples[(first + cap.next++) % LA_RING_SAMPLES] & LA_EXPORT_MASK;
+            if (cap.run && value == cap.run_state) {
+                cap.run++;
+                continue;
+            }
+            if (cap.run) {
+                len += put_record(buf + len, cap.run_state, cap.run);
+                cap.records++;
+            }
+            cap.run_state = value;
+            cap.run = 1;
+        }
+        if (cap.next == total && cap.run && len + LA_RECORD_MAX <= sizeof(buf)) {
+            len += put_record(buf + len, cap.run_state, cap.run);
+            cap.records++;
+            cap.run = 0;
+        }
+        if (len)
+            send_line(buf, len);
+        if (cap.next == total && cap.run == 0) {
+            printf("%%END %lu\n", (unsigned long)cap.records);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Send a finished capture to the host over USB CDC, a bounded batch
+ *        per call, then re-arm. Core 0 only. A capture waits for a host.
+ * @return true while a capture is being sent: call again within TRACE_DRAIN_INTERVAL_US.
+ */
+bool la_drain(void)
+{
+    if (!ENABLE_LOGIC_ANALYZER || state == LA_OFF || state == LA_ARMED)
+        return false;
+
+    if (state == LA_STOPPING) {
+        for (uint i = 0; i < LA_RING_CHUNKS; ++i) {
+            if (dma_channel_is_busy(chans[i]))
+                return false;
+        }
+        // The FIFO fills and the program stalls; stop it so re-arming starts clean
+        pio_sm_set_enabled(LA_PIO, la_sm, false);
+        cap.next = 0;
+        cap.run = 0;
+        cap.records = 0;
+        state = LA_EXPORT;
+    }
+
+    if (!trace_host_connected())
+        return false;
+    if (!export_batch())
+        return true;
+    arm();
+    return false;
+}
@@ -4,74 +4,298 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
+#include "pico/flash.h"
 #include "hardware/flash.h"
 #include "hardware/sync.h"
 #include "hardware/watchdog.h"
 #include "clock_control.h"
 #include "display.h"
 #include "controller.h"
+#include "pad_sniffer.h"
+#include "pad_channel.h"
 #include "structs.h"
-// #include "region_switch.h"
-// #include "reset_button.h"
-// #include "config_store.h"
+#include "region_switch.h"
+#include "in_game_reset.h"
+#include "overclock.h"
+#include "gesture.h"
+#include "config_store.h"
+#include "tmss_skip.h"
+#include "console_control.h"
+#include "trace.h"
+#include "status_led.h"
+#include "flash_window.h"
+#include "rt_timer.h"
+#include "logic_analyzer.h"
+#include "scheduler.h"
+#include "frame_sync.h"
 
 #define LED_PIN 25 ///< Onboard LED pin
 
 /**
  * @brief Global system status structure.
  *        Holds current region, overclocking state, and joypad state.
+ *        Owned by core 0; core 1 only talks to it through the pad channel.
  */
 system_status_t system_status = {
     .region = REGION_JPN,      // Default region
     .overclocked = false,      // Default overclocking state
+    .oc_step = VCLK_OC_DEFAULT_STEP, // Overclock ladder step
     .pad = {0}                 // Initialize joypad state to zero
 };
 
+/**
+ * @brief Hotkeys, evaluated by the gesture engine on timestamped input.
+ */
+static const gesture_t hotkeys[] = {
+    {GESTURE_HOLD, PAD_BTN_A | PAD_BTN_B | PAD_BTN_C | PAD_BTN_START, 0, HOTKEY_HOLD_US, handle_ingame_reset},
+    {GESTURE_HOLD, PAD_BTN_A | PAD_BTN_START, 0, HOTKEY_HOLD_US, handle_overclock_toggle},
+    {GESTURE_HOLD, PAD_BTN_A | PAD_BTN_START | PAD_BTN_UP, 0, HOTKEY_HOLD_US, handle_overclock_faster},
+    {GESTURE_HOLD, PAD_BTN_A | PAD_BTN_START | PAD_BTN_DOWN, 0, HOTKEY_HOLD_US, handle_overclock_slower},
+    {GESTURE_TAPS, GESTURE_BTN_RESET, REGION_SWITCH_TAPS, REGION_SWITCH_WINDOW_US, handle_region_switch},
+    {GESTURE_HOLD, PAD_BTN_B | PAD_BTN_C | PAD_BTN_START, 0, LA_TRIGGER_HOLD_US, handle_la_trigger},
+};
+
+static joypad_state_t core1_pad;
+
+/**
+ * @brief Read the pad once and publish any change (core 1).
+ *        RAM-resident, so it also runs from flash_window_service() while core 0 writes flash.
+ */
+static void __not_in_flash_func(core1_read_pad)(void)
+{
+    trace_begin(TRACE_PAD_SAMPLE, 0);
+    if (ENABLE_PAD_SNIFFER)
+    {
+        // Decode whatever the console polled since the last pass
+        if (pad_sniffer_poll(&core1_pad))
+            pad_channel_publish(pad_mask_from_state(&core1_pad), rt_time_us_64());
+    }
+    else
+    {
+        read_genesis_joypad(&core1_pad);
+        pad_channel_publish(pad_mask_from_state(&core1_pad), rt_time_us_64());
+    }
+    trace_end(TRACE_PAD_SAMPLE, pad_mask_from_state(&core1_pad));
+}
+
+/**
+ * @brief Core 1 pad task: read the pad, and keep reading it from SRAM while core 0 writes flash.
+ */
+static void core1_pad_task(void)
+{
+    core1_read_pad();
+    flash_window_service(core1_read_pad);
+}
+
+static const sched_task_t core1_tasks[] = {
+    {"pad", core1_pad_task, ENABLE_PAD_SNIFFER ? PAD_POLL_INTERVAL_MS * 1000 : PAD_READ_INTERVAL_US, 0, 0, false},
+};
+
 /**
  * @brief Core 1 entry point.
  *        Handles background tasks such as reading the joypad state.
+ *        Pad changes are handed to core 0 through the pad channel only.
  */
 void core1_entry()
 {
+    // Let core 0 move us into the flash write window while it saves the config
+    flash_safe_execute_core_init();
+
+    if (ENABLE_PAD_SNIFFER)
+        pad_sniffer_init();
+
+    sched_init(core1_tasks, sizeof(core1_tasks) / sizeof(core1_tasks[0]));
     while (true)
+        sched_dispatch();
+}
+
+/**
+ * @brief Core 0 tasks, by index in core0_tasks.
+ */
+enum
+{
+    TASK_GESTURES,
+    TASK_INPUT,
+    TASK_LED,
+    TASK_EXPORT,
+    TASK_DISPLAY,
+    TASK_CONFIG,
+    TASK_SPLASH,
+    TASK_USB,
+};
+
+/**
+ * @brief Arm the one-shot tasks the hotkeys drive: the next hold deadline, and the
+ *        config write-behind if an action changed a setting.
+ */
+static void arm_hotkey_tasks(void)
+{
+    sched_release(TASK_GESTURES, gesture_next_deadline_us());
+    sched_release(TASK_CONFIG, config_write_due_us());
+}
+
+/**
+ * @brief Fire the hotkey holds that are due.
+ */
+static void run_gestures(void)
+{
+    gesture_update(time_us_64());
+    arm_hotkey_tasks();
+}
+
+/**
+ * @brief Feed every pad and reset button change since the last pass to the hotkeys.
+ */
+static void collect_input(void)
+{
+    static bool reset_button_watched = false;
+
+    // Consume every pad change since the last pass, in order
+    pad_snapshot_t snap;
+    pad_mask_t pad_mask = pad_channel_latest(NULL);
+    while (pad_channel_pop(&snap))
+    {
+        pad_mask = snap.mask;
+        gesture_input(GESTURE_PAD_BITS, snap.mask, snap.time_us);
+    }
+    // The ring may have dropped changes if we stalled; the latest word never does
+    if (pad_channel_dropped())
+        pad_mask = pad_channel_latest(NULL);
+    system_status.pad = pad_state_from_mask(pad_mask);
+
+    // The reset button shares !VRES with the TMSS skip: watch it once the skip is done
+    if (!reset_button_watched && tmss_skip_poll())
     {
-        // Read the joypad state into the global system_status
-        read_genesis_joypad(&system_status.pad);
-        sleep_ms(10);
+        console_watch_reset_button();
+        reset_button_watched = true;
     }
+    console_button_event_t button;
+    while (console_reset_button_pop(&button))
+        gesture_input(GESTURE_BTN_RESET, button.pressed ? GESTURE_BTN_RESET : 0, button.time_us);
+
+    arm_hotkey_tasks();
 }
 
+/**
+ * @brief Follow region and overclock changes on the status LED.
+ */
+static void update_led(void)
+{
+    status_led_show(system_status.region, system_status.overclocked);
+}
+
+/**
+ * @brief Send trace events and logic analyzer captures to a listening host.
+ */
+static void drain_exports(void)
+{
+    bool exporting = trace_drain();
+    if (la_drain())
+        exporting = true;
+    // Every TRACE_DRAIN_INTERVAL_US while a host listens, rarely otherwise
+    if (!exporting)
+        sched_release(TASK_EXPORT, time_us_64() + EXPORT_IDLE_INTERVAL_US);
+}
+
+/**
+ * @brief Bring up the OLED and show the logo; the status screen follows after SPLASH_TIME_US.
+ */
+static void show_splash(void)
+{
+    display_init();
+    display_set_boot_time(console_boot_release_us());
+    display_show_sega_logo();
+    sched_release(TASK_DISPLAY, time_us_64() + SPLASH_TIME_US);
+}
+
+/**
+ * @brief Bring up USB stdio, and report how soon the console was let go.
+ *        Only released when clk_usb runs at 48 MHz (see clock_usb_running()).
+ */
+static void start_usb(void)
+{
+    stdio_init_all();
+    printf("Console released %lu us after power-on\n", (unsigned long)console_boot_release_us());
+}
+
+/**
+ * @brief Redraw the status screen.
+ */
+static void refresh_display(void)
+{
+    display_update_status(system_status.region, system_status.overclocked ? clock_get_vclk_hz() / 1000 : 0,
+                          system_status.pad);
+}
+
+static const sched_task_t core0_tasks[] = {
+    [TASK_GESTURES] = {"gestures", run_gestures, 0, 0, 5, true},
+    [TASK_INPUT] = {"input", collect_input, INPUT_INTERVAL_US, 0, 4, false},
+    [TASK_LED] = {"led", update_led, STATUS_LED_INTERVAL_US, 0, 3, false},
+    [TASK_EXPORT] = {"export", drain_exports, TRACE_DRAIN_INTERVAL_US, 0, 2, false},
+    [TASK_DISPLAY] = {"display", refresh_display, DISPLAY_INTERVAL_US, 0, 1, true},
+    [TASK_CONFIG] = {"config", config_write_behind, 0, 0, 0, true},
+    [TASK_SPLASH] = {"splash", show_splash, 0, 0, 1, false},
+    [TASK_USB] = {"usb", start_usb, 0, 0, 0, true},
+};
+
 /**
  * @brief Main entry point for the application.
  *        Initializes hardware, launches core 1, and updates the display.
  */
 int main()
 {
-    stdio_init_all();
-    gpio_init(LED_PIN);
-    gpio_set_dir(LED_PIN, GPIO_OUT);
+    // Keep the 68000 in reset while clocks and config are set up
+    tmss_skip_init();
+    console_control_init();
+
+    // Restore the last saved region; on first boot the defaults are saved once the console runs
+    config_t config;
+    bool first_boot = !load_config(&config);
+    if (!first_boot)
+    {
+        system_status.region = config.region;
+        system_status.overclocked = config.overclocked;
+        system_status.oc_step = config.oc_step;
+    }
 
-    // Initialize the master clock output for the initial region
+    // Initialize the region jumpers and the master clock output for the initial region
+    region_switch_init(system_status.region);
     init_clock_output(system_status.region);
+    if (ENABLE_OVERCLOCKING && system_status.overclocked)
+        setup_vclk_pwm_div(overclock_vclk_div16());
+    // Sample the console lines from before the boot on, so a reset trigger sees it all
+    la_init();
 
-    // Initialize GPIOs for controller input
-    genesis_controller_gpio_init();
+    // Let the console boot as early as possible; the PIO reflex resets it again when TMSS maps the cart.
+    // Everything below runs alongside it, the OLED and USB as deferred tasks.
+    console_boot_release();
+    frame_sync_init();
 
-    // Launch core 1 for background tasks (e.g., joypad polling)
-    multicore_launch_core1(core1_entry);
+    if (first_boot)
+    {
+        config = config_from_status(&system_status);
+        save_config_later(&config);
+    }
 
-    // Initialize and show the SEGA logo on the OLED display
-    display_init();
-    display_show_sega_logo();
+    gpio_init(LED_PIN);
+    gpio_set_dir(LED_PIN, GPIO_OUT);
+    status_led_init();
+    status_led_show(system_status.region, system_status.overclocked);
+
+    // Initialize GPIOs for controller input (the sniffer sets up its own pins on core 1)
+    if (!ENABLE_PAD_SNIFFER)
+        genesis_controller_gpio_init();
 
-    // load_config(); // Uncomment if persistent config is implemented
+    // Launch core 1 for background tasks (e.g., joypad polling)
+    multicore_launch_core1(core1_entry);
 
-    sleep_ms(2500); // Allow time for peripherals to stabilize
+    gesture_init(hotkeys, sizeof(hotkeys) / sizeof(hotkeys[0]));
 
-    // Main loop: update display with current status
+    // Main loop: feed the hotkeys, update display with current status
+    sched_init(core0_tasks, sizeof(core0_tasks) / sizeof(core0_tasks[0]));
+    sched_release(TASK_CONFIG, config_write_due_us());
+    if (clock_usb_running())
+        sched_release(TASK_USB, time_us_64());
     while (true)
-    {
-        display_update_status(system_status.region, system_status.overclocked, system_status.pad);
-        sleep_ms(100); // Update display every 100ms
-    }
+        sched_dispatch();
 }
@@ -0,0 +1,103 @@
+#include "overclock.h"
+#include "setup.h"
+#include "structs.h"
+#include "config_store.h"
+#include "console_control.h"
+#include "frame_sync.h"
+
+/*
+ * Overclock ladder
+ * ----------------
+ * VCLK comes from a PWM slice whose divider has a 4-bit fraction, so the
+ * 68000 can run at MCLK * 16 / div16 rather than only at whole MCLK
+ * divisors. The ladder lists the dividers offered while overclocked,
+ * slowest first; the hotkeys move along it and the step is saved with the
+ * rest of the configuration. Each change waits for the vertical blank
+ * (frame_sync.c) and goes through the console executor, which holds !HALT
+ * around the divider switch.
+ */
+
+static const uint8_t oc_ladder[] = VCLK_OC_LADDER;
+#define OC_STEPS (sizeof(oc_ladder) / sizeof(oc_ladder[0]))
+
+/**
+ * @brief VCLK divider for the current overclock setting.
+ * @return Divider relative to MCLK in 1/16ths: the stock divider, or the selected ladder step.
+ */
+uint32_t overclock_vclk_div16(void)
+{
+    if (!ENABLE_OVERCLOCKING || !system_status.overclocked)
+        return VCLK_DIV_STOCK;
+    uint8_t step = system_status.oc_step < OC_STEPS ? system_status.oc_step : OC_STEPS - 1;
+    return oc_ladder[step];
+}
+
+/**
+ * @brief Switch VCLK to the current overclock setting.
+ *        Runs in vertical blank when frame sync has a signal.
+ */
+static void switch_vclk(void)
+{
+    console_set_vclk_div(overclock_vclk_div16());
+}
+
+/**
+ * @brief Switch VCLK to the overclock setting and queue it for saving.
+ */
+static void apply(void)
+{
+    frame_sync_defer(switch_vclk);
+    // Written behind: core 0 masks its IRQs while writing flash, which would stretch the !HALT window
+    config_t config = config_from_status(&system_status);
+    save_config_later(&config);
+}
+
+/**
+ * @brief Toggle the 68000 overclock (A+Start hotkey) and save the setting.
+ */
+void handle_overclock_toggle(void)
+{
+    if (!ENABLE_OVERCLOCKING)
+        return;
+
+    system_status.overclocked = !system_status.overclocked;
+    apply();
+}
+
+/**
+ * @brief Move to a ladder step, turning the overclock on.
+ * @param step Requested step, clamped to the ladder.
+ */
+static void select_step(int step)
+{
+    if (!ENABLE_OVERCLOCKING)
+        return;
+
+    if (step < 0)
+        step = 0;
+    if (step >= (int)OC_STEPS)
+        step = OC_STEPS - 1;
+    if (system_status.overclocked && system_status.oc_step == step)
+        return;
+
+    system_status.oc_step = (uint8_t)step;
+    system_status.overclocked = true;
+    apply();
+}
+
+/**
+ * @brief Overclock one ladder step faster (A+Start+Up hotkey) and save the setting.
+ */
+void handle_overclock_faster(void)
+{
+    // From stock, the first press brings back the saved step
+    select_step(system_status.overclocked ? system_status.oc_step + 1 : system_status.oc_step);
+}
+
+/**
+ * @brief Overclock one ladder step slower (A+Start+Down hotkey) and save the setting.
+ */
+void handle_overclock_slower(void)
+{
+    select_step(system_status.overclocked ? system_status.oc_step - 1 : system_status.oc_step);
+}
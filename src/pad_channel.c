@@ -0,0 +1,134 @@
+#include "pad_channel.h"
+#include "hardware/sync.h"
+
+/*
+ * Pad state channel between cores
+ * -------------------------------
+ * Core 1 decodes the pad and core 0 consumes it. The latest state is kept
+ * as (seq << 16 | mask) in one aligned 32-bit word, which the M0+ stores and
+ * loads atomically, so a reader can never see half an update. Every change
+ * is also pushed with its timestamp to a single-producer/single-consumer
+ * ring; the head is only written by the producer and the tail only by the
+ * consumer, with a barrier ordering the slot write before the head update.
+ */
+
+_Static_assert((PAD_CHANNEL_RING_SIZE & (PAD_CHANNEL_RING_SIZE - 1)) == 0, "ring size must be a power of 2");
+
+static volatile uint32_t latest_word;
+static pad_snapshot_t ring[PAD_CHANNEL_RING_SIZE];
+static volatile uint32_t ring_head; ///< Written by the producer only
+static volatile uint32_t ring_tail; ///< Written by the consumer only
+static volatile uint32_t dropped;
+static uint16_t publish_seq;
+static bool published = false;
+
+/**
+ * @brief Pack a joypad_state_t into a button mask.
+ * @param pad Joypad state to pack.
+ * @return Packed mask (PAD_BTN_* bits).
+ */
+pad_mask_t __not_in_flash_func(pad_mask_from_state)(const joypad_state_t *pad)
+{
+    return (pad->up    ? PAD_BTN_UP    : 0) |
+           (pad->down  ? PAD_BTN_DOWN  : 0) |
+           (pad->left  ? PAD_BTN_LEFT  : 0) |
+           (pad->right ? PAD_BTN_RIGHT : 0) |
+           (pad->a     ? PAD_BTN_A     : 0) |
+           (pad->b     ? PAD_BTN_B     : 0) |
+           (pad->c     ? PAD_BTN_C     : 0) |
+           (pad->start ? PAD_BTN_START : 0) |
+           (pad->x     ? PAD_BTN_X     : 0) |
+           (pad->y     ? PAD_BTN_Y     : 0) |
+           (pad->z     ? PAD_BTN_Z     : 0) |
+           (pad->mode  ? PAD_BTN_MODE  : 0);
+}
+
+/**
+ * @brief Unpack a button mask into a joypad_state_t.
+ * @param mask Packed mask (PAD_BTN_* bits).
+ * @return Joypad state.
+ */
+joypad_state_t __not_in_flash_func(pad_state_from_mask)(pad_mask_t mask)
+{
+    return (joypad_state_t){
+        .up    = (mask & PAD_BTN_UP) != 0,
+        .down  = (mask & PAD_BTN_DOWN) != 0,
+        .left  = (mask & PAD_BTN_LEFT) != 0,
+        .right = (mask & PAD_BTN_RIGHT) != 0,
+        .a     = (mask & PAD_BTN_A) != 0,
+        .b     = (mask & PAD_BTN_B) != 0,
+        .c     = (mask & PAD_BTN_C) != 0,
+        .x     = (mask & PAD_BTN_X) != 0,
+        .y     = (mask & PAD_BTN_Y) != 0,
+        .z     = (mask & PAD_BTN_Z) != 0,
+        .start = (mask & PAD_BTN_START) != 0,
+        .mode  = (mask & PAD_BTN_MODE) != 0,
+    };
+}
+
+/**
+ * @brief Publish a pad state (producer side, one core only).
+ *        Unchanged states are ignored; every change is pushed to the snapshot ring
+ *        and becomes the latest state in a single atomic word store.
+ * @param mask    Packed button state.
+ * @param time_us Time the state was observed.
+ */
+void __not_in_flash_func(pad_channel_publish)(pad_mask_t mask, uint64_t time_us)
+{
+    if (published && mask == (pad_mask_t)latest_word)
+        return;
+
+    publish_seq++;
+    published = true;
+
+    uint32_t head = ring_head;
+    if (head - ring_tail < PAD_CHANNEL_RING_SIZE) {
+        ring[head % PAD_CHANNEL_RING_SIZE] = (pad_snapshot_t){time_us, mask, publish_seq};
+        __dmb(); // slot contents before the head that exposes them
+        ring_head = head + 1;
+    } else {
+        dropped++;
+    }
+
+    latest_word = ((uint32_t)publish_seq << 16) | mask;
+}
+
+/**
+ * @brief Read the latest published state. Lock-free and never torn, from any core.
+ * @param seq Optional, receives the publish sequence number of the state.
+ * @return Packed button state.
+ */
+pad_mask_t pad_channel_latest(uint16_t *seq)
+{
+    uint32_t word = latest_word;
+    if (seq)
+        *seq = (uint16_t)(word >> 16);
+    return (pad_mask_t)word;
+}
+
+/**
+ * @brief Pop the oldest unread snapshot (consumer side, one core only).
+ * @param snap Receives the snapshot.
+ * @return true if a snapshot was available.
+ */
+bool pad_channel_pop(pad_snapshot_t *snap)
+{
+    uint32_t tail = ring_tail;
+    if (tail == ring_head)
+        return false;
+
+    __dmb(); // head read before the slot contents
+    *snap = ring[tail % PAD_CHANNEL_RING_SIZE];
+    __dmb(); // slot read before handing it back to the producer
+    ring_tail = tail + 1;
+    return true;
+}
+
+/**
+ * @brief Snapshots dropped because the consumer fell behind.
+ * @return Dropped snapshot count.
+ */
+uint32_t pad_channel_dropped(void)
+{
+    return dropped;
+}
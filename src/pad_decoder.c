@@ -0,0 +1,154 @@
+#include "pad_decoder.h"
+#include "pico/platform.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Table-driven Genesis/Mega Drive pad protocol decoder
+ * ----------------------------------------------------
+ * Consumes (SELECT, six data lines, time) samples as the console or our own
+ * poll produces them and keeps a packed button mask. Each sample costs two
+ * lookups: the transition table maps (cycle state, new cycle?, raw sample)
+ * to the next state and an action, and the spread table maps the action and
+ * the raw data lines to mask bits. Both are built by the preprocessor and
+ * live in RAM, so decoding carries on while core 0 writes flash.
+ *
+ * Read cycle states:
+ *   PLAIN    no 6-button ID seen in this cycle: SELECT=1 carries the d-pad, B, C
+ *   EXT_NEXT the last SELECT=0 phase was the ID (U, D, L, R all low): the next
+ *            SELECT=1 phase carries Z, Y, X, MODE
+ *   SIX      ID seen and the extra buttons read; SELECT=1 is the d-pad again
+ * SELECT=0 always carries A and START.
+ *
+ * A cycle ends when the samples stop for longer than the pad's own counter
+ * would wait (cycle_gap). A cycle that ended without an ID clears X, Y, Z and
+ * MODE: the game went back to 3-button reads, or a 3-button pad is plugged
+ * in. Cycles the game cuts short (no ID phase, or no extra-button phase after
+ * it) end the same way, so the decoder follows any select cadence and never
+ * carries a half-read cycle into the next frame.
+ */
+
+enum
+{
+    DEC_PLAIN,
+    DEC_EXT_NEXT,
+    DEC_SIX,
+    DEC_STATES
+};
+
+enum
+{
+    FIELD_DPAD_BC,   ///< SELECT=1: Up, Down, Left, Right, B, C
+    FIELD_A_START,   ///< SELECT=0: A, Start
+    FIELD_XYZM,      ///< SELECT=1 after the ID: Z, Y, X, MODE
+};
+
+#define ENTRY_STATE_MASK   0x03
+#define ENTRY_ACTION_SHIFT 2
+#define ACTION_CLEAR_EXT   (1 << 2)  ///< Action bit: drop X, Y, Z, MODE first
+
+#define PAD_BTN_EXT (PAD_BTN_X | PAD_BTN_Y | PAD_BTN_Z | PAD_BTN_MODE)
+
+// Table builders: F(a, b, n) for n = base .. base + 2^k - 1
+#define R2(F, a, b, n)   F(a, b, n), F(a, b, (n) + 1)
+#define R4(F, a, b, n)   R2(F, a, b, n), R2(F, a, b, (n) + 2)
+#define R8(F, a, b, n)   R4(F, a, b, n), R4(F, a, b, (n) + 4)
+#define R16(F, a, b, n)  R8(F, a, b, n), R8(F, a, b, (n) + 8)
+#define R32(F, a, b, n)  R16(F, a, b, n), R16(F, a, b, (n) + 16)
+#define R64(F, a, b, n)  R32(F, a, b, n), R32(F, a, b, (n) + 32)
+#define R128(F, a, b, n) R64(F, a, b, n), R64(F, a, b, (n) + 64)
+
+// Transition entry for state s, new cycle g, raw sample r
+#define T_SELECT(r)     (((r) >> 6) & 1)
+#define T_ID(r)         (!T_SELECT(r) && ((r) & 0x0F) == 0)
+#define T_FROM(s, g)    ((g) ? DEC_PLAIN : (s))
+#define T_AFTER(s, g)   (T_FROM(s, g) == DEC_EXT_NEXT ? DEC_SIX : T_FROM(s, g))
+#define T_NEXT(s, g, r) (T_ID(r) ? DEC_EXT_NEXT : T_AFTER(s, g))
+#define T_FIELD(s, g, r) \
+    (!T_SELECT(r) ? FIELD_A_START : T_FROM(s, g) == DEC_EXT_NEXT ? FIELD_XYZM : FIELD_DPAD_BC)
+#define T_CLEAR(s, g)   ((g) && (s) != DEC_SIX ? ACTION_CLEAR_EXT : 0)
+#define T_ENTRY(s, g, r) \
+    (uint8_t)(T_NEXT(s, g, r) | ((T_FIELD(s, g, r) | T_CLEAR(s, g)) << ENTRY_ACTION_SHIFT))
+
+// Mask bits for field f and raw data lines r (pressed = low)
+#define S_DATA(r)       (~(r) & PAD_SAMPLE_DATA_MASK)
+#define S_BIT(r, n, b)  ((S_DATA(r) & (1 << (n))) ? (b) : 0)
+#define S_ENTRY(f, unused, r)                                                                          \
+    (pad_mask_t)((f) == FIELD_DPAD_BC ? S_BIT(r, 0, PAD_BTN_UP) | S_BIT(r, 1, PAD_BTN_DOWN) |         \
+                                            S_BIT(r, 2, PAD_BTN_LEFT) | S_BIT(r, 3, PAD_BTN_RIGHT) |  \
+                                            S_BIT(r, 4, PAD_BTN_B) | S_BIT(r, 5, PAD_BTN_C)           \
+                 : (f) == FIELD_A_START ? S_BIT(r, 4, PAD_BTN_A) | S_BIT(r, 5, PAD_BTN_START)         \
+                                        : S_BIT(r, 0, PAD_BTN_Z) | S_BIT(r, 1, PAD_BTN_Y) |           \
+                                              S_BIT(r, 2, PAD_BTN_X) | S_BIT(r, 3, PAD_BTN_MODE))
+
+#define T_ROWS(s) {{R128(T_ENTRY, s, 0, 0)}, {R128(T_ENTRY, s, 1, 0)}}
+
+static const uint8_t __not_in_flash("pad_decoder") transitions[DEC_STATES][2][128] = {
+    T_ROWS(DEC_PLAIN),
+    T_ROWS(DEC_EXT_NEXT),
+    T_ROWS(DEC_SIX),
+};
+
+static const pad_mask_t __not_in_flash("pad_decoder") spread[3][64] = {
+    {R64(S_ENTRY, FIELD_DPAD_BC, 0, 0)},
+    {R64(S_ENTRY, FIELD_A_START, 0, 0)},
+    {R64(S_ENTRY, FIELD_XYZM, 0, 0)},
+};
+
+#define K_FIELD_DPAD_BC (PAD_BTN_UP | PAD_BTN_DOWN | PAD_BTN_LEFT | PAD_BTN_RIGHT | PAD_BTN_B | PAD_BTN_C)
+#define K_FIELD_A_START (PAD_BTN_A | PAD_BTN_START)
+#define K_FIELD_XYZM    PAD_BTN_EXT
+
+// Bits an action keeps: everything but its field, and X/Y/Z/MODE when clearing
+static const pad_mask_t __not_in_flash("pad_decoder") keep[8] = {
+    (pad_mask_t)~K_FIELD_DPAD_BC,
+    (pad_mask_t)~K_FIELD_A_START,
+    (pad_mask_t)~K_FIELD_XYZM,
+    (pad_mask_t)~0u,
+    (pad_mask_t)~(K_FIELD_DPAD_BC | PAD_BTN_EXT),
+    (pad_mask_t)~(K_FIELD_A_START | PAD_BTN_EXT),
+    (pad_mask_t)~(K_FIELD_XYZM | PAD_BTN_EXT),
+    (pad_mask_t)~0u,
+};
+
+/**
+ * @brief Reset a decoder: no buttons, waiting for a read cycle.
+ * @param dec       Decoder to reset.
+ * @param cycle_gap Time without samples after which the next sample starts a
+ *                  new read cycle, in the unit of the timestamps passed to
+ *                  pad_decoder_feed().
+ */
+void pad_decoder_init(pad_decoder_t *dec, uint32_t cycle_gap)
+{
+    *dec = (pad_decoder_t){.mask = 0, .state = DEC_PLAIN, .resync = true, .last_time = 0, .cycle_gap = cycle_gap};
+}
+
+/**
+ * @brief Decode one sample. O(1): two table lookups, no branches on the data.
+ *        3-button and 6-button reads, and cycles cut short, are all handled.
+ * @param dec    Decoder state.
+ * @param sample Pad lines and SELECT (PAD_SAMPLE_* bits, higher bits ignored).
+ * @param time   Sample time, any unit that wraps at 2^32.
+ * @return Button mask after the sample.
+ */
+pad_mask_t __not_in_flash_func(pad_decoder_feed)(pad_decoder_t *dec, uint32_t sample, uint32_t time)
+{
+    uint32_t new_cycle = dec->resync | (time - dec->last_time > dec->cycle_gap);
+    uint8_t entry = transitions[dec->state][new_cycle][sample & (PAD_SAMPLE_SELECT_BIT | PAD_SAMPLE_DATA_MASK)];
+    uint32_t action = entry >> ENTRY_ACTION_SHIFT;
+
+    dec->mask = (dec->mask & keep[action]) | spread[action & 3][sample & PAD_SAMPLE_DATA_MASK];
+    dec->state = entry & ENTRY_STATE_MASK;
+    dec->resync = false;
+    dec->last_time = time;
+    return dec->mask;
+}
+
+/**
+ * @brief Treat the next sample as the start of a read cycle, e.g. after samples were lost.
+ * @param dec Decoder state.
+ */
+void __not_in_flash_func(pad_decoder_resync)(pad_decoder_t *dec)
+{
+    dec->resync = true;
+}
@@ -0,0 +1,181 @@
+#include "pad_sniffer.h"
+#include "setup.h"
+#include "trace.h"
+#include "pad_channel.h"
+#include "rt_timer.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "pad_sniffer.pio.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Passive Genesis/Mega Drive controller sniffer
+ * ---------------------------------------------
+ * A PIO state machine latches the pad lines on every SELECT edge generated by
+ * the console and a DMA channel streams the samples into a RAM ring. Nothing
+ * here blocks or drives a line: the consumer just decodes whatever arrived
+ * since its last poll, following the game's own select cadence.
+ *
+ * Each sample carries the PIO's idle tick count, which the consumer widens
+ * to a 32-bit time so pad_decoder.c can tell where each of the game's read
+ * cycles starts. Ticks stop during the settle delay, so the time runs a
+ * little slow; it only has to tell a pause between reads from one between
+ * frames.
+ *
+ * The poll, decode and IRQ paths are RAM-resident so decoding carries on
+ * while core 0 writes flash (see flash_window.c).
+ */
+
+#if (GPIO_PIN_DOWN != GPIO_PIN_UP + 1) || (GPIO_PIN_LEFT != GPIO_PIN_UP + 2) || \
+    (GPIO_PIN_RIGHT != GPIO_PIN_UP + 3) || (GPIO_PIN_B != GPIO_PIN_UP + 4) ||   \
+    (GPIO_PIN_C != GPIO_PIN_UP + 5) || (GPIO_PIN_SELECT != GPIO_PIN_UP + 6)
+#error "pad sniffer needs UP, DOWN, LEFT, RIGHT, B, C, SELECT on consecutive GPIOs"
+#endif
+
+#define SNIFFER_PIO             pio0
+#define SNIFFER_RING_BITS       10                              ///< log2 of ring size in bytes
+#define SNIFFER_RING_WORDS      ((1u << SNIFFER_RING_BITS) / sizeof(uint32_t))
+#define SNIFFER_TRANS_COUNT     0xFFFFFFFFu                     ///< Re-armed from the DMA IRQ when exhausted
+#define SNIFFER_CYCLE_GAP_TICKS (PAD_CYCLE_GAP_US * 16000u / PAD_SNIFFER_SETTLE_NS)
+#define SNIFFER_IDLE_RESYNC_US  500000                          ///< Well inside the tick counter's ~1 s wrap
+
+_Static_assert(SNIFFER_CYCLE_GAP_TICKS < PAD_SAMPLE_TICK_MASK / 2, "PAD_CYCLE_GAP_US too long for the sniffer's tick counter");
+
+static uint32_t ring[SNIFFER_RING_WORDS] __attribute__((aligned(1u << SNIFFER_RING_BITS)));
+
+static uint sniffer_sm;
+static int dma_chan = -1;
+
+// Total samples produced = run_base - remaining transfer count
+static volatile uint32_t run_base = SNIFFER_TRANS_COUNT;
+static uint32_t consumed;
+static uint32_t overruns;
+
+static pad_decoder_t decoder;
+static uint32_t last_ticks;   ///< Tick field of the previous sample
+static uint32_t time_ticks;   ///< Widened sample time
+static uint64_t last_sample_us;
+
+/**
+ * @brief Re-arm the capture channel once its transfer count runs out.
+ *        The write address keeps wrapping inside the ring, so only the count is reloaded.
+ */
+static void __not_in_flash_func(sniffer_dma_irq_handler)(void)
+{
+    if (!dma_channel_get_irq0_status(dma_chan))
+        return;
+
+    trace_begin(TRACE_ISR, DMA_IRQ_0);
+    dma_channel_acknowledge_irq0(dma_chan);
+    run_base += SNIFFER_TRANS_COUNT;
+    dma_channel_set_trans_count(dma_chan, SNIFFER_TRANS_COUNT, true);
+    trace_end(TRACE_ISR, DMA_IRQ_0);
+}
+
+/**
+ * @brief Number of samples written to the ring since init (wraps at 2^32).
+ */
+static uint32_t __not_in_flash_func(samples_produced)(void)
+{
+    uint32_t base, remaining;
+    do {
+        base = run_base;
+        remaining = dma_channel_hw_addr(dma_chan)->transfer_count;
+    } while (base != run_base);
+    return base - remaining;
+}
+
+/**
+ * @brief Decode one raw sample, widening its tick count to the decoder's time.
+ * @param sample Raw sample as pushed by the PIO program.
+ */
+static void __not_in_flash_func(decode_sample)(uint32_t sample)
+{
+    uint32_t ticks = (sample >> PAD_SAMPLE_TICK_SHIFT) & PAD_SAMPLE_TICK_MASK;
+    time_ticks += (last_ticks - ticks) & PAD_SAMPLE_TICK_MASK;
+    last_ticks = ticks;
+    pad_decoder_feed(&decoder, sample, time_ticks);
+}
+
+/**
+ * @brief Start the passive controller sniffer.
+ *        Claims a PIO state machine and a DMA channel that stream one sample per
+ *        SELECT edge into a RAM ring. The SELECT line is left as an input and is
+ *        never driven. Must be called on the core that will poll the sniffer.
+ */
+void pad_sniffer_init(void)
+{
+    // Inputs without pulls: the console and the pad own these lines
+    for (uint pin = GPIO_PIN_UP; pin <= GPIO_PIN_SELECT; ++pin) {
+        gpio_init(pin);
+        gpio_set_dir(pin, GPIO_IN);
+        gpio_disable_pulls(pin);
+    }
+
+    pad_decoder_init(&decoder, SNIFFER_CYCLE_GAP_TICKS);
+
+    sniffer_sm = pio_claim_unused_sm(SNIFFER_PIO, true);
+    uint offset = pio_add_program(SNIFFER_PIO, &pad_sniffer_program);
+
+    dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, SNIFFER_RING_BITS);
+    channel_config_set_dreq(&c, pio_get_dreq(SNIFFER_PIO, sniffer_sm, false));
+    dma_channel_configure(dma_chan, &c, ring, &SNIFFER_PIO->rxf[sniffer_sm], SNIFFER_TRANS_COUNT, true);
+
+    dma_channel_set_irq0_enabled(dma_chan, true);
+    irq_add_shared_handler(DMA_IRQ_0, sniffer_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    pad_sniffer_program_init(SNIFFER_PIO, sniffer_sm, offset, GPIO_PIN_UP, PAD_SNIFFER_SETTLE_NS);
+}
+
+/**
+ * @brief Decode every sample captured since the last call.
+ *        Never blocks; 3-button and 6-button reads are both handled.
+ * @param pad Pointer to joypad_state_t struct to update with button states.
+ * @return true if at least one new sample was decoded.
+ */
+bool __not_in_flash_func(pad_sniffer_poll)(joypad_state_t *pad)
+{
+    uint32_t produced = samples_produced();
+    uint32_t pending = produced - consumed;
+    uint64_t now_us = rt_time_us_64();
+
+    if (pending == 0) {
+        // Quiet long enough for the tick counter to wrap: don't trust the next gap
+        if (now_us - last_sample_us > SNIFFER_IDLE_RESYNC_US)
+            pad_decoder_resync(&decoder);
+        return false;
+    }
+    last_sample_us = now_us;
+
+    // Lapped by the DMA: drop the oldest samples and resync on the next ID phase
+    if (pending > SNIFFER_RING_WORDS) {
+        overruns += pending - SNIFFER_RING_WORDS;
+        consumed = produced - SNIFFER_RING_WORDS;
+        pad_decoder_resync(&decoder);
+    }
+
+    while (consumed != produced) {
+        decode_sample(ring[consumed % SNIFFER_RING_WORDS]);
+        consumed++;
+    }
+    *pad = pad_state_from_mask(decoder.mask);
+    return true;
+}
+
+/**
+ * @brief Number of samples lost because the ring was not drained in time.
+ * @return Overrun sample count since init.
+ */
+uint32_t pad_sniffer_overruns(void)
+{
+    return overruns;
+}
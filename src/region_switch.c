@@ -0,0 +1,75 @@
+#include "region_switch.h"
+#include "clock_control.h"
+#include "config_store.h"
+#include "console_control.h"
+#include "frame_sync.h"
+#include "overclock.h"
+#include "setup.h"
+#include "structs.h"
+#include "trace.h"
+#include "hardware/gpio.h"
+
+/**
+ * @brief Drive the video standard and region jumpers.
+ *        Brazil (PAL-M) runs at 60 Hz like NTSC and is an export console.
+ * @param region Region to apply.
+ */
+static void set_region_jumpers(region_t region)
+{
+    gpio_put(GPIO_STANDARD_PIN, region != REGION_EUR);
+    gpio_put(GPIO_REGION_PIN, region != REGION_JPN);
+}
+
+/**
+ * @brief Set up the region jumper outputs for the given region.
+ *        Call at boot while the 68000 is still held in reset.
+ * @param region Region to apply.
+ */
+void region_switch_init(region_t region)
+{
+    gpio_init(GPIO_STANDARD_PIN);
+    gpio_init(GPIO_REGION_PIN);
+    set_region_jumpers(region);
+    gpio_set_dir(GPIO_STANDARD_PIN, GPIO_OUT);
+    gpio_set_dir(GPIO_REGION_PIN, GPIO_OUT);
+}
+
+static region_t pending_region;  ///< Region the deferred switch puts in place
+static bool switch_pending = false;
+
+/**
+ * @brief Make the pending region current: jumpers, clocks, then a console reset.
+ *        Runs in vertical blank when frame sync has a signal; system_status follows
+ *        here, so the LED and OLED do not show the new region before it is in place.
+ */
+static void apply_region(void)
+{
+    system_status.region = pending_region;
+    switch_pending = false;
+    set_region_jumpers(system_status.region);
+    set_clock_region(system_status.region);
+    // set_clock_region() goes back to the stock divider
+    if (system_status.overclocked)
+        setup_vclk_pwm_div(overclock_vclk_div16());
+    console_reset();
+}
+
+/**
+ * @brief Switch to the next region (JPN > USA > EUR > BRA > JPN), save it and reset the console.
+ */
+void handle_region_switch(void)
+{
+    // A switch still waiting for vertical blank counts as done
+    region_t current = switch_pending ? pending_region : system_status.region;
+    region_t region = current == REGION_BRA ? REGION_JPN : (region_t)(current + 1);
+    trace_mark(TRACE_REGION_SWITCH, region);
+
+    pending_region = region;
+    switch_pending = true;
+    frame_sync_defer(apply_region);
+
+    // Written behind, after the reset pulse is over
+    config_t config = config_from_status(&system_status);
+    config.region = region;
+    save_config_later(&config);
+}
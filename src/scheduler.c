@@ -0,0 +1,186 @@
+#include "scheduler.h"
+#include "trace.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+/*
+ * Deadline scheduler
+ * ------------------
+ * Each core used to pace itself with its own sleep: core 1 slept a fixed
+ * interval after every pad pass, so each pass stretched the period, and
+ * core 0 worked out its next wake-up by hand from the display and hotkey
+ * timers. Here each core runs a table of tasks, released at absolute
+ * times. A periodic task's next release is its previous release plus the
+ * period, not "now plus the period", so a slow run shifts one start and
+ * never the whole schedule; releases that pass by entirely while the core
+ * is busy are skipped and counted as misses. One-shot tasks are armed with
+ * sched_release() (gesture deadlines, the config write-behind). Among
+ * released tasks the highest priority runs first, one run per dispatch, so
+ * an urgent task waits for at most one other run. With nothing released
+ * the core sleeps in WFE until the next release; an interrupt or an event
+ * from the other core only costs a look at the table.
+ */
+
+typedef struct
+{
+    const sched_task_t *tasks;
+    uint8_t count;
+    sched_stats_t stats[SCHED_MAX_TASKS];
+} sched_core_t;
+
+static sched_core_t schedulers[NUM_CORES];
+
+static inline sched_core_t *this_core(void)
+{
+    return &schedulers[get_core_num()];
+}
+
+/**
+ * @brief Install the calling core's task table.
+ *        Tasks are released straight away, except those marked start_idle.
+ * @param table Tasks (must stay valid while in use).
+ * @param count Number of entries, at most SCHED_MAX_TASKS.
+ */
+void sched_init(const sched_task_t *table, uint8_t count)
+{
+    hard_assert(count <= SCHED_MAX_TASKS);
+    sched_core_t *c = this_core();
+    uint64_t now = time_us_64();
+
+    c->tasks = table;
+    c->count = count;
+    for (uint8_t i = 0; i < SCHED_MAX_TASKS; ++i) {
+        c->stats[i] = (sched_stats_t){0};
+        c->stats[i].release_us = i < count && !table[i].start_idle ? now : SCHED_IDLE;
+    }
+}
+
+/**
+ * @brief Set the next release of one of the calling core's tasks.
+ *        Called from a periodic task's own run(), replaces the next periodic release.
+ * @param task    Index in the table.
+ * @param time_us Absolute release time, or SCHED_IDLE to disarm the task.
+ */
+void sched_release(uint8_t task, uint64_t time_us)
+{
+    sched_core_t *c = this_core();
+    hard_assert(task < c->count);
+    c->stats[task].release_us = time_us;
+}
+
+/**
+ * @brief Release a task no later than a given time; an earlier release stands.
+ * @param task    Index in the table.
+ * @param time_us Absolute release time.
+ */
+void sched_release_by(uint8_t task, uint64_t time_us)
+{
+    sched_core_t *c = this_core();
+    hard_assert(task < c->count);
+    if (time_us < c->stats[task].release_us)
+        c->stats[task].release_us = time_us;
+}
+
+/**
+ * @brief Run one released task and account for it.
+ */
+static void run_task(sched_core_t *c, uint8_t i, uint64_t now)
+{
+    const sched_task_t *t = &c->tasks[i];
+    sched_stats_t *st = &c->stats[i];
+    uint64_t release = st->release_us;
+    uint64_t late = now - release;
+    uint32_t relative = t->deadline_us ? t->deadline_us : t->period_us;
+    uint64_t deadline = relative ? release + relative : SCHED_IDLE;
+
+    // Work out the next release first, so run() may move it
+    if (t->period_us) {
+        uint64_t skipped = late / t->period_us;
+        st->misses += (uint32_t)skipped;
+        st->release_us = release + (skipped + 1) * t->period_us;
+    } else {
+        st->release_us = SCHED_IDLE;
+    }
+
+    t->run();
+
+    uint64_t end = time_us_64();
+    st->runs++;
+    if (end > deadline)
+        st->misses++;
+    if (late > st->max_late_us)
+        st->max_late_us = late > UINT32_MAX ? UINT32_MAX : (uint32_t)late;
+    st->total_late_us += late;
+    if (end - now > st->max_run_us)
+        st->max_run_us = (uint32_t)(end - now);
+}
+
+/**
+ * @brief Run the released task with the highest priority, or sleep in WFE
+ *        until the next release. Never returns early for good: call in a loop.
+ */
+void sched_dispatch(void)
+{
+    sched_core_t *c = this_core();
+    uint64_t now = time_us_64();
+    uint64_t next = SCHED_IDLE;
+    int best = -1;
+
+    for (uint8_t i = 0; i < c->count; ++i) {
+        uint64_t release = c->stats[i].release_us;
+        if (release > now) {
+            if (release < next)
+                next = release;
+        } else if (best < 0 || c->tasks[i].priority > c->tasks[best].priority ||
+                   (c->tasks[i].priority == c->tasks[best].priority && release < c->stats[best].release_us)) {
+            best = i;
+        }
+    }
+
+    if (best >= 0) {
+        run_task(c, (uint8_t)best, now);
+        return;
+    }
+
+    // Any interrupt or event wakes us early; the next dispatch just looks again
+    trace_begin(TRACE_IDLE, 0);
+    if (next == SCHED_IDLE)
+        __wfe();
+    else
+        best_effort_wfe_or_timeout(from_us_since_boot(next));
+    trace_end(TRACE_IDLE, 0);
+}
+
+/**
+ * @brief Number of tasks installed on a core.
+ * @param core Core number.
+ * @return Table size, 0 before sched_init() ran on that core.
+ */
+uint8_t sched_task_count(unsigned core)
+{
+    return core < NUM_CORES ? schedulers[core].count : 0;
+}
+
+/**
+ * @brief A core's table entry.
+ * @param core Core number.
+ * @param task Index in the table.
+ * @return Pointer to the entry.
+ */
+const sched_task_t *sched_task(unsigned core, uint8_t task)
+{
+    hard_assert(task < sched_task_count(core));
+    return &schedulers[core].tasks[task];
+}
+
+/**
+ * @brief Statistics of a task.
+ * @param core Core number.
+ * @param task Index in the table.
+ * @return Pointer to the statistics.
+ */
+const sched_stats_t *sched_stats(unsigned core, uint8_t task)
+{
+    hard_assert(task < sched_task_count(core));
+    return &schedulers[core].stats[task];
+}
@@ -0,0 +1,163 @@
+#include "status_led.h"
+#include "setup.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+
+/*
+ * Status LED
+ * ----------
+ * A bi-color LED on the two channels of one PWM slice shows the region
+ * (JPN LED1, USA LED2, EUR both, BRA the two alternating) and pulses at 3 Hz
+ * while the 68000 is overclocked. Patterns are integer tables of compare
+ * values, one 32-bit word (LED2 << 16 | LED1) per PWM period, built once when
+ * the status changes. A DMA channel paced by the slice's wrap DREQ writes one
+ * word per period into the compare register; at the end of the table it
+ * chains to a control channel that writes the current table address back
+ * into the data channel's read-address trigger. Playback needs no CPU time,
+ * no timer and no interrupt.
+ */
+
+#if (GPIO_LED1_PIN % 2) || (GPIO_LED2_PIN != GPIO_LED1_PIN + 1)
+#error "status LED needs LED1 on an even GPIO and LED2 on the next one (one PWM slice)"
+#endif
+
+#define LED_PATTERN_LEN     256                  ///< Steps per pattern loop (1.33 s)
+#define LED_STEP_HZ         192                  ///< PWM frequency, and pattern steps per second
+#define LED_PWM_TOP         0xFFFFu              ///< Full brightness
+#define LED_PULSE_STEPS     64                   ///< Overclock pulse period (3 Hz)
+#define LED_PULSE_FLOOR     (LED_PWM_TOP / 16)   ///< Dimmest point of the overclock pulse
+#define LED_BLINK_STEPS     (LED_PATTERN_LEN / 2) ///< BRA: each color shown for half a loop
+
+_Static_assert(LED_PATTERN_LEN % LED_PULSE_STEPS == 0, "the pulse must loop with the pattern");
+
+typedef struct
+{
+    uint16_t led1;
+    uint16_t led2;
+} led_color_t;
+
+static uint32_t tables[2][LED_PATTERN_LEN];       ///< Playing and next pattern
+static const uint32_t *volatile led_table;         ///< Read by the control channel at each loop
+static uint next_table;
+static int data_chan = -1;
+static int ctrl_chan = -1;
+
+static bool shown = false;
+static region_t shown_region;
+static bool shown_overclocked;
+
+/**
+ * @brief Region color at a pattern step.
+ */
+static led_color_t region_color(region_t region, uint32_t step)
+{
+    switch (region) {
+    case REGION_JPN:
+        return (led_color_t){LED_PWM_TOP, 0};
+    case REGION_USA:
+        return (led_color_t){0, LED_PWM_TOP};
+    case REGION_EUR:
+        return (led_color_t){LED_PWM_TOP, LED_PWM_TOP};
+    default:
+        return ((step / LED_BLINK_STEPS) & 1) ? (led_color_t){0, LED_PWM_TOP} : (led_color_t){LED_PWM_TOP, 0};
+    }
+}
+
+/**
+ * @brief Brightness at a pattern step, 0..LED_PWM_TOP.
+ *        Overclocked: a triangle per pulse, squared so the fade looks even to the eye.
+ */
+static uint32_t brightness(bool overclocked, uint32_t step)
+{
+    if (!overclocked)
+        return LED_PWM_TOP;
+
+    uint32_t half = LED_PULSE_STEPS / 2;
+    uint32_t phase = step % LED_PULSE_STEPS;
+    uint32_t ramp = phase < half ? phase : LED_PULSE_STEPS - 1 - phase;    // 0..half-1
+    uint64_t lin = (uint64_t)ramp * LED_PWM_TOP / (half - 1);
+    uint64_t sq = lin * lin / LED_PWM_TOP;
+    return LED_PULSE_FLOOR + (uint32_t)(sq * (LED_PWM_TOP - LED_PULSE_FLOOR) / LED_PWM_TOP);
+}
+
+/**
+ * @brief Set up the LED PWM slice and the DMA channels that stream patterns into it.
+ *        Call once clk_sys is final (after init_clock_output()). LEDs stay off until
+ *        the first status_led_show().
+ */
+void status_led_init(void)
+{
+    if (!ENABLE_STATUS_LED)
+        return;
+
+    uint slice = pwm_gpio_to_slice_num(GPIO_LED1_PIN);
+    gpio_set_function(GPIO_LED1_PIN, GPIO_FUNC_PWM);
+    gpio_set_function(GPIO_LED2_PIN, GPIO_FUNC_PWM);
+
+    // One period per pattern step: clk_sys / (div * (TOP + 1)) = LED_STEP_HZ, div in 1/16ths
+    uint32_t div16 = (uint32_t)(16ull * clock_get_hz(clk_sys) / ((LED_PWM_TOP + 1ull) * LED_STEP_HZ));
+    pwm_set_clkdiv_int_frac(slice, div16 >> 4, div16 & 0xF);
+    pwm_set_wrap(slice, LED_PWM_TOP);
+    pwm_set_both_levels(slice, 0, 0);
+    pwm_set_enabled(slice, true);
+
+    data_chan = dma_claim_unused_channel(true);
+    ctrl_chan = dma_claim_unused_channel(true);
+
+    // Data: one compare word per PWM wrap, then hand over to the control channel
+    dma_channel_config c = dma_channel_get_default_config(data_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pwm_get_dreq(slice));
+    channel_config_set_chain_to(&c, ctrl_chan);
+    channel_config_set_irq_quiet(&c, true);
+    dma_channel_configure(data_chan, &c, &pwm_hw->slice[slice].cc, NULL, LED_PATTERN_LEN, false);
+
+    // Control: restart the data channel on the current table (its count reloads on trigger)
+    c = dma_channel_get_default_config(ctrl_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_irq_quiet(&c, true);
+    dma_channel_configure(ctrl_chan, &c, &dma_hw->ch[data_chan].al3_read_addr_trig, &led_table, 1, false);
+}
+
+/**
+ * @brief Show a status: the region's color, pulsing while overclocked.
+ *        Builds the pattern only when the status changed; playback costs no CPU time.
+ * @param region      Current region.
+ * @param overclocked Overclock state.
+ */
+void status_led_show(region_t region, bool overclocked)
+{
+    if (!ENABLE_STATUS_LED || data_chan < 0)
+        return;
+    if (shown && region == shown_region && overclocked == shown_overclocked)
+        return;
+
+    // Fill the table that is not playing
+    uint32_t *table = tables[next_table];
+    next_table ^= 1;
+    for (uint32_t step = 0; step < LED_PATTERN_LEN; ++step) {
+        led_color_t color = region_color(region, step);
+        uint32_t level = brightness(overclocked, step);
+        uint32_t led1 = color.led1 * level / LED_PWM_TOP;
+        uint32_t led2 = color.led2 * level / LED_PWM_TOP;
+        table[step] = (led2 << 16) | led1;
+    }
+
+    led_table = table;
+    if (!shown) {
+        dma_channel_start(ctrl_chan);
+    } else {
+        // Switch now rather than at the end of the loop; the control channel restarts on the new table
+        dma_channel_set_read_addr(data_chan, table, false);
+    }
+
+    shown = true;
+    shown_region = region;
+    shown_overclocked = overclocked;
+}
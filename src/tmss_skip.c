@@ -0,0 +1,105 @@
+#include "tmss_skip.h"
+#include "setup.h"
+#include "trace.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/pio.h"
+#include "tmss_skip.pio.h"
+
+/*
+ * TMSS skip
+ * ---------
+ * The original firmware spun on gpio_get(!CART_CE) and then reset the
+ * console from C, which only worked when the loop happened to be fast
+ * enough (XIP cache, interrupts, clk_sys all played a part). Here a PIO
+ * state machine owns !VRES and asserts it a handful of SM cycles after the
+ * !CART_CE fall, then measures how long the restarted 68000 takes to touch
+ * the cart: a few bus cycles when the skip landed, much longer when the
+ * TMSS ROM ran instead.
+ */
+
+#define TMSS_PIO  pio0
+
+static int tmss_sm = -1;
+static uint tmss_offset;
+static bool outcome_known = false;
+static tmss_stats_t stats;
+
+/**
+ * @brief Hold the 68000 in reset and load the TMSS skip reflex.
+ *        Call first thing at boot, before the master clock starts.
+ */
+void tmss_skip_init(void)
+{
+    if (!ENABLE_TMSS_SKIP)
+        return;
+
+    // !CART_CE is driven by the console; keep a pull-up for consoles without TMSS wiring
+    gpio_init(GPIO_CART_CE_PIN);
+    gpio_set_dir(GPIO_CART_CE_PIN, GPIO_IN);
+    gpio_pull_up(GPIO_CART_CE_PIN);
+    gpio_init(GPIO_VRES_PIN);
+
+    tmss_sm = pio_claim_unused_sm(TMSS_PIO, true);
+    tmss_offset = pio_add_program(TMSS_PIO, &tmss_skip_program);
+    tmss_skip_program_init(TMSS_PIO, tmss_sm, tmss_offset, GPIO_CART_CE_PIN, GPIO_VRES_PIN);
+}
+
+/**
+ * @brief Release the console from reset with the reflex armed.
+ *        Call once MCLK/VCLK run at their final rates: the reset pulse
+ *        length is computed from the current clk_sys.
+ */
+void tmss_skip_arm(void)
+{
+    if (tmss_sm < 0)
+        return;
+
+    uint32_t pulse_cycles = (uint32_t)((uint64_t)clock_get_hz(clk_sys) * TMSS_VRES_PULSE_US / 1000000);
+    pio_sm_put(TMSS_PIO, tmss_sm, pulse_cycles);
+    stats.armed++;
+}
+
+/**
+ * @brief Collect the outcome of this boot's skip, if it is known yet.
+ *        Never blocks. Frees the state machine and hands !VRES back to
+ *        SIO (released) once the result is in.
+ * @return true once the outcome has been recorded (straight away when the skip is disabled).
+ */
+bool tmss_skip_poll(void)
+{
+    if (!ENABLE_TMSS_SKIP || outcome_known)
+        return true;
+    if (tmss_sm < 0 || pio_sm_is_rx_fifo_empty(TMSS_PIO, tmss_sm))
+        return false;
+
+    // Two SM cycles per idle loop, clkdiv 1
+    uint32_t loops = ~pio_sm_get(TMSS_PIO, tmss_sm);
+    uint64_t latency_ns = (uint64_t)loops * 2 * 1000000000ull / clock_get_hz(clk_sys);
+    stats.last_latency_ns = latency_ns > UINT32_MAX ? UINT32_MAX : (uint32_t)latency_ns;
+    bool landed = latency_ns <= TMSS_LANDED_MAX_US * 1000ull;
+    if (landed)
+        stats.landed++;
+    else
+        stats.missed++;
+    trace_mark(TRACE_TMSS_SKIP, stats.last_latency_ns);
+
+    // The reflex is one-shot: give the pins and the PIO space back
+    pio_sm_set_enabled(TMSS_PIO, tmss_sm, false);
+    pio_remove_program(TMSS_PIO, &tmss_skip_program, tmss_offset);
+    pio_sm_unclaim(TMSS_PIO, tmss_sm);
+    gpio_init(GPIO_VRES_PIN);
+    gpio_deinit(GPIO_CART_CE_PIN);
+    tmss_sm = -1;
+    outcome_known = true;
+    return true;
+}
+
+/**
+ * @brief Skip counters since power-on.
+ * @return Pointer to the statistics.
+ */
+const tmss_stats_t *tmss_skip_stats(void)
+{
+    return &stats;
+}
@@ -0,0 +1,134 @@
+#include "trace.h"
+#include "rt_timer.h"
+#include "clock_plan.h"
+#include "enums.h"
+#include "pico/stdlib.h"
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#endif
+#include "hardware/sync.h"
+#include <stdio.h>
+
+/*
+ * Trace rings
+ * -----------
+ * Hot paths record fixed-size events stamped with the 64-bit timer into a
+ * ring per core: the recording core (task or IRQ) is the only producer, so
+ * a short IRQ mask is all the locking needed, and core 0 is the only
+ * consumer. A full ring drops new events rather than blocking; the per-core
+ * sequence number shows the gap. Events leave as one "@<32 hex digits>" line
+ * each, so they share the USB CDC stdio stream with ordinary printf output.
+ * tools/trace_decode.py turns them into latency histograms and busy figures.
+ * Recording runs from SRAM, so it also works while flash is being written.
+ */
+
+// USB stdio is linked in (CMakeLists.txt) only when the clock mode keeps clk_usb at 48 MHz
+_Static_assert(CLOCK_PLAN_USB_CLOCK == (MCLK_CLOCK_MODE != CLOCK_MODE_PRELOCKED), "clock plan generated for another MCLK_CLOCK_MODE");
+_Static_assert(CLOCK_PLAN_USB_CLOCK || !ENABLE_TRACE, "ENABLE_TRACE exports over USB CDC: use CLOCK_MODE_DECOUPLED or CLOCK_MODE_RELOCK");
+
+#define TRACE_CORES        2
+#define TRACE_DRAIN_BATCH  128 ///< Events sent per core and call
+
+static trace_event_t rings[TRACE_CORES][TRACE_RING_LEN];
+static volatile uint32_t ring_head[TRACE_CORES], ring_tail[TRACE_CORES]; ///< Free-running indices
+static uint16_t ring_seq[TRACE_CORES];
+static trace_stats_t stats;
+
+/**
+ * @brief Append an event to the calling core's ring. Never blocks, safe from IRQs.
+ * @param id  Event id (| TRACE_END to close a span).
+ * @param arg Event specific value.
+ */
+void __not_in_flash_func(trace_record)(uint8_t id, uint32_t arg)
+{
+    uint core = get_core_num();
+    uint32_t irq = save_and_disable_interrupts();
+
+    uint32_t head = ring_head[core];
+    uint16_t seq = ring_seq[core]++;
+    if (head - ring_tail[core] == TRACE_RING_LEN) {
+        stats.dropped[core]++;
+    } else {
+        rings[core][head % TRACE_RING_LEN] = (trace_event_t){rt_time_us_64(), arg, id, (uint8_t)core, seq};
+        // The event must be visible to core 0 before the index that publishes it
+        __dmb();
+        ring_head[core] = head + 1;
+        stats.recorded[core]++;
+    }
+
+    restore_interrupts(irq);
+}
+
+/**
+ * @brief Send one event as a line of hex.
+ */
+static void send_event(const trace_event_t *ev)
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[1 + 2 * sizeof(trace_event_t) + 1];
+    const uint8_t *bytes = (const uint8_t *)ev;
+
+    line[0] = '@';
+    for (size_t i = 0; i < sizeof(trace_event_t); ++i) {
+        line[1 + 2 * i] = hex[bytes[i] >> 4];
+        line[2 + 2 * i] = hex[bytes[i] & 0xF];
+    }
+    line[sizeof(line) - 1] = '\0';
+    puts(line);
+}
+
+/**
+ * @brief Send buffered events to the host over USB CDC, a bounded batch per call.
+ *        Core 0 only. Without a host the rings are emptied, so a host that
+ *        connects later starts with recent events.
+ * @return true while a host is listening: call again within TRACE_DRAIN_INTERVAL_US.
+ */
+bool trace_drain(void)
+{
+    if (!ENABLE_TRACE)
+        return false;
+
+    bool connected = trace_host_connected();
+    for (uint core = 0; core < TRACE_CORES; ++core) {
+        uint32_t tail = ring_tail[core];
+        uint32_t head = ring_head[core];
+        __dmb();
+
+        if (!connected) {
+            ring_tail[core] = head;
+            continue;
+        }
+
+        uint32_t n = 0;
+        for (; tail != head && n < TRACE_DRAIN_BATCH; ++n) {
+            trace_event_t ev = rings[core][tail % TRACE_RING_LEN];
+            __dmb();
+            ring_tail[core] = ++tail;
+            send_event(&ev);
+        }
+        stats.drained += n;
+    }
+    return connected;
+}
+
+/**
+ * @brief Whether a host has the USB CDC stream open, for the trace and capture exports.
+ * @return false when USB stdio is not linked in (CLOCK_MODE_PRELOCKED).
+ */
+bool trace_host_connected(void)
+{
+#if LIB_PICO_STDIO_USB
+    return stdio_usb_connected();
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Trace counters.
+ * @return Pointer to the statistics.
+ */
+const trace_stats_t *trace_stats(void)
+{
+    return &stats;
+}
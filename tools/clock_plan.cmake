@@ -0,0 +1,23 @@
+# Clock plan: tools/clock_plan.py works out the PLL settings of every video
+# standard at configure time. It writes clock_plan.h for src/clock_control.c,
+# which checks every value with static asserts, and sets the boot clock
+# (the NTSC plan) as CLOCK_PLAN_* variables.
+set(OPENHEART_CLOCK_PLAN_TOOL ${CMAKE_CURRENT_LIST_DIR}/clock_plan.py)
+set(OPENHEART_CLOCK_PLAN_SETUP ${CMAKE_CURRENT_LIST_DIR}/../include/setup.h)
+
+macro(openheart_generate_clock_plan out_dir)
+    find_package(Python3 REQUIRED COMPONENTS Interpreter)
+    file(MAKE_DIRECTORY ${out_dir})
+    execute_process(
+        COMMAND ${Python3_EXECUTABLE} ${OPENHEART_CLOCK_PLAN_TOOL}
+                --header ${out_dir}/clock_plan.h --cmake ${out_dir}/clock_plan.cmake
+                --setup ${OPENHEART_CLOCK_PLAN_SETUP}
+        RESULT_VARIABLE clock_plan_result
+    )
+    if(NOT clock_plan_result EQUAL 0)
+        message(FATAL_ERROR "tools/clock_plan.py failed")
+    endif()
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS
+        ${OPENHEART_CLOCK_PLAN_TOOL} ${OPENHEART_CLOCK_PLAN_SETUP})
+    include(${out_dir}/clock_plan.cmake)
+endmacro()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Work out the RP2040 clock plan for every video standard.
+
+For each standard the PLL settings (feedback divider, post dividers) and the
+GPOUT divider are chosen to bring MCLK as close as possible to the console's
+crystal, within the RP2040 PLL limits and with the PLL output usable as
+clk_sys. All plans share one reference divider, the one the SDK uses for
+PLL_SYS (PLL_SYS_REFDIV), so any plan can run on either PLL.
+
+Writes a C header (included by src/clock_control.c, which re-checks every
+value with static asserts) and a CMake file with the boot clock settings and
+whether MCLK_CLOCK_MODE leaves clk_usb at 48 MHz for USB stdio. The header
+also carries the VCLK PWM divider of every overclock step for each plan, as
+the firmware computes it in MCLK_CLOCK_MODE.
+
+    tools/clock_plan.py --header clock_plan.h --cmake clock_plan.cmake --setup include/setup.h
+"""
+
+import argparse
+import re
+
+XOSC_HZ = 12000000
+REFDIV = 2                      # 6 MHz reference: fine enough for every standard
+VCO_MIN_HZ, VCO_MAX_HZ = 750000000, 1600000000
+FBDIV_MIN, FBDIV_MAX = 16, 320
+POSTDIV_MAX = 7
+SYS_MIN_HZ, SYS_MAX_HZ = 100000000, 133000000  # PLL output doubles as clk_sys
+GPOUT_DIVS = range(1, 5)        # Integer only: a fractional GPOUT divider jitters MCLK
+DECOUPLED_SYS_HZ = 144000000    # clk_sys in CLOCK_MODE_DECOUPLED (re-checked by src/clock_control.c)
+
+# MCLK of the console for each standard: 15 or 12 times the colour subcarrier
+STANDARDS = [
+    ("NTSC", 53693175, "NTSC (JPN/USA), 15 x 3.579545 MHz"),
+    ("PAL", 53203425, "PAL (EUR), 12 x 4.43361875 MHz"),
+    ("PALM", 53634172, "PAL-M (BRA), 15 x 3.57561149 MHz"),
+]
+
+
+def best_plan(target_hz):
+    ref_hz = XOSC_HZ // REFDIV
+    best = None
+    for gpout in GPOUT_DIVS:
+        out_target = target_hz * gpout
+        if not SYS_MIN_HZ <= out_target <= SYS_MAX_HZ:
+            continue
+        for pd1 in range(1, POSTDIV_MAX + 1):
+            for pd2 in range(1, pd1 + 1):  # PD1 >= PD2 draws less power
+                ideal = out_target * pd1 * pd2 / ref_hz
+                for fbdiv in (int(ideal), int(ideal) + 1):
+                    vco = ref_hz * fbdiv
+                    if not (FBDIV_MIN <= fbdiv <= FBDIV_MAX and VCO_MIN_HZ <= vco <= VCO_MAX_HZ):
+                        continue
+                    mclk = vco / (pd1 * pd2 * gpout)
+                    ppm = (mclk - target_hz) / target_hz * 1e6
+                    # Closest first, then the highest VCO (lowest jitter)
+                    key = (round(abs(ppm), 3), -vco)
+                    if best is None or key < best[0]:
+                        best = (key, dict(fbdiv=fbdiv, vco=vco, pd1=pd1, pd2=pd2, gpout=gpout, mclk=mclk, ppm=ppm))
+    if best is None:
+        raise SystemExit("no clock plan for %d Hz" % target_hz)
+    return best[1]
+
+
+def read_ladder(setup_path):
+    """VCLK dividers (in 1/16ths of MCLK) from include/setup.h: stock, then the overclock steps."""
+    text = open(setup_path).read()
+    stock = re.search(r"#define\s+VCLK_DIV_STOCK\s+\(?\s*(\d+)\s*\*\s*(\d+)\s*\)?", text)
+    ladder = re.search(r"#define\s+VCLK_OC_LADDER\s+\{([^}]*)\}", text)
+    if not stock or not ladder:
+        return []
+    return [int(stock.group(1)) * int(stock.group(2))] + [int(v) for v in ladder.group(1).split(",")]
+
+
+def read_clock_mode(setup_path):
+    """MCLK_CLOCK_MODE from include/setup.h."""
+    mode = re.search(r"#define\s+MCLK_CLOCK_MODE\s+(\w+)", open(setup_path).read())
+    return mode.group(1) if mode else "CLOCK_MODE_RELOCK"
+
+
+def pll_out_hz(plan):
+    return plan["vco"] // (plan["pd1"] * plan["pd2"])
+
+
+def vclk_clocks(mode, name, plans):
+    """clk_sys and the PLL output feeding MCLK for a standard in a clock mode.
+
+    CLOCK_MODE_PRELOCKED has only two PLLs for three plans: PLL_SYS on NTSC and
+    PLL_USB on PAL, so PAL-M (BRA) takes its MCLK from the NTSC lock.
+    """
+    if mode == "CLOCK_MODE_PRELOCKED":
+        ntsc = pll_out_hz(plans["NTSC"])
+        return ntsc, pll_out_hz(plans["PAL"]) if name == "PAL" else ntsc
+    own = pll_out_hz(plans[name])
+    return (DECOUPLED_SYS_HZ if mode == "CLOCK_MODE_DECOUPLED" else own), own
+
+
+def vclk_steps(sys_hz, src_hz, gpout, ladder):
+    """(PWM divider, VCLK Hz, ppm from MCLK/div) per VCLK divider, rounded as vclk_pwm_div() does."""
+    scale = (sys_hz * gpout << 19) // src_hz
+    steps = []
+    for div16 in ladder:
+        pwm = (div16 * scale + (1 << 19)) >> 20
+        vclk = sys_hz * 16 / pwm / 2  # TOP = 1: two counter steps per period
+        want = src_hz / gpout * 16 / div16
+        steps.append((pwm, vclk, (vclk - want) / want * 1e6))
+    return steps
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--header", required=True, help="C header to write")
+    parser.add_argument("--cmake", help="CMake file to write with the boot clock (NTSC plan)")
+    parser.add_argument("--setup", help="include/setup.h, for the VCLK table")
+    args = parser.parse_args()
+
+    plans = [(name, target, what, best_plan(target)) for name, target, what in STANDARDS]
+    ladder = read_ladder(args.setup) if args.setup else []
+    mode = read_clock_mode(args.setup) if args.setup else "CLOCK_MODE_RELOCK"
+    usb_clock = mode != "CLOCK_MODE_PRELOCKED"
+
+    lines = [
+        "// Generated by tools/clock_plan.py, do not edit",
+        "#ifndef CLOCK_PLAN_H",
+        "#define CLOCK_PLAN_H",
+        "",
+        "#define CLOCK_PLAN_REFDIV %d ///< Reference divider of every plan (XOSC / %d)" % (REFDIV, REFDIV),
+        "#define CLOCK_PLAN_USB_CLOCK %d ///< MCLK_CLOCK_MODE keeps clk_usb at 48 MHz: USB stdio linked in" % usb_clock,
+    ]
+    if ladder:
+        lines += [
+            "",
+            "// VCLK dividers the tables below were worked out for, relative to MCLK in 1/16ths (include/setup.h)",
+            "#define CLOCK_PLAN_VCLK_DIV_STOCK %d" % ladder[0],
+            "#define CLOCK_PLAN_VCLK_OC_STEPS  %d" % (len(ladder) - 1),
+            "#define CLOCK_PLAN_VCLK_MODE      %s" % mode,
+        ]
+    for name, target, what, p in plans:
+        lines += [
+            "",
+            "// %s: MCLK %.6f MHz, %+.0f ppm" % (what, p["mclk"] / 1e6, p["ppm"]),
+            "#define CLOCK_PLAN_%s_TARGET_HZ %d" % (name, target),
+            "#define CLOCK_PLAN_%s_VCO_HZ    %d" % (name, p["vco"]),
+            "#define CLOCK_PLAN_%s_POSTDIV1  %d" % (name, p["pd1"]),
+            "#define CLOCK_PLAN_%s_POSTDIV2  %d" % (name, p["pd2"]),
+            "#define CLOCK_PLAN_%s_GPOUT_DIV %d" % (name, p["gpout"]),
+        ]
+        if ladder:
+            sys_hz, src_hz = vclk_clocks(mode, name, dict((n, q) for n, _, _, q in plans))
+            steps = vclk_steps(sys_hz, src_hz, p["gpout"], ladder)
+            lines += [
+                "// VCLK PWM dividers in 1/16ths, stock then overclock steps, in MCLK_CLOCK_MODE",
+                "#define CLOCK_PLAN_%s_VCLK_SYS_HZ %d ///< clk_sys the VCLK PWM runs from" % (name, sys_hz),
+                "#define CLOCK_PLAN_%s_VCLK_SRC_HZ %d ///< PLL output feeding MCLK" % (name, src_hz),
+            ]
+            for i, (div, (pwm, vclk, ppm)) in enumerate(zip(ladder, steps)):
+                lines.append("#define CLOCK_PLAN_%s_VCLK_PWM_DIV16_%d %d ///< MCLK/%g: %.3f MHz, %+.0f ppm"
+                             % (name, i, pwm, div / 16, vclk / 1e6, ppm))
+            lines += [
+                "#define CLOCK_PLAN_%s_VCLK_PWM_DIV16_MIN %d" % (name, min(s[0] for s in steps)),
+                "#define CLOCK_PLAN_%s_VCLK_PWM_DIV16_MAX %d" % (name, max(s[0] for s in steps)),
+                "#define CLOCK_PLAN_%s_VCLK_MAX_PPM %d ///< Largest VCLK error left by the PWM fraction"
+                % (name, round(max(abs(s[2]) for s in steps))),
+            ]
+    lines += ["", "#endif // CLOCK_PLAN_H", ""]
+    with open(args.header, "w") as f:
+        f.write("\n".join(lines))
+
+    if args.cmake:
+        ntsc = plans[0][3]
+        with open(args.cmake, "w") as f:
+            f.write("# Generated by tools/clock_plan.py, do not edit\n")
+            f.write("set(CLOCK_PLAN_REFDIV %d)\n" % REFDIV)
+            f.write("set(CLOCK_PLAN_BOOT_VCO_HZ %d)\n" % ntsc["vco"])
+            f.write("set(CLOCK_PLAN_BOOT_POSTDIV1 %d)\n" % ntsc["pd1"])
+            f.write("set(CLOCK_PLAN_BOOT_POSTDIV2 %d)\n" % ntsc["pd2"])
+            f.write("set(CLOCK_PLAN_BOOT_SYS_HZ %d)\n" % (ntsc["vco"] // (ntsc["pd1"] * ntsc["pd2"])))
+            f.write("set(CLOCK_PLAN_USB_CLOCK %d)\n" % usb_clock)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""Convert PBM images to SSD1306 page format, RLE compressed, as a C header.
+
+The panel (and the display back buffer) is organised in pages: bands of 8
+rows, one byte per column, bit 0 at the top. Images are converted to that
+layout at build time so the firmware can blit them without per-pixel work.
+Set (black) PBM pixels are lit. Several images make an animation, one frame
+each; all frames must have the same size.
+
+Compression is PackBits style, on the page-format bytes in page order:
+  0x00-0x7F  n + 1 literal bytes follow
+  0x80-0xFF  the next byte is repeated n - 0x80 + 2 times
+
+    tools/img2pages.py --name sega_logo -o sega_logo.h assets/sega_logo.pbm
+"""
+
+import argparse
+import os
+import sys
+
+RUN_MIN = 3        # Shorter runs stay in literals
+RUN_MAX = 0x7F + 2
+LITERAL_MAX = 0x80
+
+
+def read_pbm(path):
+    """Return (width, height, rows of 0/1) from a plain (P1) or raw (P4) PBM."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    tokens = []
+    pos = 0
+
+    def next_token():
+        nonlocal pos
+        while pos < len(data):
+            if data[pos:pos + 1] == b"#":
+                while pos < len(data) and data[pos:pos + 1] not in (b"\n", b"\r"):
+                    pos += 1
+            elif data[pos:pos + 1].isspace():
+                pos += 1
+            else:
+                break
+        start = pos
+        while pos < len(data) and not data[pos:pos + 1].isspace() and data[pos:pos + 1] != b"#":
+            pos += 1
+        return data[start:pos]
+
+    magic = next_token()
+    width, height = int(next_token()), int(next_token())
+    if magic == b"P4":
+        pos += 1  # Single whitespace before the raster
+        stride = (width + 7) // 8
+        raster = data[pos:pos + stride * height]
+        if len(raster) != stride * height:
+            raise ValueError("%s: truncated raster" % path)
+        rows = [[(raster[y * stride + x // 8] >> (7 - x % 8)) & 1 for x in range(width)] for y in range(height)]
+    elif magic == b"P1":
+        bits = [c - 0x30 for c in data[pos:] if c in (0x30, 0x31)]
+        if len(bits) < width * height:
+            raise ValueError("%s: truncated raster" % path)
+        rows = [bits[y * width:(y + 1) * width] for y in range(height)]
+    else:
+        raise ValueError("%s: not a PBM image" % path)
+    return width, height, rows
+
+
+def to_pages(width, height, rows):
+    """Page-major bytes; a partial last page is padded with unlit rows."""
+    out = bytearray()
+    for page in range((height + 7) // 8):
+        for x in range(width):
+            byte = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and rows[y][x]:
+                    byte |= 1 << bit
+            out.append(byte)
+    return out
+
+
+def rle(data):
+    out = bytearray()
+    literal = bytearray()
+
+    def flush():
+        while literal:
+            chunk = literal[:LITERAL_MAX]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+            del literal[:LITERAL_MAX]
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < RUN_MAX and data[i + run] == data[i]:
+            run += 1
+        if run >= RUN_MIN:
+            flush()
+            out.append(0x80 + run - 2)
+            out.append(data[i])
+            i += run
+        else:
+            literal.append(data[i])
+            i += 1
+    flush()
+    return out
+
+
+def unrle(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        c = data[i]
+        if c < 0x80:
+            out.extend(data[i + 1:i + 2 + c])
+            i += 2 + c
+        else:
+            out.extend(bytes([data[i + 1]]) * (c - 0x80 + 2))
+            i += 2
+    return out
+
+
+def c_array(data, indent="    ", per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ", ".join("0x%02x" % b for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("images", nargs="+", help="PBM images, one per frame")
+    parser.add_argument("--name", required=True, help="C identifier of the image")
+    parser.add_argument("-o", "--output", required=True, help="header to write")
+    args = parser.parse_args()
+
+    size = None
+    data = bytearray()
+    offsets = [0]
+    raw_bytes = 0
+    for path in args.images:
+        width, height, rows = read_pbm(path)
+        if size and size != (width, height):
+            sys.exit("%s: %dx%d, the first frame is %dx%d" % (path, width, height, size[0], size[1]))
+        if width > 128 or height > 64:
+            sys.exit("%s: %dx%d does not fit the 128x64 panel" % (path, width, height))
+        size = (width, height)
+        pages = to_pages(width, height, rows)
+        packed = rle(pages)
+        assert unrle(packed) == pages
+        raw_bytes += len(pages)
+        data += packed
+        offsets.append(len(data))
+    if len(data) > 0xFFFF:
+        sys.exit("%s: %d bytes compressed, frame offsets are 16 bit" % (args.name, len(data)))
+
+    guard = args.name.upper() + "_H"
+    sources = ", ".join(os.path.basename(p) for p in args.images)
+    header = """// Generated by tools/img2pages.py from {sources}, do not edit
+// {width}x{height}, {frames} frame(s), {raw} bytes in page format, {packed} bytes RLE
+#ifndef {guard}
+#define {guard}
+
+#include "display.h"
+
+static const uint8_t {name}_data[] = {{
+{data}
+}};
+
+static const uint16_t {name}_frames[] = {{{offsets}}};
+
+static const display_image_t {name} = {{{width}, {pages}, {frames}, {name}_frames, {name}_data}};
+
+#endif // {guard}
+""".format(sources=sources, width=size[0], height=size[1], frames=len(args.images), raw=raw_bytes,
+           packed=len(data), guard=guard, name=args.name, data=c_array(data),
+           offsets=", ".join(str(o) for o in offsets), pages=(size[1] + 7) // 8)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, "w") as f:
+        f.write(header)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+"""Decode logic analyzer captures (see src/logic_analyzer.c).
+
+Reads the USB CDC output of the board (a serial device or a captured log),
+picks out the "%" capture lines and prints a summary per capture: trigger,
+window and edge counts per line. Optionally writes each capture as a VCD
+file, replays its SELECT edges through a copy of the pad sniffer's decoder,
+and saves the raw capture lines as corpus files, which this tool reads back
+like any other log.
+
+    tools/la_decode.py /dev/ttyACM0 --seconds 30 --save corpus/
+    tools/la_decode.py corpus/0001-pad.la --pad --expect B C START
+    tools/la_decode.py capture.log --vcd capture
+"""
+
+import argparse
+import os
+import sys
+import time
+
+# Keep in step with include/setup.h and la_trigger_t in include/logic_analyzer.h
+PIN_NAMES = {2: "UP", 3: "DOWN", 4: "LEFT", 5: "RIGHT", 6: "B_A", 7: "C_START", 8: "SELECT",
+             10: "HALT", 11: "VSYNC", 12: "STANDARD", 13: "REGION", 14: "CART_CE", 15: "VRES"}
+TRIGGER_NAMES = {1: "pad", 2: "reset"}
+PAD_SNIFFER_SETTLE_NS = 500
+
+# Keep in step with pad_decoder.c and PAD_CYCLE_GAP_US in include/setup.h
+SELECT_BIT = 1 << 6
+DATA_MASK = 0x3F
+PAD_CYCLE_GAP_US = 1000
+BUTTONS = ("UP", "DOWN", "LEFT", "RIGHT", "A", "B", "C", "START", "X", "Y", "Z", "MODE")
+
+
+class Capture:
+    def __init__(self, header):
+        fields = header.split()
+        if len(fields) != 8 or fields[1] != "1":
+            raise ValueError("unsupported capture header: " + header)
+        self.sample_hz = int(fields[2])
+        self.pin_base = int(fields[3])
+        self.mask = int(fields[4], 16)
+        self.samples = int(fields[5])
+        self.trigger = int(fields[6])
+        self.source = int(fields[7])
+        self.lines = [header]
+        self.data = bytearray()
+        self.runs = []
+
+    def finish(self, end_line):
+        self.lines.append(end_line)
+        data, i = self.data, 0
+        while i < len(data):
+            state = data[i] | data[i + 1] << 8
+            i += 2
+            run, shift = 0, 0
+            while True:
+                byte = data[i]
+                i += 1
+                run |= (byte & 0x7F) << shift
+                shift += 7
+                if not byte & 0x80:
+                    break
+            self.runs.append((state, run))
+        expected = int(end_line.split()[1])
+        if len(self.runs) != expected:
+            raise ValueError("capture has %d records, %d announced" % (len(self.runs), expected))
+        if sum(run for _, run in self.runs) != self.samples:
+            raise ValueError("capture records do not add up to %d samples" % self.samples)
+
+    def bits(self):
+        return [b for b in range(16) if self.mask & (1 << b)]
+
+    def pin_name(self, bit):
+        gpio = self.pin_base + bit
+        return PIN_NAMES.get(gpio, "GPIO%d" % gpio)
+
+    def time_us(self, sample):
+        return (sample - self.trigger) * 1e6 / self.sample_hz
+
+    def expand(self):
+        out = []
+        for state, run in self.runs:
+            out.extend([state] * run)
+        return out
+
+    def summary(self):
+        print("capture: %s trigger, %d samples at %.3f MHz, %.3f ms before and %.3f ms after"
+              % (TRIGGER_NAMES.get(self.source, "source %d" % self.source), self.samples, self.sample_hz / 1e6,
+                 self.trigger / self.sample_hz * 1e3, (self.samples - self.trigger) / self.sample_hz * 1e3))
+        for bit in self.bits():
+            edges, last = 0, None
+            for state, _ in self.runs:
+                level = (state >> bit) & 1
+                if last is not None and level != last:
+                    edges += 1
+                last = level
+            print("  %-8s %6d edges, ends %s" % (self.pin_name(bit), edges, "high" if last else "low"))
+
+    def write_vcd(self, path):
+        codes = {bit: chr(33 + i) for i, bit in enumerate(self.bits())}
+        with open(path, "w") as out:
+            out.write("$timescale 1ns $end\n$scope module openheart $end\n")
+            for bit, code in codes.items():
+                out.write("$var wire 1 %s %s $end\n" % (code, self.pin_name(bit)))
+            out.write("$upscope $end\n$enddefinitions $end\n")
+            sample, last = 0, None
+            for state, run in self.runs:
+                changed = [b for b in codes if last is None or ((state ^ last) >> b) & 1]
+                out.write("#%d\n" % (sample * 1000000000 // self.sample_hz))
+                for bit in changed:
+                    out.write("%d%s\n" % ((state >> bit) & 1, codes[bit]))
+                sample += run
+                last = state
+            out.write("#%d\n" % (sample * 1000000000 // self.sample_hz))
+
+
+class PadDecoder:
+    """pad_decoder_feed() from pad_decoder.c, on sniffer-format samples."""
+
+    PLAIN, EXT_NEXT, SIX = range(3)
+
+    def __init__(self):
+        self.pad = set()
+        self.state = self.PLAIN
+        self.last_us = None
+
+    def feed(self, sample, time_us):
+        # A quiet SELECT starts a new read cycle; one without an ID drops the extra buttons
+        if self.last_us is None or time_us - self.last_us > PAD_CYCLE_GAP_US:
+            if self.state == self.PLAIN:
+                self.pad -= {"X", "Y", "Z", "MODE"}
+            self.state = self.PLAIN
+        self.last_us = time_us
+
+        data = ~sample & DATA_MASK
+        pressed = lambda bit: bool(data & (1 << bit))
+        ext = self.state == self.EXT_NEXT
+        if ext:
+            self.state = self.SIX
+        if sample & SELECT_BIT:
+            names = ("Z", "Y", "X", "MODE") if ext else ("UP", "DOWN", "LEFT", "RIGHT", "B", "C")
+            for bit, name in enumerate(names):
+                self.set(name, pressed(bit))
+        else:
+            self.set("A", pressed(4))
+            self.set("START", pressed(5))
+            if data & 0x0F == 0x0F:
+                self.state = self.EXT_NEXT
+
+    def set(self, name, on):
+        if on:
+            self.pad.add(name)
+        else:
+            self.pad.discard(name)
+
+    def text(self):
+        return " ".join(b for b in BUTTONS if b in self.pad) or "-"
+
+
+def replay_pad(capture, verbose):
+    """Sample the pad lines like the sniffer's PIO program: settle after each SELECT edge."""
+    if capture.pin_base != 2 or (capture.mask & 0x7F) != 0x7F:
+        raise ValueError("capture does not hold the pad lines")
+    samples = capture.expand()
+    settle = max(1, -(-PAD_SNIFFER_SETTLE_NS * capture.sample_hz // 1000000000))
+    decoder = PadDecoder()
+    expect = 1
+    reads = 0
+    shown = decoder.text()
+    i = 0
+    while i < len(samples):
+        if bool(samples[i] & SELECT_BIT) != bool(expect):
+            i += 1
+            continue
+        # The first SELECT level may predate the capture: only a real edge counts
+        at = i + settle
+        if at >= len(samples):
+            break
+        if i > 0:
+            decoder.feed(samples[at] & 0x7F, at * 1e6 / capture.sample_hz)
+            reads += 1
+            if verbose or decoder.text() != shown:
+                shown = decoder.text()
+                print("  %+10.1f us  %s" % (capture.time_us(at), shown))
+        expect ^= 1
+        i = at + 1
+    print("  %d SELECT edges decoded, pad: %s" % (reads, decoder.text()))
+    return decoder
+
+
+def read_captures(stream, deadline, echo):
+    captures, current = [], None
+    for raw in stream:
+        line = raw.decode("ascii", "replace").rstrip("\r\n")
+        if line.startswith("%LA "):
+            current = Capture(line)
+        elif line.startswith("%END") and current:
+            current.finish(line)
+            captures.append(current)
+            current = None
+        elif line.startswith("%") and current:
+            current.lines.append(line)
+            current.data += bytes.fromhex(line[1:])
+        elif echo:
+            print(line)
+        if deadline and time.monotonic() > deadline:
+            break
+    return captures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="serial device, capture log or corpus file, '-' for stdin")
+    parser.add_argument("--seconds", type=float, help="stop reading after this long")
+    parser.add_argument("--vcd", metavar="PREFIX", help="write <PREFIX>-<n>.vcd per capture")
+    parser.add_argument("--pad", action="store_true", help="replay SELECT edges through the pad decoder")
+    parser.add_argument("--expect", nargs="+", metavar="BUTTON",
+                        help="with --pad: exit 1 unless every capture ends with exactly these buttons")
+    parser.add_argument("--save", metavar="DIR", help="save each capture as DIR/<n>-<trigger>.la")
+    parser.add_argument("-v", "--verbose", action="store_true", help="echo other lines, print every pad read")
+    args = parser.parse_args()
+
+    stream = sys.stdin.buffer if args.source == "-" else open(args.source, "rb")
+    deadline = time.monotonic() + args.seconds if args.seconds else None
+    try:
+        captures = read_captures(stream, deadline, args.verbose)
+    except KeyboardInterrupt:
+        captures = []
+
+    failed = False
+    for n, capture in enumerate(captures, 1):
+        capture.summary()
+        if args.vcd:
+            capture.write_vcd("%s-%d.vcd" % (args.vcd, n))
+        if args.save:
+            os.makedirs(args.save, exist_ok=True)
+            name = "%04d-%s.la" % (n, TRIGGER_NAMES.get(capture.source, "trigger"))
+            with open(os.path.join(args.save, name), "w") as out:
+                out.write("\n".join(capture.lines) + "\n")
+        if args.pad or args.expect:
+            decoder = replay_pad(capture, args.verbose)
+            if args.expect and decoder.pad != {b.upper() for b in args.expect}:
+                print("  expected %s" % " ".join(args.expect))
+                failed = True
+    if not captures:
+        print("no captures found")
+    sys.exit(1 if failed or not captures else 0)
+
+
+if __name__ == "__main__":
+    main()
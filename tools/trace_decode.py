@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Decode the firmware's trace stream (see include/trace.h).
+
+Reads the USB CDC output of the board (a serial device or a captured log),
+picks out the "@<hex>" trace lines and prints per-core busy figures, span
+latency histograms and event counts. Other lines are passed through with -v.
+
+    tools/trace_decode.py /dev/ttyACM0 --seconds 10
+    tools/trace_decode.py capture.log
+"""
+
+import argparse
+import collections
+import struct
+import sys
+import time
+
+# Keep in step with trace_id_t in include/trace.h
+EVENT_NAMES = {
+    1: "idle",
+    2: "isr",
+    3: "pad sample",
+    4: "display frame",
+    5: "flash op",
+    6: "region switch",
+    7: "console step",
+    8: "gesture",
+    9: "vblank",
+    10: "tmss skip",
+    11: "la trigger missed",
+}
+TRACE_END = 0x80
+EVENT_IDLE = 1
+EVENT_ISR = 2
+SPAN_EVENTS = (1, 2, 3, 4, 5)  # The rest are single marks
+
+IRQ_NAMES = {3: "TIMER_IRQ_3", 9: "PIO1_IRQ_0", 11: "DMA_IRQ_0", 12: "DMA_IRQ_1", 13: "IO_IRQ_BANK0"}
+
+EVENT = struct.Struct("<QIBBH")  # time_us, arg, id, core, seq
+
+
+def parse_event(line):
+    raw = bytes.fromhex(line[1:].strip())
+    if len(raw) != EVENT.size:
+        raise ValueError("bad trace line length")
+    return EVENT.unpack(raw)
+
+
+def span_name(event_id, arg):
+    if event_id == EVENT_ISR:
+        return "isr " + IRQ_NAMES.get(arg, "irq %d" % arg)
+    return EVENT_NAMES.get(event_id, "event %d" % event_id)
+
+
+def percentile(sorted_values, fraction):
+    index = min(len(sorted_values) - 1, int(fraction * len(sorted_values)))
+    return sorted_values[index]
+
+
+def histogram(durations):
+    """Power-of-two microsecond buckets: [0,1) [1,2) [2,4) ..."""
+    buckets = collections.Counter()
+    for d in durations:
+        buckets[d.bit_length()] += 1
+    widest = max(buckets.values())
+    for bucket in sorted(buckets):
+        low = 0 if bucket == 0 else 1 << (bucket - 1)
+        high = 1 << bucket
+        bar = "#" * max(1, buckets[bucket] * 40 // widest)
+        print("      %8d - %-8d us %7d %s" % (low, high, buckets[bucket], bar))
+
+
+class Decoder:
+    def __init__(self):
+        self.last = {}
+        self.covered = collections.Counter()
+        self.next_seq = {}
+        self.dropped = collections.Counter()
+        self.open = {}
+        self.spans = collections.defaultdict(list)
+        self.idle = collections.Counter()
+        self.marks = collections.Counter()
+        self.events = 0
+
+    def feed(self, time_us, arg, event_id, core, seq):
+        self.events += 1
+        expected = self.next_seq.get(core)
+        if expected is not None and seq != expected:
+            self.dropped[core] += (seq - expected) & 0xFFFF
+            # Spans open across a gap cannot be trusted, nor can the time it covers
+            self.open = {k: v for k, v in self.open.items() if k[0] != core}
+        elif core in self.last:
+            self.covered[core] += time_us - self.last[core]
+        self.next_seq[core] = (seq + 1) & 0xFFFF
+        self.last[core] = time_us
+
+        is_end = bool(event_id & TRACE_END)
+        event_id &= ~TRACE_END
+        if event_id not in SPAN_EVENTS:
+            self.marks[(core, event_id)] += 1
+            return
+
+        # ISR spans nest, so they are told apart by IRQ number
+        key = (core, event_id, arg if event_id == EVENT_ISR else 0)
+        if not is_end:
+            self.open[key] = (time_us, arg)
+            return
+        begin = self.open.pop(key, None)
+        if begin is None:
+            return
+        duration = time_us - begin[0]
+        if event_id == EVENT_IDLE:
+            self.idle[core] += duration
+        else:
+            self.spans[(core, span_name(event_id, begin[1]))].append(duration)
+
+    def report(self):
+        print("%d trace events" % self.events)
+        for core in sorted(self.last):
+            elapsed = self.covered[core]
+            busy = 100.0 * (1 - self.idle[core] / elapsed) if elapsed else 0.0
+            print("core %d: %.3f s traced, %.1f%% busy, %d events dropped"
+                  % (core, elapsed / 1e6, busy, self.dropped[core]))
+
+        for (core, name), durations in sorted(self.spans.items()):
+            durations.sort()
+            print("  core %d %-20s n=%-7d min %d  p50 %d  p99 %d  max %d us"
+                  % (core, name, len(durations), durations[0], percentile(durations, 0.5),
+                     percentile(durations, 0.99), durations[-1]))
+            histogram(durations)
+
+        for (core, event_id), count in sorted(self.marks.items()):
+            print("  core %d %-20s %d" % (core, EVENT_NAMES.get(event_id, "event %d" % event_id), count))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="serial device or capture file, '-' for stdin")
+    parser.add_argument("--seconds", type=float, help="stop reading after this long")
+    parser.add_argument("-v", "--verbose", action="store_true", help="echo non-trace lines")
+    args = parser.parse_args()
+
+    stream = sys.stdin.buffer if args.source == "-" else open(args.source, "rb")
+    deadline = time.monotonic() + args.seconds if args.seconds else None
+    decoder = Decoder()
+    try:
+        for raw in stream:
+            line = raw.decode("ascii", "replace").rstrip("\r\n")
+            if line.startswith("@"):
+                try:
+                    decoder.feed(*parse_event(line))
+                except ValueError:
+                    pass
+            elif args.verbose:
+                print(line)
+            if deadline and time.monotonic() > deadline:
+                break
+    except KeyboardInterrupt:
+        pass
+    decoder.report()
+
+
+if __name__ == "__main__":
+    main()